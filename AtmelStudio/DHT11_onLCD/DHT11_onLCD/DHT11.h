@@ -34,6 +34,10 @@ After "DHT11ReadData" has been executed use this function to display temperature
 Before that move LCD cursor to a proper location where you want temperature to be displayed.
 After the numeric value, this function will display °C
 
+*	int16_t DHT11Temperature(void), int16_t DHT11Humidity(void):
+After "DHT11ReadData" has been executed these return the temperature and humidity in tenths
+(e.g 235 is 23.5) for LCDWriteFixed(value, 1), without the float library.
+
 *	void DHT11DisplayHumidity(void):
 After "DHT11ReadData" has been executed use this function to display humidity value on an LCD.
 Before that move LCD cursor to a proper location where you want humidity to be displayed.
@@ -81,6 +85,8 @@ void DHT11DisplayTemperature(void);
 void DHT11DisplayHumidity(void);
 void DHT11ReadDataAvg(void);
 int8_t DHT11ReadData(void);
+int16_t DHT11Temperature(void);
+int16_t DHT11Humidity(void);
 
 
 /*************************************************************
@@ -116,6 +122,15 @@ void DHT11DisplayHumidity(){
 	LCDData('%');
 }
 
+int16_t DHT11Temperature(){
+	// DHT11Data[3] holds the tenths
+	return (int16_t)(DHT11Data[2] + DHT_TEMP_ERROR_OFFSET) * 10 + DHT11Data[3];
+}
+
+int16_t DHT11Humidity(){
+	return (int16_t)DHT11Data[0] * 10 + DHT11Data[1];
+}
+
 void DHT11ReadDataAvg(){
 	uint8_t i;
 	uint16_t bufferTemp=0;
@@ -88,6 +88,15 @@ INTEGERS
 - Send an integer number to a specific location:
 	"LCDWriteIntXY(x, y, number, nr_of_digits)"
 
+FIXED POINT
+- Display an integer that holds tenths, hundredths... without the float library:
+	"LCDWriteFixed(value, decimals)"
+	int16_t temperature = 275; // 27.5 in tenths
+	LCDWriteFixed(temperature, 1);
+	will display "27.5". LCDWriteFixed(-5, 1) will display "-0.5".
+- Send a fixed point number to a specific location:
+	"LCDWriteFixedXY(x, y, value, decimals)"
+
 FLOATS (We all float down here)
 - Display a float number
 	LCDWriteFloat(float_nr, nr_of_digits)
@@ -112,6 +121,19 @@ BIG DIGITS
 	Same as above but needs to be used with "LCDWriteIntBig3Chars" function.
 	"LCDWriteIntBig3Chars(int16_t number, int8_t nrOfDigits)"
 
+CACHED BIG DIGITS
+- 2 characters wide, 2 lines high digits drawn with 8 segment glyphs, as many as the LCD has room for,
+so any numbers fit on the screen together. The bottom bar of 2, 3, 5 and 9 on the side without a stem
+and the minus sign are the "_" of the character ROM, the 7 has a hook on the top left.
+The glyphs are loaded into CGRAM when they are needed (LCD_GLYPH_CACHE).
+A glyph that is already in CGRAM is not sent again, so redrawing the same or other digits costs only
+DDRAM writes. With LCD_SHADOW a glyph that is still on the screen is never replaced.
+Draws on the current line and the one below, starting at the current character position:
+	"LCDWriteBigFixed(int16_t value, uint8_t decimals)"
+	E.g: LCDGotoXY(1, 1); LCDWriteBigFixed(235, 1); will display a big "23.5" (8 characters wide)
+- Any 5x8 glyph from flash can be put on the screen the same way:
+	"LCDData(LCDGlyph(glyph))"
+
 BIG SEPARATOR
 - Big 2 lines height separator. Can be used in conjunction with big digits to make a digital clock.
 The function displays ":" but bigger, on two lines.
@@ -135,9 +157,48 @@ Connect OC0B pin to the base of transistor through a resistor. Connect LCD backl
 cathode to collector.
 	"LCDBacklightPWM(uint8_t brightness)"
 
+ASYNCHRONOUS MODE
+- With LCD_ASYNC set to TRUE the functions above don't wait for the LCD. The bytes are put in a
+queue and sent by the Timer2 compare match A interrupt, one byte every LCD_ASYNC_TICK_US.
+Interrupts must be enabled with sei(). Only when the queue is full a function waits for free space.
+- Check if everything has been sent to the LCD:
+	"LCDQueueIdle()"
+
+TIMING
+- LCD_CONTROLLER selects the datasheet timing of the controller on the module: enable pulse width
+and execution time of each kind of instruction. All waits are derived from it, FlashEnable() holds
+E HIGH only as long as the controller needs (under a microsecond instead of 50 us).
+- With LCD_WRITE_ONLY set to TRUE the RW pin of the LCD is tied to GND and the busy flag is never read.
+After every byte the library waits the execution time of the instruction plus LCD_TIMING_MARGIN,
+so a character takes about 45 us. The RW pin of the MCU is free for something else.
+- In 8-bit mode a character is one enable pulse, the whole LCD_DATA_PORT is used by the LCD.
+
+I2C BACKPACK
+- With LCD_INTERFACE set to LCD_I2C the LCD is driven by a PCF8574 I2C backpack on the TWI pins
+(SDA PC4, SCL PC5) instead of 7 pins. Every nibble is 2 bytes on the bus (E HIGH, then E LOW), all
+the bytes in the queue are sent in one TWI transaction by the TWI interrupt, so there is no start,
+address and stop per character. The bus itself is the timer: when the LCD needs more time (clear
+display) the same outputs are sent again. Like in asynchronous mode the functions return right away,
+interrupts must be enabled with sei() before LCDSetup(). If nothing answers on the address the queue
+is dropped, so a missing LCD doesn't stop the program.
+
+SHADOW BUFFER
+- With LCD_SHADOW set to TRUE the characters are written to a copy of the screen in RAM and
+nothing is sent to the LCD until:
+	"LCDFlush()"
+which sends only the characters that changed since the last flush. LCDClear() and rewriting
+the whole screen every time cost nothing on the bus, only the changed digits are sent.
+
 3. Animations
-- Scroll a string from right to left. Needs to be uncommented in setup section:
+- Nothing waits in a delay loop. Call LCDAnimate() from the main loop or a timer task with the
+milliseconds since the last call, it moves the texts one character at a time:
+	"LCDAnimate(ms)"
+- Scroll a string from right to left on line 1 (clears the display). Needs to be uncommented in setup section:
 	"LCDScrollText(aString)"
+- Scroll a string in a part of a line, the rest of the screen can be used as usual:
+	"LCDScrollRegion(x, y, width, aString, speed_ms)"
+- Stop scrolling on a line:
+	"LCDScrollStop(y)"
 
 4. Utils
 - Find characters positions where lines start and end. Needs to be uncommented in setup section:
@@ -195,6 +256,22 @@ ________________________________________________________________________________
 #define LCD_E_CONTROL_PORT 					PORTD
 #define LCD_E_PIN 							PD2
 
+// Interface - LCD_PARALLEL: the data and control pins above.
+// LCD_I2C: PCF8574 I2C backpack on the TWI pins (SDA PC4, SCL PC5), the pins above are not used.
+// The bytes always go through the queue and the TWI interrupt, LCD_ASYNC and LCD_WRITE_ONLY don't matter.
+// LCD_DATA_BUS_SIZE must be LCD_DATA_4_BITS and LCD_BACKLIGHT_PWM FALSE.
+#define LCD_PARALLEL						0
+#define LCD_I2C								1
+#define LCD_INTERFACE						LCD_PARALLEL
+
+#define LCD_I2C_ADDRESS						0x27 	// PCF8574: 0x20 to 0x27, PCF8574A: 0x38 to 0x3F (A0-A2 jumpers)
+#define LCD_I2C_SCL_HZ						100000 	// PCF8574 is specified up to 100 kHz
+
+// PCF8574 outputs of the backpack. DB4 to DB7 are on P4 to P7, RW (P1) is kept LOW
+#define LCD_I2C_RS							0x01 	// P0
+#define LCD_I2C_E							0x04 	// P2
+#define LCD_I2C_BACKLIGHT					0x08 	// P3. 0 keeps the backlight off
+
 // LCD type
 #define LCD_NR_OF_CHARACTERS 				16 	// e.g 16 if LCD is 16x2 type
 #define LCD_NR_OF_ROWS 						2 	// e.g 2 if LCD is 16x2 type
@@ -215,10 +292,40 @@ ________________________________________________________________________________
 #define LCD_DATA_8_BITS						8
 #define LCD_DATA_BUS_SIZE					LCD_DATA_4_BITS // LCD_DATA_4_BITS or LCD_DATA_4_BITS
 
+// LCD controller - selects the timing profile (enable pulse, execution times) from its datasheet
+#define LCD_HD44780							0 	// Hitachi HD44780 and clones
+#define LCD_ST7066							1 	// Sitronix ST7066U
+#define LCD_KS0066							2 	// Samsung KS0066U / S6A0069
+#define LCD_CONTROLLER						LCD_HD44780
+
+// Execution times are given for the typical oscillator frequency (270 kHz), the real one
+// can be slower, especially at 3.3V. Percent added to every wait, increase it if characters are lost.
+#define LCD_TIMING_MARGIN					10 	// Percent
+
+// Write only - TRUE: RW pin of the LCD is tied to GND, the busy flag is never read.
+// The library waits the execution time of every instruction instead. LCD_RW_xxx pins are not used.
+// FALSE: the busy flag is read before every byte (RW pin connected to the MCU).
+#define LCD_WRITE_ONLY						FALSE // TRUE or FALSE
+
+// Asynchronous mode - TRUE: bytes are only put in a queue and Timer2 compare match A interrupt sends
+// one byte (both nibbles in 4-bit mode) every LCD_ASYNC_TICK_US, so the functions return right away.
+// The busy flag is not read, the RW pin is kept LOW. Timer2 can't be used for anything else.
+// FALSE: every byte is sent right away, waiting for the busy flag (or the execution time with LCD_WRITE_ONLY).
+#define LCD_ASYNC							TRUE // TRUE or FALSE
+#define LCD_ASYNC_TICK_US					LCD_DATA_WRITE_US 	// Microseconds between two bytes. At least LCD_DATA_WRITE_US
+#define LCD_QUEUE_SIZE						64 	// Bytes, must be a power of 2. A full 16x2 screen is 32 characters + 2 commands
+
+// Shadow buffer - TRUE: text goes to a copy of the screen in RAM (2 bytes per character),
+// LCDFlush() sends only the characters that changed. Commands that don't write text are sent right away.
+// Don't use a visible cursor with it, the cursor stays where the last flush ended.
+// LCDFindCharPositions() sends raw DDRAM addresses, use it with FALSE.
+#define LCD_SHADOW							TRUE // TRUE or FALSE
+
 // Text wrap - If the text length is greater than the numbers of LCD characters
 // the cursor will be set on the beginning of the next line
 #define LCD_WRAP_TEXT						FALSE // TRUE or FALSE
 
+// Sensor readings in tenths can be displayed with LCDWriteFixed() without floats.
 // To be able to use LCDWriteFloat(), make this equal to 1. Enabling this, will load
 // the math library and will add over a KB to the program size. If you are not planning to
 // display floats, then make this equal to 0. If you are using it, then uncomment MATH_LIB = -lm
@@ -233,12 +340,17 @@ ________________________________________________________________________________
 #define BIG_DIGITS_1_CHARACTERS	    		FALSE // TRUE or FALSE - double height 1 character wide font
 #define BIG_DIGITS_3_CHARACTERS	    		FALSE // TRUE or FALSE - double height 3 character wide font
 
+// Custom characters loaded into CGRAM only when needed, used by LCDWriteBigFixed().
+// The cache uses all 8 CGRAM places, so LCD_CUSTOM_CHARS and BIG_DIGITS_x_CHARACTERS must be FALSE
+#define LCD_GLYPH_CACHE						TRUE // TRUE or FALSE
+#define LCD_GLYPH_FALLBACK					0xFF // Shown when all 8 places hold glyphs that are on the screen (full block)
+
 // * Animations *
 // This types of LCD aren't meant for animations
 // The crystals have slow rise and fall times. Use TFT LCDs for animations
-// But if you want you can try this function
+// But if you want you can try this functions. They don't block, LCDAnimate() moves the text
 #define LCD_ANIMATIONS						FALSE 	// TRUE or FALSE
-#define LCD_SCROLL_SPEED					200 	// milliseconds
+#define LCD_SCROLL_SPEED					200 	// milliseconds per character of LCDScrollText()
 
 // * Utils *
 // A function used to find positions on LCD.
@@ -330,6 +442,76 @@ ________________________________________________________________________________
 #define LCD_CURSOR_NONE	 	0b00000000
 
 #define LCD_MAXIMUM_DIGITS	10
+#define LCD_MAXIMUM_DECIMALS	4 // int16_t has 5 digits
+
+// DDRAM characters of a line on 1 and 2 line displays. The display shift goes around them
+#define LCD_DDRAM_LINE			40
+#define LCD_SCROLL_HARDWARE_MAX	(LCD_DDRAM_LINE - LCD_NR_OF_CHARACTERS) // Longest text moved by the display shift
+
+// Timing profiles from the datasheets (5V). Enable pulse and cycle in ns, execution times in us
+#if LCD_CONTROLLER == LCD_HD44780
+	#define LCD_PROFILE_ENABLE_HIGH_NS	450 	// PWEH
+	#define LCD_PROFILE_ENABLE_CYCLE_NS	1000 	// tcycE
+	#define LCD_PROFILE_CLEAR_US		1520 	// Clear display, return home
+	#define LCD_PROFILE_COMMAND_US		37 		// Other instructions
+	#define LCD_PROFILE_DATA_US			41 		// Write to DDRAM/CGRAM, 37 us + tADD 4 us
+#elif LCD_CONTROLLER == LCD_ST7066
+	#define LCD_PROFILE_ENABLE_HIGH_NS	460
+	#define LCD_PROFILE_ENABLE_CYCLE_NS	1200
+	#define LCD_PROFILE_CLEAR_US		1520
+	#define LCD_PROFILE_COMMAND_US		37
+	#define LCD_PROFILE_DATA_US			43
+#elif LCD_CONTROLLER == LCD_KS0066
+	#define LCD_PROFILE_ENABLE_HIGH_NS	230
+	#define LCD_PROFILE_ENABLE_CYCLE_NS	500
+	#define LCD_PROFILE_CLEAR_US		1530
+	#define LCD_PROFILE_COMMAND_US		39
+	#define LCD_PROFILE_DATA_US			43
+#endif
+
+// Waits used by the library. _delay_us() takes fractions of a microsecond
+#define LCD_ENABLE_HIGH_US		(LCD_PROFILE_ENABLE_HIGH_NS / 1000.0)
+#define LCD_ENABLE_LOW_US		((LCD_PROFILE_ENABLE_CYCLE_NS - LCD_PROFILE_ENABLE_HIGH_NS) / 1000.0)
+#define LCD_CLEAR_US			((LCD_PROFILE_CLEAR_US * (100UL + LCD_TIMING_MARGIN)) / 100)
+#define LCD_COMMAND_US			((LCD_PROFILE_COMMAND_US * (100 + LCD_TIMING_MARGIN)) / 100)
+#define LCD_DATA_WRITE_US		((LCD_PROFILE_DATA_US * (100 + LCD_TIMING_MARGIN)) / 100)
+
+// Clear display and return home take LCD_CLEAR_US instead of one tick
+#define LCD_ASYNC_LONG_TICKS	((LCD_CLEAR_US / LCD_ASYNC_TICK_US) + 1)
+
+// Timer2 compare value of one tick, prescaler 8. Rounded up, a shorter tick would not cover the wait
+#define LCD_ASYNC_OCR			((F_CPU / 8UL * LCD_ASYNC_TICK_US + 999999UL) / 1000000UL - 1)
+
+#if LCD_ASYNC == TRUE && LCD_INTERFACE == LCD_PARALLEL
+	#if LCD_ASYNC_OCR < 1 || LCD_ASYNC_OCR > 255
+		#error "LCD_ASYNC_TICK_US doesn't fit Timer2 with prescaler 8 at this F_CPU"
+	#endif
+#endif
+
+// I2C: a byte takes 9 SCL periods. Bytes needed to cover a wait, the next instruction
+// is latched 2 bytes after the previous one anyway, only the rest is sent as padding
+#define LCD_I2C_BYTES(us)		((((us) * (LCD_I2C_SCL_HZ / 1000UL)) + 8999) / 9000)
+#define LCD_I2C_PAD(us)			((LCD_I2C_BYTES(us) > 2) ? (LCD_I2C_BYTES(us) - 2) : 0)
+#define LCD_I2C_NIBBLE			2 // LCDSendByte() type: only the high nibble (reset instructions)
+
+// The queue is used by the asynchronous mode and by the I2C interface
+#if LCD_ASYNC == TRUE || LCD_INTERFACE == LCD_I2C
+	#define LCD_QUEUE			TRUE
+#else
+	#define LCD_QUEUE			FALSE
+#endif
+
+#if LCD_QUEUE == TRUE
+	#include <avr/interrupt.h>
+#endif
+
+#if LCD_SHADOW == TRUE
+	#include <string.h>
+#endif
+
+#if LCD_GLYPH_CACHE == TRUE
+	#include <avr/pgmspace.h>
+#endif
 
 
 /*************************************************************
@@ -340,6 +522,7 @@ void LCDPrintCustomChar(uint8_t char_index);
 void LCDPrintExtraChar(uint8_t char_address);
 void LCDWriteString(const char *msg);
 void LCDWriteInt(int32_t number, int8_t nrOfDigits);
+void LCDWriteFixed(int16_t value, uint8_t decimals);
 void LCDWriteBigSeparator(void);
 void LCDGotoXY(uint8_t x, uint8_t y);
 
@@ -362,13 +545,44 @@ void LCDGotoXY(uint8_t x, uint8_t y);
 #endif
 
 void LCDByte(uint8_t, uint8_t);
+void LCDSendByte(uint8_t, uint8_t);
 void LCDBusyLoop(void);
 void FlashEnable(void);
 
+#if LCD_WRITE_ONLY == TRUE
+	void LCDExecutionWait(uint8_t data, uint8_t isdata);
+#endif
+
+#if LCD_ASYNC == TRUE && LCD_INTERFACE == LCD_PARALLEL
+	void LCDAsyncSetup(void);
+#endif
+
+#if LCD_INTERFACE == LCD_I2C
+	void LCDI2CSetup(void);
+#endif
+
+#if LCD_QUEUE == TRUE
+	uint8_t LCDQueueIdle(void);
+#endif
+
+#if LCD_SHADOW == TRUE
+	void LCDShadowSetup(void);
+	void LCDFlush(void);
+#endif
+
+#if LCD_GLYPH_CACHE == TRUE
+	uint8_t LCDGlyph(const uint8_t *glyph);
+	void LCDWriteBigFixed(int16_t value, uint8_t decimals);
+#endif
+
 // Animations
 #if LCD_ANIMATIONS == TRUE
 	#include <string.h>
 	void LCDScrollText(const char *text);
+	void LCDScrollRegion(uint8_t x, uint8_t y, uint8_t width, const char *text, uint16_t speed);
+	void LCDScrollStop(uint8_t y);
+	void LCDAnimate(uint16_t ms);
+	void LCDScrollDraw(uint8_t row);
 #endif
 
 // Utils
@@ -404,6 +618,11 @@ void FlashEnable(void);
 	LCDWriteInt(nr, nrOfDigits);\
 }
 
+#define LCDWriteFixedXY(x, y, value, decimals){\
+	LCDGotoXY(x, y);\
+	LCDWriteFixed(value, decimals);\
+}
+
 #define LCDWriteFloatXY(x, y, float_number, nrOfDigits, nrOfDecimals)\
 	LCDGotoXY(x, y);\
 	LCDWriteFloat(float_number, nrOfDigits, nrOfDecimals)\
@@ -414,6 +633,84 @@ void FlashEnable(void);
 **************************************************************/
 uint8_t cursorPosition = 1, cursorLine = 1;
 
+#if LCD_QUEUE == TRUE
+	// Queue of bytes for the LCD. LCDByte() writes the head, the Timer2 or TWI ISR the tail
+	volatile uint8_t LCDQueueData[LCD_QUEUE_SIZE];
+	volatile uint8_t LCDQueueIsData[LCD_QUEUE_SIZE];	// 1 - data (RS HIGH), 0 - command, LCD_I2C_NIBBLE
+	volatile uint8_t LCDQueueHead = 0, LCDQueueTail = 0;
+	volatile uint8_t LCDWaitTicks = 0;					// Ticks to wait for a slow command
+#endif
+
+#if LCD_INTERFACE == LCD_I2C
+	volatile uint8_t LCDI2CBusy = 0;					// 1 - a TWI transaction is running
+	uint8_t LCDI2CStep = 0;								// PCF8574 bytes of the current LCD byte already sent
+	uint8_t LCDI2CPad = 0;								// Bytes to repeat while the LCD executes
+	uint8_t LCDI2CLast = 0;								// Last byte sent to the PCF8574
+#endif
+
+#if LCD_SHADOW == TRUE
+	uint8_t LCDShadow[LCD_NR_OF_ROWS][LCD_NR_OF_CHARACTERS];	// What should be on the screen
+	uint8_t LCDShown[LCD_NR_OF_ROWS][LCD_NR_OF_CHARACTERS];		// What was sent to the LCD
+	uint8_t LCDFlushAddress = 0xFF;								// DDRAM address the LCD writes to next, 0xFF - unknown
+	uint8_t LCDShadowCGRAM = 0;									// 1 - data goes to CGRAM (custom characters), not to the screen
+
+	// DDRAM address of the first character of each row (same as in LCDGotoXY)
+	static const uint8_t LCDRowAddress[4] = {0x00, 0x40, LCD_NR_OF_CHARACTERS, 0x40 + LCD_NR_OF_CHARACTERS};
+#endif
+
+#if LCD_GLYPH_CACHE == TRUE
+	const uint8_t *LCDGlyphCache[8];	// Glyph in each CGRAM place, 0 - empty
+	uint8_t LCDGlyphUsed[8];			// LCDGlyphTick of the last use, the oldest one is replaced
+	uint8_t LCDGlyphTick = 0;
+	uint8_t LCDGlyphLocked = 0;			// Places used by the number being drawn, not replaced
+	uint16_t LCDGlyphUploads = 0;		// Number of glyphs sent to CGRAM, to see if the cache works
+
+	// Segment glyphs of the big digits. L, R - left or right vertical bar, T, B - top or bottom bar.
+	// 8 glyphs, one per CGRAM place: a bottom bar alone is the "_" of the character ROM instead
+	#define LCD_BIG_NONE	0xFF	// Space
+	#define LCD_BIG_BAR		0xFE	// "_"
+	static const uint8_t LCDBigGlyphs[8][8] PROGMEM = {
+		{0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18}, // 0 - LT
+		{0x1F, 0x1F, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03}, // 1 - RT
+		{0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F}, // 2 - LB
+		{0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x1F, 0x1F}, // 3 - RB
+		{0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F}, // 4 - TB
+		{0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F}, // 5 - LTB
+		{0x1F, 0x1F, 0x03, 0x03, 0x03, 0x03, 0x1F, 0x1F}, // 6 - RTB
+		{0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03}, // 7 - R
+	};
+
+	// Glyphs of each digit: top left, top right, bottom left, bottom right
+	static const uint8_t LCDBigDigits[10][4] PROGMEM = {
+		{0, 1, 2, 3},							// 0
+		{LCD_BIG_NONE, 7, LCD_BIG_NONE, 7},		// 1
+		{4, 6, 2, LCD_BIG_BAR},					// 2
+		{4, 6, LCD_BIG_BAR, 3},					// 3
+		{2, 3, LCD_BIG_NONE, 7},				// 4
+		{5, 4, LCD_BIG_BAR, 3},					// 5
+		{5, 4, 2, 3},							// 6
+		{0, 1, LCD_BIG_NONE, 7},				// 7
+		{5, 6, 2, 3},							// 8
+		{5, 6, LCD_BIG_BAR, 3},					// 9
+	};
+#endif
+
+#if LCD_ANIMATIONS == TRUE
+	// Scroll region, one per line
+	typedef struct{
+		const char *text;		// 0 - nothing scrolls on this line
+		uint16_t length;
+		uint16_t step;			// 0 - region empty, the text comes in from the right
+		uint16_t speed;			// Milliseconds per step
+		uint16_t elapsed;		// Milliseconds since the last step
+		uint8_t x;				// First character of the region, 0 based
+		uint8_t width;
+	} LCD_SCROLL_t;
+
+	LCD_SCROLL_t LCDScrollRegions[LCD_NR_OF_ROWS];
+	uint8_t LCDScrollHardware = 0;	// 1 - LCDScrollText() moves the whole display with the shift command
+#endif
+
 
 /*************************************************************
 	FUNCTIONS
@@ -440,18 +737,62 @@ void LCDSetup(uint8_t cursorStyle){
 	#endif
 
 	// Set MCU IO Ports
-	LCD_DATA_DDR |= (0x0F << LCD_DATA_START_PIN);
-	LCD_DATA_PORT &= (~(0x0F << LCD_DATA_START_PIN));
-	LCD_RS_CONTROL_DDR |= (1 << LCD_RS_PIN);
-	LCD_RW_CONTROL_DDR |= (1 << LCD_RW_PIN);
-	LCD_E_CONTROL_DDR  |= (1 << LCD_E_PIN) | (1 << LCD_RW_PIN) | (1 << LCD_RS_PIN);
-	E_OFF();
-	RW_OFF();
-	RS_OFF();
+	#if LCD_INTERFACE == LCD_PARALLEL
+		#if LCD_DATA_BUS_SIZE == LCD_DATA_8_BITS
+			LCD_DATA_DDR = 0xFF;
+			LCD_DATA_PORT = 0x00;
+		#elif LCD_DATA_BUS_SIZE == LCD_DATA_4_BITS
+			LCD_DATA_DDR |= (0x0F << LCD_DATA_START_PIN);
+			LCD_DATA_PORT &= (~(0x0F << LCD_DATA_START_PIN));
+		#endif
+		LCD_RS_CONTROL_DDR |= (1 << LCD_RS_PIN);
+		LCD_E_CONTROL_DDR  |= (1 << LCD_E_PIN);
+		#if LCD_WRITE_ONLY == FALSE
+			LCD_RW_CONTROL_DDR |= (1 << LCD_RW_PIN);
+			RW_OFF();
+		#endif
+		E_OFF();
+		RS_OFF();
+	#endif
+
+	#if LCD_ASYNC == TRUE && LCD_INTERFACE == LCD_PARALLEL
+		LCDAsyncSetup();
+	#endif
+
+	#if LCD_INTERFACE == LCD_I2C
+		LCDI2CSetup();
+
+		// LCD reset instructions according to datasheet's flowchart. Every nibble is followed
+		// by LCD_CLEAR_US of padding, only the first one needs more (4.1 ms)
+		LCDSendByte(0b00110000, LCD_I2C_NIBBLE);
+		while(!LCDQueueIdle());
+		_delay_ms(5);
+		LCDSendByte(0b00110000, LCD_I2C_NIBBLE);
+		LCDSendByte(0b00110000, LCD_I2C_NIBBLE);
+		LCDSendByte(0b00100000, LCD_I2C_NIBBLE); // Set 4 bit mode
+		// End reset
+
+		LCDCmd(0x28); // 4 bit mode. Function Set: 4-bit, 2 Line, 5x7 Dots
+		LCDCmd(LCD_DISPLAY_OFF);
+		LCDCmd(0b00000110); // Entry Mode Set
+		LCDCmd(LCD_DISPLAY_ON | cursorStyle); // Turn on display, set cursor type
+
+	#elif LCD_DATA_BUS_SIZE == LCD_DATA_8_BITS
+		// LCD reset instructions according to datasheet's flowchart, the busy flag can't be read yet
+		LCD_DATA_PORT = 0b00110000;
+		FlashEnable();
+		_delay_ms(5);
+		FlashEnable();
+		_delay_us(150);
+		FlashEnable();
+		_delay_us(150);
+		LCD_DATA_PORT = 0x00;
+		// End reset
 
-	#if LCD_DATA_BUS_SIZE == LCD_DATA_8_BITS
-		LCDCmd(0b00001100 | cursorStyle); // Turn on display, set cursor type
 		LCDCmd(0x38); // 8 bit mode. Function Set: 8-bit, 2 Line, 5x7 Dots
+		LCDCmd(LCD_DISPLAY_OFF);
+		LCDCmd(0b00000110); // Entry Mode Set
+		LCDCmd(LCD_DISPLAY_ON | cursorStyle); // Turn on display, set cursor type
 
 	#elif LCD_DATA_BUS_SIZE == LCD_DATA_4_BITS
 		// LCD reset instructions according to datasheet's flowchart
@@ -504,6 +845,7 @@ void LCDSetup(uint8_t cursorStyle){
 		_delay_ms(1);
 		LCD_DATA_PORT &= ~(0x0F << LCD_DATA_START_PIN);
 		FlashEnable();
+		_delay_ms(1);
 		// End of initialization
 
 		LCD_DATA_PORT |= ((0b00000010) << LCD_DATA_START_PIN);
@@ -531,6 +873,10 @@ void LCDSetup(uint8_t cursorStyle){
 		LCDBacklightPWM(100);
 	#endif
 
+	#if LCD_SHADOW == TRUE
+		LCDShadowSetup();
+	#endif
+
 	LCDClear();
 	LCDHome();
 }
@@ -1032,6 +1378,44 @@ void LCDWriteInt(int32_t number, int8_t nrOfDigits){
 
 
 
+/*-------------------------------------------------------------------------------------------------------------------------------
+*	PRINT A FIXED POINT NUMBER ON THE DISPLAY
+*	Only 16-bit integer math, so the float library is not needed. Good for sensors that give
+*	tenths (DHT22) - the value is printed as it is, no rounding.
+*
+*	@param [value]				number in units of 10^-decimals. E.g: 275 with 1 decimal is 27.5
+*
+*	@param [decimals] 			digits after the point, 0 to LCD_MAXIMUM_DECIMALS. 0 prints an integer.
+*								Leading zeros after the point are kept: 5 with 2 decimals is "0.05"
+*
+*   @return 					NONE
+*--------------------------------------------------------------------------------------------------------------------------------*/
+void LCDWriteFixed(int16_t value, uint8_t decimals){
+	char string[8]; // "-3.2768" or "-32768" + 0
+	uint8_t i = sizeof(string) - 1;
+	uint8_t digits = 0;
+	uint16_t number = value;
+
+	if(value < 0) number = 0 - number; // Also right for -32768
+	if(decimals > LCD_MAXIMUM_DECIMALS) decimals = LCD_MAXIMUM_DECIMALS;
+
+	string[i] = 0;
+
+	// From the last digit, at least one digit before the point
+	do{
+		string[--i] = (number % 10) + '0';
+		number /= 10;
+		digits++;
+		if(digits == decimals) string[--i] = '.';
+	}while(number || digits <= decimals);
+
+	if(value < 0) string[--i] = '-';
+
+	LCDWriteString(&string[i]);
+}
+
+
+
 /*-------------------------------------------------------------------------------------------------------------------------------
 *	PRINT A FLOAT NUMBER ON THE DISPLAY
 *
@@ -1114,7 +1498,6 @@ void LCDWriteInt(int32_t number, int8_t nrOfDigits){
 *   @return 					NONE
 *--------------------------------------------------------------------------------------------------------------------------------*/
 void LCDGotoXY(uint8_t x, uint8_t y){
-	LCDBusyLoop();
 	if(x == 0 || x == 255) x = 1; // User can use 0 or 1 as starting character position
 	cursorPosition = x;
 	cursorLine = y;
@@ -1198,41 +1581,113 @@ void LCDGotoXY(uint8_t x, uint8_t y){
 
 
 void LCDByte(uint8_t data, uint8_t isdata){
-	LCDBusyLoop();
+	#if LCD_SHADOW == TRUE
+		uint8_t row = cursorLine, column = cursorPosition - 1;
+	#endif
 
 	if(isdata == 0){
-		RS_OFF(); // Send command - RS to 0
 		if(data == 0b10000000 || data == 0b00000001){
 			cursorPosition = 1;
 			cursorLine = 1;
 		}
 	}else{
-		RS_ON(); // Send data - RS to 1
 		cursorPosition++;
 	}
 
-	RW_OFF(); // RW to 0 - write mode
+	#if LCD_SHADOW == TRUE
+		if(isdata){
+			if(LCDShadowCGRAM == 0){
+				if(row == 0 || row == 255) row = 1; // Same as LCDGotoXY
+				if(row <= LCD_NR_OF_ROWS && column < LCD_NR_OF_CHARACTERS) LCDShadow[row - 1][column] = data;
+				return;
+			}
+		}else if(data == 0b00000001){ // Clear display
+			memset(LCDShadow, ' ', sizeof(LCDShadow));
+			LCDShadowCGRAM = 0;
+			return;
+		}else if(data & 0b10000000){ // DDRAM address - LCDGotoXY already moved the cursor
+			LCDShadowCGRAM = 0;
+			return;
+		}else{
+			if((data & 0b11000000) == 0b01000000) LCDShadowCGRAM = 1; // CGRAM address
+			LCDFlushAddress = 0xFF; // The command could move the address
+		}
+	#endif
 
-	#if LCD_DATA_BUS_SIZE == LCD_DATA_8_BITS
-		LCD_DATA_PORT = data;
-		FlashEnable();
-		LCD_DATA_PORT = 0x00;
+	LCDSendByte(data, isdata);
+}
 
-	#elif LCD_DATA_BUS_SIZE == LCD_DATA_4_BITS
-		unsigned char temp; // If signed, after shift MSB will be replaced with 1 instead of 0 and we don't want that
-		uint8_t shift = PORT_SIZE - (LCD_DATA_START_PIN + 4);
 
-		// Send high nibble
-		temp = (data & 0xF0); // Mask the lower nibble
-		LCD_DATA_PORT |= temp >> shift; // Put data on data port
-		FlashEnable();
-		LCD_DATA_PORT &= ~(0x0F << LCD_DATA_START_PIN);
 
-		// Send low nibble
-		temp = ((data << 4) & 0xF0); // Shift 4-bit and mask
-		LCD_DATA_PORT |= temp >> shift;
-		FlashEnable();
-		LCD_DATA_PORT &= ~(0x0F << LCD_DATA_START_PIN); // Clear data port
+/*---------------------------------------------------------------------------------------------------
+*	Send a byte to the LCD (or to the queue in asynchronous or I2C mode), bypassing the shadow buffer
+*
+*	@param [data] 				command or character
+*
+*	@param [isdata] 			1 - character (RS HIGH), 0 - command
+*
+*   @return 					NONE
+*----------------------------------------------------------------------------------------------------*/
+void LCDSendByte(uint8_t data, uint8_t isdata){
+	#if LCD_QUEUE == TRUE
+		uint8_t head = LCDQueueHead;
+		uint8_t next = (head + 1) & (LCD_QUEUE_SIZE - 1);
+
+		while(next == LCDQueueTail); // Queue full - wait for the ISR to send a byte
+
+		LCDQueueData[head] = data;
+		LCDQueueIsData[head] = isdata;
+		LCDQueueHead = next;
+
+		#if LCD_INTERFACE == LCD_I2C
+			if(LCDI2CBusy == 0){ // The ISR keeps the transaction going while there is something in the queue
+				LCDI2CBusy = 1;
+				while(TWCR & (1 << TWSTO)); // Previous stop condition still on the bus
+				TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE); // Start condition
+			}
+		#else
+			TIMSK2 |= (1 << OCIE2A); // Start sending
+		#endif
+	#else
+		#if LCD_WRITE_ONLY == FALSE
+			LCDBusyLoop();
+		#endif
+
+		if(isdata == 0){
+			RS_OFF(); // Send command - RS to 0
+		}else{
+			RS_ON(); // Send data - RS to 1
+		}
+
+		#if LCD_WRITE_ONLY == FALSE
+			RW_OFF(); // RW to 0 - write mode
+		#endif
+
+		#if LCD_DATA_BUS_SIZE == LCD_DATA_8_BITS
+			LCD_DATA_PORT = data;
+			FlashEnable();
+			LCD_DATA_PORT = 0x00;
+
+		#elif LCD_DATA_BUS_SIZE == LCD_DATA_4_BITS
+			unsigned char temp; // If signed, after shift MSB will be replaced with 1 instead of 0 and we don't want that
+			uint8_t shift = PORT_SIZE - (LCD_DATA_START_PIN + 4);
+
+			// Send high nibble
+			temp = (data & 0xF0); // Mask the lower nibble
+			LCD_DATA_PORT |= temp >> shift; // Put data on data port
+			FlashEnable();
+			LCD_DATA_PORT &= ~(0x0F << LCD_DATA_START_PIN);
+
+			// Send low nibble
+			temp = ((data << 4) & 0xF0); // Shift 4-bit and mask
+			LCD_DATA_PORT |= temp >> shift;
+			FlashEnable();
+			LCD_DATA_PORT &= ~(0x0F << LCD_DATA_START_PIN); // Clear data port
+		#endif
+
+		#if LCD_WRITE_ONLY == TRUE
+			LCDExecutionWait(data, isdata);
+		#endif
 	#endif
 }
 
@@ -1250,26 +1705,32 @@ void LCDBusyLoop(){
 
 	// Check LCD status 0b10000000 means busy, 0b00000000 means clear
 	#if LCD_DATA_BUS_SIZE == LCD_DATA_8_BITS
+		uint8_t busy;
+
 		do{
-			FlashEnable();
-		}while(LCD_DATA_PIN >= 0x80);
+			E_ON();
+			_delay_us(LCD_ENABLE_HIGH_US); // 'Delay data time' is shorter than 'Enable pulse width'
+			busy = LCD_DATA_PIN & 0b10000000; // Read while E is HIGH, the data is gone after it goes LOW
+			E_OFF();
+			_delay_us(LCD_ENABLE_LOW_US);
+		}while(busy);
 	#elif LCD_DATA_BUS_SIZE == LCD_DATA_4_BITS
 		uint8_t busy, high_nibble;
 
 		do{
 			// Read high nibble
 			E_ON();
-			_delay_us(1); // Implement 'Delay data time' (160 nS) and 'Enable pulse width' (230 nS)
+			_delay_us(LCD_ENABLE_HIGH_US); // Implement 'Delay data time' (160 nS) and 'Enable pulse width'
 			high_nibble = LCD_DATA_PIN >> LCD_DATA_START_PIN;
 			high_nibble = high_nibble << 4;
 			E_OFF();
-			_delay_us(1); // Implement 'Address hold time' (10 nS), 'Data hold time' (10 nS), and 'Enable cycle time' (500 nS )
+			_delay_us(LCD_ENABLE_LOW_US); // Implement 'Address hold time', 'Data hold time' and 'Enable cycle time'
 
 			// No need for low nibble
 			E_ON();
-			_delay_us(1);
+			_delay_us(LCD_ENABLE_HIGH_US);
 			E_OFF();
-			_delay_us(1);
+			_delay_us(LCD_ENABLE_LOW_US);
 
 			busy = high_nibble & 0b10000000;
 		}while(busy);
@@ -1287,66 +1748,603 @@ void LCDBusyLoop(){
 
 
 
+/*---------------------------------------------------------------------------------------------------
+*	Enable pulse as short as the controller allows. E stays LOW for the rest of the enable cycle,
+*	so two pulses can follow each other (the two nibbles of a byte).
+*	The LCD executes the instruction after E goes LOW, waiting for it is up to the caller.
+*----------------------------------------------------------------------------------------------------*/
 void FlashEnable(){
 	E_ON(); // Enable on
-	_delay_us(50); // Wait
+	_delay_us(LCD_ENABLE_HIGH_US); // 'Enable pulse width'
 	E_OFF(); // Execute
+	_delay_us(LCD_ENABLE_LOW_US); // Rest of 'Enable cycle time'
 }
 
 
 
+#if LCD_WRITE_ONLY == TRUE
+	/*---------------------------------------------------------------------------------------------------
+	*	Wait the execution time of an instruction that was just sent, the busy flag can't be read
+	*
+	*	@param [data] 				command or character that was sent
+	*
+	*	@param [isdata] 			1 - character, 0 - command
+	*
+	*   @return 					NONE
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDExecutionWait(uint8_t data, uint8_t isdata){
+		if(isdata){
+			_delay_us(LCD_DATA_WRITE_US);
+		}else if(data < 0b00000100){
+			_delay_us(LCD_CLEAR_US); // Clear display and return home
+		}else{
+			_delay_us(LCD_COMMAND_US);
+		}
+	}
+#endif
+
+
+
+/* ----------------------------------- ASYNCHRONOUS MODE */
+#if LCD_ASYNC == TRUE && LCD_INTERFACE == LCD_PARALLEL
+	/*---------------------------------------------------------------------------------------------------
+	*	Timer2 in CTC mode, compare match A every LCD_ASYNC_TICK_US. Prescaler 8.
+	*	The interrupt is enabled only while there is something in the queue.
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDAsyncSetup(void){
+		TIMSK2 &= ~(1 << OCIE2A);
+		TCCR2A = (1 << WGM21); // CTC mode
+		TCCR2B = (1 << CS21); // Prescaler 8
+		OCR2A = LCD_ASYNC_OCR;
+		LCDQueueHead = LCDQueueTail = 0;
+		LCDWaitTicks = 0;
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	Returns 1 if all the bytes have been sent and the LCD is ready, 0 otherwise
+	*----------------------------------------------------------------------------------------------------*/
+	uint8_t LCDQueueIdle(void){
+		return (LCDQueueHead == LCDQueueTail) && (LCDWaitTicks == 0);
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	One byte per tick. The tick is longer than the execution time of the LCD (LCD_DATA_WRITE_US),
+	*	so the busy flag doesn't need to be read. In 4-bit mode both nibbles are sent in the same tick,
+	*	the LCD needs only the enable cycle time between them, not the execution time.
+	*	The compare flag stays set while the interrupt is disabled, so the first nibble after
+	*	an idle time is sent as soon as LCDByte() enables it - the LCD is already ready by then.
+	*	The counter restarts after every byte, so the next byte comes a full tick later even when
+	*	this one was sent on the old compare flag, in the middle of a tick.
+	*----------------------------------------------------------------------------------------------------*/
+	ISR(TIMER2_COMPA_vect){
+		uint8_t tail, data;
+
+		if(LCDWaitTicks){
+			LCDWaitTicks--;
+			return;
+		}
+
+		tail = LCDQueueTail;
+		if(tail == LCDQueueHead){
+			TIMSK2 &= ~(1 << OCIE2A); // Nothing to send, stop until the next LCDByte()
+			return;
+		}
+
+		data = LCDQueueData[tail];
+		if(LCDQueueIsData[tail]) RS_ON();
+		else RS_OFF();
+
+		#if LCD_DATA_BUS_SIZE == LCD_DATA_8_BITS
+			LCD_DATA_PORT = data;
+		#elif LCD_DATA_BUS_SIZE == LCD_DATA_4_BITS
+			LCD_DATA_PORT = (LCD_DATA_PORT & ~(0x0F << LCD_DATA_START_PIN)) | ((data >> 4) << LCD_DATA_START_PIN);
+			E_ON();
+			_delay_us(LCD_ENABLE_HIGH_US);
+			E_OFF();
+			_delay_us(LCD_ENABLE_LOW_US);
+
+			LCD_DATA_PORT = (LCD_DATA_PORT & ~(0x0F << LCD_DATA_START_PIN)) | ((data & 0x0F) << LCD_DATA_START_PIN);
+		#endif
+
+		E_ON();
+		_delay_us(LCD_ENABLE_HIGH_US);
+		E_OFF();
+		TCNT2 = 0; // Next byte one tick from now
+
+		// Clear display and return home
+		if(LCDQueueIsData[tail] == 0 && data < 0b00000100) LCDWaitTicks = LCD_ASYNC_LONG_TICKS;
+
+		LCDQueueTail = (tail + 1) & (LCD_QUEUE_SIZE - 1);
+	}
+#endif
+
+
+
+/* ----------------------------------- I2C INTERFACE */
+#if LCD_INTERFACE == LCD_I2C
+	/*---------------------------------------------------------------------------------------------------
+	*	TWI master at LCD_I2C_SCL_HZ, prescaler 1. Called by LCDSetup().
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDI2CSetup(void){
+		TWSR = 0;
+		TWBR = ((F_CPU / LCD_I2C_SCL_HZ) - 16) / 2;
+		TWCR = (1 << TWEN);
+		LCDQueueHead = LCDQueueTail = 0;
+		LCDI2CBusy = 0;
+		LCDI2CStep = 0;
+		LCDI2CPad = 0;
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	Returns 1 if all the bytes have been sent and the LCD is ready, 0 otherwise
+	*----------------------------------------------------------------------------------------------------*/
+	uint8_t LCDQueueIdle(void){
+		return (LCDQueueHead == LCDQueueTail) && (LCDI2CBusy == 0);
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	One PCF8574 byte per interrupt. An LCD byte is 4 of them: high nibble with E HIGH, the same
+	*	with E LOW (the LCD reads it on the falling edge), then the low nibble the same way.
+	*	The transaction stays open while the queue has bytes. After an instruction the last byte is
+	*	repeated until its execution time has passed (LCD_I2C_PAD). At 100 kHz a byte takes 90 us,
+	*	so only clear display and return home need it.
+	*----------------------------------------------------------------------------------------------------*/
+	ISR(TWI_vect){
+		uint8_t tail, data, type, out;
+
+		switch(TWSR & 0xF8){
+			case 0x08: // Start condition sent
+				TWDR = LCD_I2C_ADDRESS << 1; // SLA+W
+				TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+				return;
+
+			case 0x18: // SLA+W sent, ACK received
+			case 0x28: // Data sent, ACK received
+			break;
+
+			default: // No ACK or bus error. Drop the queue, nothing should wait for a missing LCD
+				LCDQueueTail = LCDQueueHead;
+				LCDI2CStep = 0;
+				LCDI2CPad = 0;
+				LCDI2CBusy = 0;
+				TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+				return;
+		}
+
+		if(LCDI2CPad){
+			LCDI2CPad--;
+			out = LCDI2CLast; // Same outputs, E stays LOW
+
+		}else{
+			tail = LCDQueueTail;
+			if(tail == LCDQueueHead){
+				LCDI2CBusy = 0;
+				TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN); // Nothing to send, stop condition
+				return;
+			}
+
+			data = LCDQueueData[tail];
+			type = LCDQueueIsData[tail];
+
+			if(LCDI2CStep >= 2) data <<= 4; // Low nibble
+			out = (data & 0xF0) | LCD_I2C_BACKLIGHT;
+			if(type == 1) out |= LCD_I2C_RS;
+			if((LCDI2CStep & 1) == 0) out |= LCD_I2C_E;
+			LCDI2CStep++;
+
+			if(LCDI2CStep == 4 || (LCDI2CStep == 2 && type == LCD_I2C_NIBBLE)){
+				LCDI2CStep = 0;
+				if(type == 1){
+					LCDI2CPad = LCD_I2C_PAD(LCD_DATA_WRITE_US);
+				}else if(type == LCD_I2C_NIBBLE || LCDQueueData[tail] < 0b00000100){ // Clear display and return home
+					LCDI2CPad = LCD_I2C_PAD(LCD_CLEAR_US);
+				}else{
+					LCDI2CPad = LCD_I2C_PAD(LCD_COMMAND_US);
+				}
+				LCDQueueTail = (tail + 1) & (LCD_QUEUE_SIZE - 1);
+			}
+			LCDI2CLast = out;
+		}
+
+		TWDR = out;
+		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+	}
+#endif
+
+
+
+/* ----------------------------------- SHADOW BUFFER */
+#if LCD_SHADOW == TRUE
+	/*---------------------------------------------------------------------------------------------------
+	*	Clear the LCD and both copies of the screen. Called by LCDSetup().
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDShadowSetup(void){
+		LCDSendByte(0b00000001, 0);
+		memset(LCDShadow, ' ', sizeof(LCDShadow));
+		memset(LCDShown, ' ', sizeof(LCDShown));
+		LCDFlushAddress = 0;
+		LCDShadowCGRAM = 0;
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	Send the characters that changed since the last flush. The LCD moves to the next address
+	*	after every character, so a run of changed characters needs only one DDRAM address command.
+	*	A single unchanged character between two changed ones is sent again instead of
+	*	the address command - same number of bytes, one repositioning less.
+	*
+	*	@param [] 					NONE
+	*
+	*   @return 					NONE
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDFlush(void){
+		uint8_t row, column, address;
+
+		for(row = 0; row < LCD_NR_OF_ROWS; row++){
+			for(column = 0; column < LCD_NR_OF_CHARACTERS; column++){
+				if(LCDShadow[row][column] == LCDShown[row][column]) continue;
+
+				address = LCDRowAddress[row] + column;
+				if(LCDFlushAddress != address){
+					if(column > 0 && LCDFlushAddress == address - 1){
+						LCDSendByte(LCDShown[row][column - 1], 1);
+					}else{
+						LCDSendByte(0b10000000 | address, 0);
+					}
+				}
+
+				LCDSendByte(LCDShadow[row][column], 1);
+				LCDShown[row][column] = LCDShadow[row][column];
+				LCDFlushAddress = address + 1;
+			}
+		}
+	}
+#endif
+
+
+
+/* ----------------------------------- GLYPH CACHE */
+#if LCD_GLYPH_CACHE == TRUE
+	/*---------------------------------------------------------------------------------------------------
+	*	Find the glyph in CGRAM or load it there. On a miss the place used least recently is
+	*	replaced, but with LCD_SHADOW only a place that is not on the screen (shadow copy)
+	*	and never a place in LCDGlyphLocked.
+	*	After a load the LCD address is in CGRAM, use LCDGotoXY() before the next character.
+	*
+	*	@param [glyph] 				8 bytes (rows) in flash (PROGMEM), 5 bits each
+	*
+	*   @return 					character code of the glyph (0 - 7) or LCD_GLYPH_FALLBACK
+	*								if no place could be freed
+	*----------------------------------------------------------------------------------------------------*/
+	uint8_t LCDGlyph(const uint8_t *glyph){
+		uint8_t slot, victim = 0xFF, oldest = 0, age, i;
+
+		LCDGlyphTick++;
+		for(slot = 0; slot < 8; slot++){
+			if(LCDGlyphCache[slot] == glyph){
+				LCDGlyphUsed[slot] = LCDGlyphTick;
+				return slot;
+			}
+		}
+
+		for(slot = 0; slot < 8; slot++){
+			if(LCDGlyphCache[slot] == 0){
+				victim = slot;
+				break;
+			}
+
+			if(LCDGlyphLocked & (1 << slot)) continue;
+
+			#if LCD_SHADOW == TRUE
+				if(memchr(LCDShadow, slot, sizeof(LCDShadow))) continue; // Still on the screen
+			#endif
+
+			age = LCDGlyphTick - LCDGlyphUsed[slot];
+			if(age >= oldest){
+				oldest = age;
+				victim = slot;
+			}
+		}
+
+		if(victim == 0xFF) return LCD_GLYPH_FALLBACK;
+
+		LCDCmd(0b01000000 | (victim << 3)); // CGRAM address of the place
+		for(i = 0; i < 8; i++){
+			LCDData(pgm_read_byte(&glyph[i]));
+		}
+
+		LCDGlyphCache[victim] = glyph;
+		LCDGlyphUsed[victim] = LCDGlyphTick;
+		LCDGlyphUploads++;
+		return victim;
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	PRINT A BIG FIXED POINT NUMBER ON TWO LINES
+	*	Digits are 2 characters wide with an empty column between them, the point and the minus sign
+	*	are 1 character wide. Starts at the current cursor position, on the current line and the one
+	*	below. The cursor is left after the number on the first line.
+	*
+	*	@param [value]				number in units of 10^-decimals. E.g: 235 with 1 decimal is 23.5
+	*
+	*	@param [decimals] 			digits after the point, 0 to LCD_MAXIMUM_DECIMALS
+	*
+	*   @return 					NONE
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDWriteBigFixed(int16_t value, uint8_t decimals){
+		char digits[8];
+		uint8_t top[LCD_NR_OF_CHARACTERS], bottom[LCD_NR_OF_CHARACTERS];
+		uint8_t i = sizeof(digits) - 1, width = 0, n, gap, glyph;
+		uint8_t x = cursorPosition, y = cursorLine;
+		uint16_t number = value;
+
+		if(value < 0) number = 0 - number;
+		if(decimals > LCD_MAXIMUM_DECIMALS) decimals = LCD_MAXIMUM_DECIMALS;
+
+		// Same conversion as LCDWriteFixed()
+		digits[i] = 0;
+		n = 0;
+		do{
+			digits[--i] = (number % 10) + '0';
+			number /= 10;
+			n++;
+			if(n == decimals) digits[--i] = '.';
+		}while(number || n <= decimals);
+		if(value < 0) digits[--i] = '-';
+
+		// Both lines first, the glyph loads would move the LCD address
+		LCDGlyphLocked = 0;
+		for(; digits[i]; i++){
+			gap = (width > 0 && digits[i - 1] >= '0' && digits[i] >= '0'); // Empty column between two digits
+			if(width + gap + ((digits[i] >= '0') ? 2 : 1) > LCD_NR_OF_CHARACTERS) break;
+
+			if(digits[i] == '.'){
+				top[width] = ' ';
+				bottom[width++] = '.';
+			}else if(digits[i] == '-'){
+				top[width] = '_'; // Bottom bar of the top line is the middle
+				bottom[width++] = ' ';
+			}else{
+				if(gap){
+					top[width] = ' ';
+					bottom[width++] = ' ';
+				}
+
+				for(n = 0; n < 4; n++){
+					glyph = pgm_read_byte(&LCDBigDigits[digits[i] - '0'][n]);
+					if(glyph == LCD_BIG_NONE){
+						glyph = ' ';
+					}else if(glyph == LCD_BIG_BAR){
+						glyph = '_';
+					}else{
+						glyph = LCDGlyph(LCDBigGlyphs[glyph]);
+						if(glyph < 8) LCDGlyphLocked |= 1 << glyph;
+					}
+					if(n < 2) top[width + n] = glyph;
+					else bottom[width + n - 2] = glyph;
+				}
+				width += 2;
+			}
+		}
+
+		LCDGlyphLocked = 0;
+
+		LCDGotoXY(x, y);
+		for(n = 0; n < width; n++) LCDData(top[n]);
+		LCDGotoXY(x, y + 1);
+		for(n = 0; n < width; n++) LCDData(bottom[n]);
+		LCDGotoXY(x + width, y);
+	}
+#endif
+
+
+
 /* ----------------------------------- ANIMATIONS */
 #if LCD_ANIMATIONS == TRUE
+	/*---------------------------------------------------------------------------------------------------
+	*	Scroll a text from right to left in a part of a line without waiting. The text enters on the right,
+	*	leaves on the left and starts again. LCDAnimate() moves it one character every speed milliseconds.
+	*	Every line has one region, a new region on a line replaces the old one. Calling it again with the
+	*	same text and place only changes the speed, the text keeps scrolling from where it is.
+	*	The text is not copied, it must stay in memory while it scrolls.
+	*
+	*	@param [x]					first character of the region
+	*
+	*	@param [y] 					line number
+	*
+	*	@param [width] 				number of characters of the region
+	*
+	*	@param [text] 				string to scroll
+	*
+	*	@param [speed] 				milliseconds per character
+	*
+	*   @return 					NONE
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDScrollRegion(uint8_t x, uint8_t y, uint8_t width, const char *text, uint16_t speed){
+		LCD_SCROLL_t *region;
+
+		if(x == 0 || x == 255) x = 1; // Same as LCDGotoXY
+		if(y == 0 || y == 255) y = 1;
+		if(x > LCD_NR_OF_CHARACTERS || y > LCD_NR_OF_ROWS) return;
+		if(width > LCD_NR_OF_CHARACTERS - x + 1) width = LCD_NR_OF_CHARACTERS - x + 1;
+
+		region = &LCDScrollRegions[y - 1];
+		if(region->text == text && region->x == x - 1 && region->width == width && LCDScrollHardware == 0){
+			region->speed = speed;
+			return;
+		}
+
+		if(LCDScrollHardware) LCDScrollStop(1); // The display shift of LCDScrollText() would move the region too
+		LCDScrollStop(y);
+		region->x = x - 1;
+		region->width = width;
+		region->length = strlen(text);
+		region->speed = speed;
+		region->elapsed = 0;
+		region->step = 0;
+		region->text = text;
+		LCDScrollDraw(y - 1); // Empty region, the text comes in on the next step
+
+		#if LCD_SHADOW == TRUE
+			LCDFlush();
+		#endif
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	Scroll a string from right to left on line 1 without waiting, LCD_SCROLL_SPEED ms per character.
+	*	The display is cleared. If the text fits in the part of the LCD memory that is not visible
+	*	(LCD_SCROLL_HARDWARE_MAX characters, 1 and 2 line displays) it is written there once and the
+	*	LCD shift command moves the whole display, 1 byte per step. Line 2 moves too, so don't write
+	*	to the LCD while it scrolls. A longer text is scrolled with LCDScrollRegion().
+	*	Stop it with LCDScrollStop(1).
+	*
+	*	@param [text] 				string to scroll
+	*
+	*   @return 					NONE
+	*----------------------------------------------------------------------------------------------------*/
 	void LCDScrollText(const char *text){
-		uint8_t shift_number=1, i=0, chars_to_display=1;
+		uint8_t row;
 		size_t text_size = strlen(text);
-		const char *text_start_pos = text;
 
-		LCDClear();
-		LCDGotoXY(LCD_NR_OF_CHARACTERS, 1);
+		for(row = 1; row <= LCD_NR_OF_ROWS; row++){
+			LCDScrollStop(row);
+		}
 
-		while(shift_number < text_size + LCD_NR_OF_CHARACTERS){
+		#if LCD_NR_OF_ROWS <= 2
+			if(text_size <= LCD_SCROLL_HARDWARE_MAX){
+				#if LCD_SHADOW == TRUE
+					LCDShadowSetup(); // Clear the LCD and both copies, the text goes around the shadow buffer
+				#else
+					LCDClear();
+				#endif
+
+				LCDScrollRegions[0].text = text;
+				LCDScrollRegions[0].speed = LCD_SCROLL_SPEED;
+				LCDScrollRegions[0].elapsed = 0;
+				LCDScrollHardware = 1;
+
+				LCDSendByte(0b10000000 | LCD_NR_OF_CHARACTERS, 0); // Right of the visible part of line 1
+				while(*text){
+					LCDSendByte(*text, 1);
+					text++;
+				}
 
-			while(i < chars_to_display){
-				LCDData(*text);
-				i++;
-				text++;
+				#if LCD_SHADOW == TRUE
+					LCDFlushAddress = 0xFF;
+				#endif
+				return;
 			}
+		#endif
 
-			_delay_ms(LCD_SCROLL_SPEED); // 200 - 300 is a good choise
-			LCDClear();
+		LCDClear();
+		LCDScrollRegion(1, 1, LCD_NR_OF_CHARACTERS, text, LCD_SCROLL_SPEED);
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	Stop the scrolling on a line. The text stays where it is, after LCDScrollText() the display
+	*	shift is undone.
+	*
+	*	@param [y] 					line number
+	*
+	*   @return 					NONE
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDScrollStop(uint8_t y){
+		if(y == 0 || y == 255) y = 1;
+		if(y > LCD_NR_OF_ROWS) return;
+
+		if(y == 1 && LCDScrollHardware){
+			LCDScrollHardware = 0;
+			LCDCmd(0b00000010); // Return home - no display shift
+		}
+		LCDScrollRegions[y - 1].text = 0;
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	Move the scrolling texts. Call it from the main loop or a timer task (not from an interrupt)
+	*	with the time since the last call. A line that is late moves one step, it doesn't catch up.
+	*
+	*	@param [ms] 				milliseconds since the last call
+	*
+	*   @return 					NONE
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDAnimate(uint16_t ms){
+		uint8_t row, moved = 0;
+		LCD_SCROLL_t *region;
+
+		for(row = 0; row < LCD_NR_OF_ROWS; row++){
+			region = &LCDScrollRegions[row];
+			if(region->text == 0) continue;
 
-			if(shift_number < LCD_NR_OF_CHARACTERS && shift_number < text_size){
-				LCDGotoXY(LCD_NR_OF_CHARACTERS - shift_number, 1);
-				text = text_start_pos;
-				chars_to_display++;
+			region->elapsed += ms;
+			if(region->elapsed < region->speed) continue;
+			region->elapsed -= region->speed;
+			if(region->elapsed >= region->speed) region->elapsed = 0;
+
+			if(LCDScrollHardware){
+				LCDCmd(LCD_SHIFT_LEFT); // After LCD_DDRAM_LINE shifts the text is back where it started
 			}else{
-				if(text_size > LCD_NR_OF_CHARACTERS){
-					if(shift_number + 1 > text_size)
-						chars_to_display--;
-					else
-						chars_to_display = LCD_NR_OF_CHARACTERS;
-
-					text = text_start_pos + (shift_number - (LCD_NR_OF_CHARACTERS - 1));
-					LCDGotoXY(1, 1);
-				}else{
-					if(shift_number + 1 > LCD_NR_OF_CHARACTERS){
-						chars_to_display--;
-						text = text_start_pos + (shift_number - LCD_NR_OF_CHARACTERS) + 1;
-						LCDGotoXY(1, 1);
-					}else{
-						text = text_start_pos;
-						chars_to_display = text_size;
-						LCDGotoXY(LCD_NR_OF_CHARACTERS - shift_number, 1);
-					}
-				}
+				LCDScrollDraw(row);
+				moved = 1;
 			}
+		}
 
-			i = 0;
-			shift_number++;
+		#if LCD_SHADOW == TRUE
+			if(moved) LCDFlush();
+		#else
+			(void)moved;
+		#endif
+	}
+
+
+
+	/*---------------------------------------------------------------------------------------------------
+	*	Draw the current step of a scroll region and go to the next one. Without LCD_SHADOW the
+	*	characters are sent right away and the cursor is left after the region.
+	*
+	*	@param [row] 				line, 0 based
+	*
+	*   @return 					NONE
+	*----------------------------------------------------------------------------------------------------*/
+	void LCDScrollDraw(uint8_t row){
+		LCD_SCROLL_t *region = &LCDScrollRegions[row];
+		uint8_t column;
+		int16_t i;
+		char c;
+
+		#if LCD_SHADOW == FALSE
+			LCDGotoXY(region->x + 1, row + 1);
+		#endif
+
+		for(column = 0; column < region->width; column++){
+			i = (int16_t)(region->step + column) - region->width; // Text index in this column
+			c = (i >= 0 && i < (int16_t)region->length) ? region->text[i] : ' ';
+
+			#if LCD_SHADOW == TRUE
+				LCDShadow[row][region->x + column] = c;
+			#else
+				LCDData(c);
+			#endif
 		}
 
-		LCDHome();
+		region->step++;
+		if(region->step >= region->length + region->width) region->step = 0;
 	}
 #endif
 
@@ -1365,6 +2363,10 @@ void FlashEnable(){
 			LCDWriteString("X:");
 			LCDWriteInt(x, 3);
 
+			#if LCD_SHADOW == TRUE
+				LCDFlush();
+			#endif
+
 			_delay_ms(LCD_X_POS_DELAY);
 			LCDClear();
 		}
@@ -25,6 +25,7 @@ K ---------> 4k7 resistor  ---------> GND
 #define F_CPU 8000000UL
 #include <avr/io.h>
 #include <util/delay.h>
+#include <avr/interrupt.h>
 #include "DHT11.h"
 #include "OnLCDLib.h"
 
@@ -35,7 +36,8 @@ K ---------> 4k7 resistor  ---------> GND
 *****************************************/
 
 int main(void){
-    // Initialise the LCD
+    // Initialise the LCD, the bytes are sent by the Timer2 interrupt
+    sei();
     LCDSetup(LCD_CURSOR_NONE);
 
     int8_t DHTreturnCode;
@@ -43,19 +45,24 @@ int main(void){
     while(1){
         DHTreturnCode = DHT11ReadData();
 
+        #if LCD_SHADOW == TRUE
+        LCDClear();				// Only the RAM copy, LCDFlush() sends what changed
+        #else
+        LCDHome();				// A clear takes 1.6 ms and blanks the screen
+        #endif
         if(DHTreturnCode == 1){
-            LCDHome();
             DHT11DisplayTemperature();
             LCDGotoXY(1,2);
             DHT11DisplayHumidity();
         }else{
             if(DHTreturnCode == -1){
-                LCDHome();
                 LCDWriteString("Checksum Error");
             }else{
-                LCDHome();
                 LCDWriteString("Unknown Error");
             }
         }
+        #if LCD_SHADOW == TRUE
+            LCDFlush(); // Send only what changed since the last reading
+        #endif
     }
 }
\ No newline at end of file
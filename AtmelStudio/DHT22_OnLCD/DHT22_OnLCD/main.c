@@ -30,6 +30,7 @@ sudo avrdude -v -v -c usbtiny -p ATmega328P -U flash:w:DHT22_OnLCD.hex:i -U lfus
 #define F_CPU			8000000UL
 #include <avr/io.h>
 #include <util/delay.h>
+#include <avr/interrupt.h>
 #include "OnLCDLib.h"
 
 #define DHT_PORT        PORTC
@@ -37,10 +38,16 @@ sudo avrdude -v -v -c usbtiny -p ATmega328P -U flash:w:DHT22_OnLCD.hex:i -U lfus
 #define DHT_PIN         PINC
 #define DHT22_PIN		5
 
+#define WALL_DISPLAY	TRUE	/* TRUE - big digits over both lines, FALSE - temperature and humidity as text */
+#define READ_PERIOD_MS	2000	/* Time between two readings */
+#define TICK_MS			50		/* The scrolling text moves while waiting for the next reading */
+#define DHT_TIMEOUT		50		/* 2 us steps, the longest level of the sensor is 80 us */
+
 uint8_t c=0,I_RH,D_RH,I_Temp,D_Temp,CheckSum;
+uint8_t dhtTimeout = 0;		/* 1 - the sensor didn't answer or stopped in the middle (not connected) */
 int q;
-float RH, T;
 unsigned char data [5];
+const char sensorHelp[] = "Check the sensor wiring and the pull-up resistor";
 
 void Request()                /* Microcontroller send start pulse/request */
 {
@@ -51,33 +58,81 @@ void Request()                /* Microcontroller send start pulse/request */
 	//ssdDisplay(9);
 }
 
+void WaitWhile(uint8_t level)    /* wait while the pin is high (1) or low (0), at most DHT_TIMEOUT steps */
+{
+	uint8_t timeout = 0;
+
+	while(!dhtTimeout && ((DHT_PIN & (1<<DHT22_PIN)) ? 1 : 0) == level)
+	{
+		/* Safety check, without the sensor the level never changes */
+		timeout++;
+		if(timeout > DHT_TIMEOUT) dhtTimeout = 1;
+		_delay_us(2);
+	}
+}
+
 void Response()                /* receive response from DHT11 */
 {
+	dhtTimeout = 0;
 	DHT_DDR &= ~(1<<DHT22_PIN);
 	DHT_PORT |= (1<<DHT22_PIN);    /* set to high pin */
-	while(DHT_PIN & (1<<DHT22_PIN));
-	while((DHT_PIN & (1<<DHT22_PIN))==0);
-	while(DHT_PIN & (1<<DHT22_PIN));
+	WaitWhile(1);
+	WaitWhile(0);
+	WaitWhile(1);
 }
 
 uint8_t Receive_data()            /* receive data */
 {
 	for (q=0; q<8; q++)
 	{
-		while((DHT_PIN & (1<<DHT22_PIN)) == 0);  /* check received bit 0 or 1 */
+		WaitWhile(0);  /* check received bit 0 or 1 */
 		_delay_us(39);
 		if(DHT_PIN & (1<<DHT22_PIN))/* if high pulse is greater than 30ms */
 		c = (c<<1)|(0x01);    /* then its logic HIGH */
 		else            /* otherwise its logic LOW */
 		c = (c<<1);
-		while(DHT_PIN & (1<<DHT22_PIN));
+		WaitWhile(1);
 	}
 	return c;
 }
 
+int16_t DHT22Temperature()    /* temperature in tenths of a degree C, bit 7 of I_Temp is the sign */
+{
+	int16_t value = ((uint16_t)(I_Temp & 0x7F) << 8) | D_Temp;
+
+	return (I_Temp & 0x80) ? -value : value;
+}
+
+int16_t DHT22Humidity()        /* relative humidity in tenths of a percent */
+{
+	return ((uint16_t)I_RH << 8) | D_RH;
+}
+
+#if WALL_DISPLAY == TRUE
+void WallDisplay(int16_t temperature, int16_t humidity)    /* "23.5" + degree C and "45" + % in big digits */
+{
+	humidity = (humidity + 5) / 10;    /* whole percent, only 2 big digits fit */
+	if (humidity > 99)
+		humidity = 99;
+
+	LCDGotoXY(1,1);
+	LCDWriteBigFixed(temperature,1);
+	LCDPrintExtraChar(LCD_SPECIAL_SYMBOL_DEGREE);
+	LCDGotoXY(cursorPosition - 1,2);
+	LCDData('C');
+
+	LCDGotoXY(11,1);
+	LCDWriteBigFixed(humidity,0);
+	LCDData('%');
+}
+#endif
+
 int main(void)
 {
-	// Initialize the LCD
+	uint8_t tick;
+
+	// Initialize the LCD, the bytes are sent by the Timer2 interrupt
+	sei();
 	LCDSetup(LCD_CURSOR_NONE);
 	_delay_ms(2000);
 	while (1)
@@ -90,23 +145,41 @@ int main(void)
 		D_Temp=Receive_data();    /* store next eight bit in D_Temp */
 		CheckSum=Receive_data();/* store next eight bit in CheckSum */
 
-		if (((I_RH + D_RH + I_Temp + D_Temp) & 255) != CheckSum)
+		if (dhtTimeout)
+		{
+			//No answer from the sensor, the same help text
+			LCDWriteStringXY(1,1,"No sensor       ");
+			LCDScrollRegion(1,2,LCD_NR_OF_CHARACTERS,sensorHelp,LCD_SCROLL_SPEED);
+		}
+		else if (((I_RH + D_RH + I_Temp + D_Temp) & 255) != CheckSum)
 		{
-			//Checksum error
-			LCDHome();
-			LCDWriteString("Checksum error");
+			//Checksum error, the help text keeps scrolling from where it is
+			LCDWriteStringXY(1,1,"Checksum error  ");
+			LCDScrollRegion(1,2,LCD_NR_OF_CHARACTERS,sensorHelp,LCD_SCROLL_SPEED);
 		}
 		else // All good, display values
 		{
-			LCDHome();
-            T= (float) I_Temp * 256.0 + D_Temp ;
-            T=T/10.0;
-            LCDWriteFloat(T,0,2);			
+			LCDScrollStop(2);
+#if LCD_SHADOW == TRUE
+			LCDClear();				// Only the RAM copy, LCDFlush() sends what changed
+#else
+			LCDHome();				// A clear takes 1.6 ms and blanks the screen
+#endif
+#if WALL_DISPLAY == TRUE
+			WallDisplay(DHT22Temperature(),DHT22Humidity());
+#else
+			LCDWriteFixed(DHT22Temperature(),1);
 			LCDGotoXY(1,2);
-            RH= (float) I_RH * 256.0 + D_RH ;
-            RH=RH/10.0;			
-			LCDWriteFloat(RH,0,2);
+			LCDWriteFixed(DHT22Humidity(),1);
+#endif
+		}
+#if LCD_SHADOW == TRUE
+		LCDFlush();					// Send only what changed since the last reading
+#endif
+		for (tick = 0; tick < READ_PERIOD_MS / TICK_MS; tick++)
+		{
+			_delay_ms(TICK_MS);
+			LCDAnimate(TICK_MS);
 		}
-		_delay_ms(2000);
 	}
 }
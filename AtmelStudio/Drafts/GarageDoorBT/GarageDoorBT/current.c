@@ -0,0 +1,99 @@
+/*
+ * Motor current sensing, see current.h.
+ *
+ * Averages are exponential, kept with 4 fractional bits: avg16 += sample - avg16 / 2^shift
+ * (avg16 = average * 2^shift). Fast average ~8 ms, slow average ~64 ms at 1 kHz.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "settings.h"
+#include "scheduler.h"
+#include "fsm.h"
+#include "current.h"
+
+#define CURRENT_FAST_SHIFT	3
+#define CURRENT_SLOW_SHIFT	6
+
+/* Sample ring buffer. ADC_vect writes currentHead, currentMonitor() writes currentTail */
+volatile uint8_t currentBuffer[CURRENT_BUFFER_SIZE];
+volatile uint8_t currentHead = 0;
+volatile uint8_t currentTail = 0;
+volatile uint8_t currentOverflows = 0;
+
+uint16_t currentFast = 0;					//Fast average << CURRENT_FAST_SHIFT
+uint16_t currentSlow = 0;					//Slow average << CURRENT_SLOW_SHIFT
+uint8_t currentPeakCount = 0;				//Samples in a row above slow average + CURRENT_STEP
+uint16_t currentStartTime = 0;
+uint8_t currentActive = 0;					//0 => stopped or already reported
+
+/* Power the ADC up and start sampling on every tick. Call it when the motor starts. */
+void currentStart(void) {
+	PRR &= ~(1 << PRADC);
+	ADMUX = (1 << REFS0) | (1 << ADLAR) | MOTOR_CS_CHANNEL;		//AVcc reference, 8 bits in ADCH
+	ADCSRB = (1 << ADTS1) | (1 << ADTS0);						//Trigger: Timer0 compare match A
+	ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADIF) | (1 << ADPS2) | (1 << ADPS1);	//125 kHz ADC clock
+	currentTail = currentHead;
+	currentFast = 0;
+	currentSlow = 0;
+	currentPeakCount = 0;
+	currentStartTime = schedulerMillis();
+	currentActive = 1;
+}
+
+/* Stop sampling and power the ADC down */
+void currentStop(void) {
+	currentActive = 0;
+	ADCSRA = 0;
+	PRR |= (1 << PRADC);
+}
+
+/*
+ * Run by the scheduler every 1 ms. Takes the new samples, updates the averages
+ * and raises EV_OBSTRUCTION once per start when the motor stalls or hits something.
+ */
+void currentMonitor(void) {
+	uint8_t tail, sample, slow;
+
+	while ((tail = currentTail) != currentHead) {
+		sample = currentBuffer[tail];
+		currentTail = (tail + 1) & (CURRENT_BUFFER_SIZE - 1);
+
+		if (!currentActive) {
+			continue;
+		}
+		currentFast += sample - (currentFast >> CURRENT_FAST_SHIFT);
+		if (currentPeakCount == 0) {
+			currentSlow += sample - (currentSlow >> CURRENT_SLOW_SHIFT);	//Frozen during a jump, it's the reference
+		}
+		if ((uint16_t)(schedulerMillis() - currentStartTime) < CURRENT_BLANK_TIME) {
+			continue;							//Inrush, averages settle meanwhile
+		}
+
+		slow = currentSlow >> CURRENT_SLOW_SHIFT;
+		if ((slow < (255 - CURRENT_STEP)) && (sample > slow + CURRENT_STEP)) {
+			currentPeakCount++;
+		} else {
+			currentPeakCount = 0;
+		}
+
+		if (((currentFast >> CURRENT_FAST_SHIFT) > CURRENT_LIMIT) || (currentPeakCount >= CURRENT_PEAK_SAMPLES)) {
+			currentActive = 0;
+			fsmRaise(EV_OBSTRUCTION);
+		}
+	}
+}
+
+/* Conversion done (auto-triggered by the tick), store the 8-bit result */
+ISR(ADC_vect)
+{
+	uint8_t head = currentHead;
+	uint8_t next = (head + 1) & (CURRENT_BUFFER_SIZE - 1);
+
+	if (next != currentTail) {
+		currentBuffer[head] = ADCH;
+		currentHead = next;
+	} else {
+		currentOverflows++;
+	}
+}
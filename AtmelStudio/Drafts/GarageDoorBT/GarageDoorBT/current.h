@@ -0,0 +1,29 @@
+#ifndef current_H
+#define current_H
+
+/*
+ * Motor current sensing and stall/obstruction detection
+ *
+ * Author      : rludvik
+ * Description : VNH2SP30 CS output on ADC channel MOTOR_CS_CHANNEL.
+ *               The ADC is auto-triggered by Timer0 compare match A (the 1 ms tick), so it
+ *               samples at 1 kHz without any code, ADC_vect only puts the result (8 bits)
+ *               into a ring buffer. currentMonitor() (task, every 1 ms) keeps a fast and a slow
+ *               running average and raises EV_OBSTRUCTION when:
+ *               - stall: the fast average is above CURRENT_LIMIT, or
+ *               - obstruction: the current jumps CURRENT_STEP above the slow average and stays
+ *                 there for CURRENT_PEAK_SAMPLES samples.
+ *               The first CURRENT_BLANK_TIME ms after the start are ignored (inrush current).
+ *               The ADC is on only while the motor runs (currentStart()/currentStop()).
+ */
+
+#include <avr/io.h>
+
+#define CURRENT_BUFFER_SIZE		16		//ADC samples, must be a power of 2
+
+//functions
+extern void currentStart(void);
+extern void currentStop(void);
+extern void currentMonitor(void);
+
+#endif      //current_H
@@ -0,0 +1,73 @@
+#ifndef debounce_H
+#define debounce_H
+
+/*
+ * Vertical counter debouncer for all 8 pins of a port at once
+ *
+ * Author      : rludvik
+ * Description : Every bit has its own 2-bit counter, kept "vertically" in two bytes
+ *               (bit n of debounceCnt0 and debounceCnt1 is the counter of pin n).
+ *               A pin changes its debounced state only after DEBOUNCE_SAMPLES samples
+ *               in a row differ from it. One sample of all pins is a few XOR/AND operations,
+ *               no loop and no counter per button.
+ *               Debounce time is DEBOUNCE_SAMPLES x the period debounceSample() is called with.
+ *               debounceEvents() turns the edges into timestamped events (press, release,
+ *               long press, double press) in a lock-free queue: one producer and one consumer
+ *               (two tasks, or the timer ISR and a task), so nothing is lost and every
+ *               event is taken once.
+ *
+ * HOW TO USE:
+ *		schedulerAddTask(debounceButtons, 0, BOUNCETIME / DEBOUNCE_SAMPLES);
+ *
+ *		void debounceButtons() {
+ *			debounceSample(~INPUT_PIN);				//Buttons pull the pin low => 1 = pressed
+ *			if (debounceTakePressed(1 << OPEN_BTN_PIN)) {
+ *				...									//Once per press
+ *			}
+ *		}
+ *
+ *	or with the event queue:
+ *		void debounceButtons() {					//Every BOUNCETIME / DEBOUNCE_SAMPLES ms
+ *			debounceSample(~INPUT_PIN);
+ *			debounceEvents(BUTTONS_MASK, schedulerTicks);
+ *		}
+ *		while (debounceGetEvent(&event)) {			//In another task
+ *			if ((event.type == DEBOUNCE_PRESS) && (event.pin == OPEN_BTN_PIN)) ...
+ *		}
+ */
+
+#include <avr/io.h>
+
+#define DEBOUNCE_SAMPLES	4		//Same samples in a row to accept a change (2-bit counter)
+#define DEBOUNCE_QUEUE_SIZE	8		//Event queue, must be a power of 2
+#define DEBOUNCE_LONG_PRESS	1000	//ms held down => DEBOUNCE_LONG
+#define DEBOUNCE_DOUBLE_PRESS	400		//ms between two presses => DEBOUNCE_DOUBLE
+
+/* Event types */
+#define DEBOUNCE_PRESS		1
+#define DEBOUNCE_RELEASE	2
+#define DEBOUNCE_LONG		3		//Still held DEBOUNCE_LONG_PRESS ms after the press, once per press
+#define DEBOUNCE_DOUBLE		4		//Second press soon after the first one (comes after its DEBOUNCE_PRESS)
+
+/* One event from the queue */
+typedef struct
+{
+	uint8_t type;
+	uint8_t pin;					//Bit number in the sampled port
+	uint16_t time;					//Tick (ms) when it was detected
+} DEBOUNCE_EVENT_t;
+
+/* Bit per pin: debounced state (1 = pressed) and edges collected since they were taken */
+extern volatile uint8_t debounceState;
+extern volatile uint8_t debouncePress;
+extern volatile uint8_t debounceRelease;
+
+//functions
+extern void debounceSample(uint8_t sample);
+extern uint8_t debounceTakePressed(uint8_t mask);
+extern uint8_t debounceTakeReleased(uint8_t mask);
+extern void debounceEvents(uint8_t mask, uint16_t now);
+extern uint8_t debounceGetEvent(DEBOUNCE_EVENT_t *event);
+extern uint8_t debounceIdle(void);
+
+#endif      //debounce_H
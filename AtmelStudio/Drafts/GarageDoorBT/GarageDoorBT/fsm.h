@@ -0,0 +1,53 @@
+#ifndef fsm_H
+#define fsm_H
+
+/*
+ * Table-driven state machine with an event queue
+ *
+ * Author      : rludvik
+ * Description : Buttons, switches, timeouts and remote commands raise events (fsmRaise()),
+ *               fsmDispatch() takes them from the queue and looks the next state up in
+ *               fsmTransitions[state][event] - one table read per event, no polling.
+ *               When the state changes, the exit action of the old state and the entry
+ *               action of the new state are called (fsmStates[]).
+ *               Both tables are in flash and are defined in main.c.
+ *               fsmRaise() can be called from ISRs and tasks, fsmDispatch() only from a task.
+ *
+ * HOW TO USE:
+ *		fsmStart(STARTING);							//Entry action of the first state
+ *		schedulerAddTask(fsmDispatch, 0, 1);		//Every 1 ms
+ *		...
+ *		fsmRaise(EV_OPEN_BTN);						//From the debouncer, RF receiver, ...
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "settings.h"
+
+#define FSM_QUEUE_SIZE		8		//Event queue, must be a power of 2
+#define FSM_NO_TRANSITION	0		//Empty cell in fsmTransitions[], state 0 is not used
+
+/* Entry or exit action, 0 => nothing to do */
+typedef void (*FSM_ACTION_t)(void);
+
+/* Actions of one state */
+typedef struct
+{
+	FSM_ACTION_t entry;
+	FSM_ACTION_t exit;
+} FSM_STATE_t;
+
+/* Tables, defined in main.c */
+extern const uint8_t fsmTransitions[STATE_COUNT][EVENT_COUNT] PROGMEM;
+extern const FSM_STATE_t fsmStates[STATE_COUNT] PROGMEM;
+
+/* Current state, changed only by fsmStart() and fsmDispatch() */
+extern uint8_t fsmState;
+
+//functions
+extern void fsmStart(uint8_t initial);
+extern uint8_t fsmRaise(uint8_t event);
+extern void fsmDispatch(void);
+extern uint8_t fsmIdle(void);
+
+#endif      //fsm_H
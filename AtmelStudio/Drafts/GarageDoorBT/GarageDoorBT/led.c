@@ -0,0 +1,141 @@
+/*
+ * LED pattern engine, see led.h.
+ *
+ * Every channel keeps the tick of its next change (due), like the scheduler, so a late
+ * ledTask() doesn't stretch the pattern and LEDs started together change together.
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "settings.h"
+#include "scheduler.h"
+#include "fsm.h"
+#include "led.h"
+
+#define LED_CHANNELS	8				//One per bit of OUTPUT_PORT
+
+/* One LED */
+typedef struct
+{
+	const LED_PATTERN_t *pattern;
+	uint16_t due;						//Tick of the next change
+	uint8_t on;							//1 => in the on part of the cycle
+	uint8_t count;						//Cycles left, 0 => forever
+	uint8_t event;						//Raised when the pattern is done, EV_NONE => nothing
+} LED_CHANNEL_t;
+
+LED_CHANNEL_t ledChannels[LED_CHANNELS];
+uint8_t ledRunning = 0;					//LEDs with a pattern running
+uint8_t ledSteady = 0;					//LEDs on when no pattern runs, set by ledOn()/ledOff() and the end of a pattern
+
+/*
+ * LEDs on/off. motorBrake() writes the motor pins on the same port from the tick ISR,
+ * so the read-modify-write is done with interrupts off, it could undo the brake otherwise.
+ */
+static void ledSet(uint8_t mask) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		OUTPUT_PORT |= mask;
+	}
+}
+
+static void ledClear(uint8_t mask) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		OUTPUT_PORT &= ~mask;
+	}
+}
+
+/*
+ * Start the pattern on the LEDs in mask, right away with the on part.
+ * event is raised once when it's done (not for a pattern without end).
+ * A running pattern on the same LED is replaced.
+ */
+void ledPlay(uint8_t mask, const LED_PATTERN_t *pattern, uint8_t event) {
+	uint8_t i;
+	uint16_t due = schedulerMillis() + pgm_read_word(&pattern->on);
+
+	for (i = 0; i < LED_CHANNELS; i++) {
+		if (mask & (1 << i)) {
+			ledChannels[i].pattern = pattern;
+			ledChannels[i].due = due;
+			ledChannels[i].on = 1;
+			ledChannels[i].count = pgm_read_byte(&pattern->repeat);
+			ledChannels[i].event = event;
+			event = EV_NONE;			//Only the first LED raises it
+		}
+	}
+	ledSet(mask);
+	ledRunning |= mask;
+}
+
+/* Steady on, stops a running pattern */
+void ledOn(uint8_t mask) {
+	ledRunning &= ~mask;
+	ledSteady |= mask;
+	ledSet(mask);
+}
+
+/* Off, stops a running pattern */
+void ledOff(uint8_t mask) {
+	ledRunning &= ~mask;
+	ledSteady &= ~mask;
+	ledClear(mask);
+}
+
+/* 1 => no pattern is running (for powerCanSleep(), the tick stops in sleep) */
+uint8_t ledIdle(void) {
+	return ledRunning == 0;
+}
+
+/* Run by the scheduler every 1 ms */
+void ledTask(void) {
+	uint8_t i, mask, last;
+	uint16_t now;
+	LED_CHANNEL_t *channel;
+
+	if (ledRunning == 0) {
+		return;
+	}
+	now = schedulerMillis();
+	for (i = 0; i < LED_CHANNELS; i++) {
+		mask = (1 << i);
+		channel = &ledChannels[i];
+		if (!(ledRunning & mask) || ((int16_t)(now - channel->due) < 0)) {
+			continue;
+		}
+
+		if (channel->on) {
+			channel->on = 0;
+			channel->due += pgm_read_word(&channel->pattern->off);
+			ledClear(mask);
+			if ((int16_t)(now - channel->due) < 0) {
+				continue;
+			}
+		}
+
+		/* End of a cycle */
+		if ((channel->count != 0) && (--channel->count == 0)) {
+			ledRunning &= ~mask;
+			last = pgm_read_byte(&channel->pattern->last);
+			if (last == LED_LAST_RESTORE) {
+				last = (ledSteady & mask) ? LED_LAST_ON : LED_LAST_OFF;
+			} else if (last == LED_LAST_ON) {
+				ledSteady |= mask;
+			} else {
+				ledSteady &= ~mask;
+			}
+			if (last == LED_LAST_ON) {
+				ledSet(mask);
+			}
+			if (channel->event != EV_NONE) {
+				fsmRaise(channel->event);
+			}
+			continue;
+		}
+		channel->on = 1;
+		channel->due += pgm_read_word(&channel->pattern->on);
+		ledSet(mask);
+	}
+}
@@ -0,0 +1,44 @@
+#ifndef led_H
+#define led_H
+
+/*
+ * LED pattern engine
+ *
+ * Author      : rludvik
+ * Description : Every LED on OUTPUT_PORT has its own channel. A pattern (in flash) is on ms on,
+ *               off ms off, repeated repeat times (0 => until stopped), then the LED is left
+ *               on or off (last). ledPlay() only starts it, ledTask() (every 1 ms) does the rest,
+ *               so nothing waits and the buttons and the UART are always served.
+ *               The same pattern can run on several LEDs at once, they stay in step.
+ *
+ * HOW TO USE:
+ *		const LED_PATTERN_t ledConfirm PROGMEM = {250, 250, 1, 0};	//One 250 ms blink
+ *		schedulerAddTask(ledTask, 0, 1);
+ *		ledPlay((1 << OPEN_LED_PIN), &ledConfirm, EV_DONE);			//EV_DONE after the blink
+ *		ledOn((1 << CLOSE_LED_PIN));								//Steady, stops a pattern
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+/* Pattern, kept in flash */
+typedef struct
+{
+	uint16_t on;				//ms on, at least 1
+	uint16_t off;				//ms off, 0 => on again right away
+	uint8_t repeat;				//Number of on/off cycles, 0 => until ledOn()/ledOff()/ledPlay()
+	uint8_t last;				//LED when the pattern is done, LED_LAST_...
+} LED_PATTERN_t;
+
+#define LED_LAST_OFF		0
+#define LED_LAST_ON			1
+#define LED_LAST_RESTORE	2		//As set by the last ledOn()/ledOff(), for a blink over the LED of a state
+
+//functions
+extern void ledPlay(uint8_t mask, const LED_PATTERN_t *pattern, uint8_t event);
+extern void ledOn(uint8_t mask);
+extern void ledOff(uint8_t mask);
+extern uint8_t ledIdle(void);
+extern void ledTask(void);
+
+#endif      //led_H
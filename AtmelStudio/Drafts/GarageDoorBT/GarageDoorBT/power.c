@@ -0,0 +1,71 @@
+/*
+ * Power manager, see power.h for how to use it.
+ *
+ * ATmega328P: PB0..PB7 are PCINT0..PCINT7 (PCIE0), PD0/RXD is PCINT16 (PCIE2).
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "settings.h"
+#include "scheduler.h"
+#include "power.h"
+
+extern void debounceTimerStart();
+
+uint16_t powerLastActivity = 0;				//Tick of the last activity
+uint16_t powerSleeps = 0;					//How many times it went to sleep, for debugging
+
+/* Something happened (button, command, ...), start counting POWER_IDLE_TIME again */
+void powerActivity(void) {
+	powerLastActivity = schedulerMillis();
+}
+
+/* Stop the tick, arm the pin change interrupts and sleep until a pin changes */
+static void powerDown(void) {
+	TIMSK0 &= ~(1 << OCIE0A);				//Stop the 1 ms tick
+	TCCR0B = 0;
+
+	PCMSK0 = POWER_WAKE_MASK;
+	PCICR = (1 << PCIE0);
+#if POWER_WAKE_ON_UART
+	PCMSK2 = (1 << PCINT16);				//RXD, start bit of the next byte
+	PCICR |= (1 << PCIE2);
+#endif
+	PCIFR = (1 << PCIF0) | (1 << PCIF2);	//Old changes must not wake it up right away
+
+	set_sleep_mode(POWER_SLEEP_MODE);
+	cli();
+	sleep_enable();
+	sei();									//sei + sleep are executed together, the change can't slip in between
+	sleep_cpu();
+	sleep_disable();
+
+	PCICR = 0;								//Awake, only the debouncer looks at the pins now
+	PCMSK0 = 0;
+	PCMSK2 = 0;
+	debounceTimerStart();					//Tick again, the scheduler continues
+	powerSleeps++;
+}
+
+/*
+ * Run by the scheduler every POWER_CHECK_PERIOD ms.
+ * Sleeps when powerCanSleep() has said yes for POWER_IDLE_TIME ms without any powerActivity().
+ */
+void powerTask(void) {
+	if (!powerCanSleep()) {
+		powerActivity();
+		return;
+	}
+	if ((uint16_t)(schedulerMillis() - powerLastActivity) < POWER_IDLE_TIME) {
+		return;
+	}
+	powerDown();
+	powerActivity();						//Give the wake-up pin time to be debounced and handled
+}
+
+/* Only to wake up, the pins are read by the debouncer (and the UART) */
+EMPTY_INTERRUPT(PCINT0_vect);
+#if POWER_WAKE_ON_UART
+EMPTY_INTERRUPT(PCINT2_vect);
+#endif
@@ -0,0 +1,37 @@
+#ifndef power_H
+#define power_H
+
+/*
+ * Power manager - power-down sleep with pin change wake-up
+ *
+ * Author      : rludvik
+ * Description : When nothing has happened for POWER_IDLE_TIME ms and main.c says there is
+ *               nothing to do (powerCanSleep()), the 1 ms tick (Timer0) is stopped, pin change
+ *               interrupts are armed on the inputs (POWER_WAKE_MASK on PINB) and optionally on
+ *               the UART RX line (PD0), and the uC goes to POWER_SLEEP_MODE.
+ *               Any change on those pins wakes it up, the tick is started again and the
+ *               scheduler continues where it stopped (time doesn't advance while sleeping).
+ *               The press that woke it up is then debounced and handled as usual.
+ *
+ * Wake-up latency: start-up time of the clock (SUT fuses, 65 ms with the default fuses of the
+ * internal 8 MHz RC, 4.1 ms or 6 CK with SUT=01/00) + BOUNCETIME for the debouncer.
+ * RF/BT: the UART is stopped in power-down, the byte whose start bit woke the uC is lost.
+ * The TX repeats every command (TX_REPEAT_COUNT), so a repeat is received - use the short
+ * start-up (SUT) fuses, with 65 ms all three repeats can be lost.
+ *
+ * HOW TO USE:
+ *		uint8_t powerCanSleep(void) { ... }			//In main.c, 1 => nothing is running
+ *		schedulerAddTask(powerTask, 0, POWER_CHECK_PERIOD);
+ *		powerActivity();							//On every button, command, ... => stay awake
+ */
+
+#include <avr/io.h>
+
+#define POWER_CHECK_PERIOD	100		//ms between two checks of powerTask()
+
+//functions
+extern uint8_t powerCanSleep(void);	//In main.c
+extern void powerActivity(void);
+extern void powerTask(void);
+
+#endif      //power_H
@@ -8,10 +8,48 @@
 #include "settings.h"
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <util/delay.h>
+#include <string.h>
+#include "scheduler.h"
+#include "fsm.h"
+#include "power.h"
+#include "position.h"
+#include "led.h"
 
-extern volatile char state;					//Needed to update the state machine in main.c
-extern void turnOffLEDs();
+/* Receive ring buffer. Single producer (USART_RX_vect writes btHead) and single consumer
+ * (btParse() writes btTail), so no locking is needed. One slot is always left empty
+ * to tell a full buffer from an empty one.
+ */
+volatile uint8_t btBuffer[BT_BUFFER_SIZE];
+volatile uint8_t btHead = 0;				//Next free slot, written only by the ISR
+volatile uint8_t btTail = 0;				//Next byte to read, written only by the parser
+volatile uint8_t btOverflows = 0;			//Bytes dropped because the buffer was full
+
+char btCommand[BT_CMD_MAX_LEN + 1];			//Command being received, 0 terminated
+uint8_t btCommandLength = 0;
+uint16_t btLastByte = 0;					//Tick of the last byte, ends a command without CR/LF
+
+const LED_PATTERN_t btLedCommand PROGMEM = {BT_LED_BLINK, BT_LED_BLINK, 1, LED_LAST_RESTORE};	//One blink for a received command, then the LED of the state again
+
+/* Commands from the BT terminal app. Single letters are the buttons of the app,
+ * words can be typed in a terminal.
+ */
+typedef struct
+{
+	const char *text;
+	uint8_t event;
+	uint16_t target;						//Position for EV_REMOTE_OPEN (partial opening)
+} BT_COMMAND_t;
+
+const BT_COMMAND_t btCommands[] = {
+	{"a", EV_REMOTE_LOCK, 0},
+	{"o", EV_REMOTE_OPEN, POSITION_FULL},
+	{"c", EV_REMOTE_CLOSE, 0},
+	{"h", EV_REMOTE_OPEN, POSITION_HALF},
+	{"lock", EV_REMOTE_LOCK, 0},
+	{"open", EV_REMOTE_OPEN, POSITION_FULL},
+	{"close", EV_REMOTE_CLOSE, 0},
+	{"half", EV_REMOTE_OPEN, POSITION_HALF},
+};
 
 void USART_Init(void) {
 	//Setting the baud rate is done by writing to the UBRR0H and UBRR0L registers
@@ -24,10 +62,66 @@ void USART_Init(void) {
 	UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
 }
 
-//Read the value out of the UART buffer
-uint8_t USART_vReceiveByte(void) {
-		while((UCSR0A & (1 << RXC0)) == 0);	//Wait until a byte has been received
-		return UDR0;
+//Take the next byte out of the ring buffer. Returns 0 if the buffer is empty.
+uint8_t btBufferGet(uint8_t *data) {
+	uint8_t tail = btTail;
+
+	if (tail == btHead) {
+		return 0;
+	}
+	*data = btBuffer[tail];
+	btTail = (tail + 1) & (BT_BUFFER_SIZE - 1);	//Free the slot only after the byte was read
+	return 1;
+}
+
+//Look the received command up and pass it to the state machine. Unknown commands are ignored.
+void btDispatch(void) {
+	uint8_t i;
+
+	btCommand[btCommandLength] = 0;
+	for (i = 0; i < sizeof(btCommands) / sizeof(btCommands[0]); i++) {
+		if (strcmp(btCommand, btCommands[i].text) == 0) {
+			ledPlay((1 << POWER_LED_PIN), &btLedCommand, EV_NONE);	//Still on from the last command => starts over
+			powerActivity();
+			if (btCommands[i].event == EV_REMOTE_OPEN) {
+				positionSetTarget(btCommands[i].target);
+			}
+			fsmRaise(btCommands[i].event);
+			break;
+		}
+	}
+	btCommandLength = 0;
+}
+
+/*
+ * Command parser, run by the scheduler every 1 ms (main loop, not ISR).
+ * A command ends with CR or LF, or when no byte came for BT_CMD_TIMEOUT ms
+ * (the app buttons send a single letter without line end).
+ * Too long commands are thrown away up to the next line end.
+ */
+void btParse(void) {
+	uint8_t data;
+	uint16_t now = schedulerMillis();
+
+	if ((btCommandLength > 0) && ((uint16_t)(now - btLastByte) > BT_CMD_TIMEOUT)) {
+		btDispatch();
+	}
+
+	while (btBufferGet(&data)) {
+		btLastByte = now;
+		if ((data == '\r') || (data == '\n')) {
+			if (btCommandLength > 0) {
+				btDispatch();
+			}
+		}
+		else if (btCommandLength < BT_CMD_MAX_LEN) {
+			btCommand[btCommandLength++] = data;
+		}
+		else {
+			btCommand[0] = 0;					//Too long, make sure it doesn't match anything
+			btCommandLength = BT_CMD_MAX_LEN;
+		}
+	}
 }
 
 /////* Send data to remote */
@@ -49,29 +143,23 @@ uint8_t USART_vReceiveByte(void) {
 	//}
 //}
 
-/* USART Receiver interrupt service routine 
- * Read command from the BT device and change the state accordingly
- * "a" = Alarm
- * "o" = Open
- * "c" = Close
- */
-ISR(USART_RX_vect)
-{
-	uint8_t data;
-	data = USART_vReceiveByte();
-	OUTPUT_PORT |= (1 << POWER_LED_PIN);
-	_delay_ms(200);
-	OUTPUT_PORT &= ~(1 << POWER_LED_PIN);
-	_delay_ms(200);
-	if (data == 'a') {
-		state = PRE_LOCKED;
+/* USART Receiver interrupt service routine 
+ * Only stores the byte from the BT device, btParse() reads the commands and passes them to the state machine:
+ * "a" or "lock" = Alarm
+ * "o" or "open" = Open
+ * "h" or "half" = Open to POSITION_HALF
+ * "c" or "close" = Close
+ */
+ISR(USART_RX_vect)
+{
+	uint8_t data = UDR0;					//Read it in any case, this clears the interrupt
+	uint8_t head = btHead;
+	uint8_t next = (head + 1) & (BT_BUFFER_SIZE - 1);
+
+	if (next != btTail) {
+		btBuffer[head] = data;
+		btHead = next;						//Publish only after the byte is stored
+	} else {
+		btOverflows++;						//Buffer full, byte is lost
 	}
-	else if (data =='o') {
-		state = PRE_OPENING;
-	}
-	else if (data == 'c') {
-		state = PRE_CLOSING;
-	}
-	else {
-	}
 }
@@ -0,0 +1,50 @@
+#ifndef scheduler_H
+#define scheduler_H
+
+/*
+ * Cooperative task scheduler with 1 ms system tick
+ *
+ * Author      : rludvik
+ * Description : Tasks are plain void functions, registered as periodic or one-shot.
+ *               The timer ISR only counts ticks, schedulerRun() in the main loop runs the
+ *               tasks that are due, one after another. When nothing is due the uC sleeps
+ *               in idle mode until the next interrupt (tick, UART, ...).
+ *               Tasks must return quickly, the next task runs only after the previous one returns.
+ *
+ * HOW TO USE:
+ *		debounceTimerStart();						//1 ms tick on Timer0 compare match A
+ *		schedulerAddTask(debounceButtons, 0, 1);	//every 1 ms, starting now
+ *		schedulerAddTask(blinkOnce, 500, 0);		//once, 500 ms from now
+ *		sei();
+ *		while(1) {
+ *			schedulerRun();
+ *		}
+ *
+ *		ISR(TIMER0_COMPA_vect)
+ *		{
+ *			schedulerTick();
+ *		}
+ */
+
+#include <avr/io.h>
+
+#define SCHEDULER_MAX_TASKS		10		//Size of the task table, 6 bytes of RAM per task. The garage door uses 8 periodic
+										//tasks + the motor timeout, keep the rest free
+#define SCHEDULER_NO_TASK		-1		//Returned by schedulerAddTask() when the table is full
+
+/* Task is a function without arguments and return value */
+typedef void (*SCHEDULER_TASK_t)(void);
+
+/* Ticks (ms) since start. Written only by schedulerTick() in the timer ISR, wraps after ~65 s */
+extern volatile uint16_t schedulerTicks;
+
+/* Count one tick. It's a macro, so the timer ISR doesn't have to save registers for a function call */
+#define schedulerTick()			(schedulerTicks++)
+
+//functions
+extern int8_t schedulerAddTask(SCHEDULER_TASK_t task, uint16_t delay, uint16_t period);
+extern void schedulerRemoveTask(int8_t taskId);
+extern uint16_t schedulerMillis(void);
+extern void schedulerRun(void);
+
+#endif      //scheduler_H
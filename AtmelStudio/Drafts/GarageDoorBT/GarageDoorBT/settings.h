@@ -30,6 +30,27 @@
 #define MOTOR_IN2_PIN		PC4		//To motor's IN2
 //#define RELAY_PIN			PC5		//Relay to power up the ATX
 
+/* Motor speed, VNH2SP30 PWM input on Timer2, see motor.c */
+#define MOTOR_PWM_PIN		PD3		//OC2B
+#define MOTOR_MAX_SPEED		255		//PWM duty (0-255) at full speed
+#define MOTOR_SLOW_SPEED	80		//PWM duty in the slow approach zone
+#define MOTOR_ACCEL_STEP	8		//Duty up per MOTOR_RAMP_PERIOD => ~320 ms from 0 to full speed
+#define MOTOR_DECEL_STEP	16		//Duty down per MOTOR_RAMP_PERIOD => ~160 ms from full speed to 0
+#define MOTOR_RAMP_PERIOD	10		//ms
+
+/* Door position estimate, see position.c. 0 = closed */
+#define POSITION_FULL		1000	//Position when open
+#define POSITION_HALF		500		//Partial opening
+#define POSITION_SLOW_ZONE	150		//Slow approach this far before the end switch or the target
+#define POSITION_PERIOD		10		//ms between two checks
+
+/* Motor current, VNH2SP30 CS pin, see current.c. ADC values are 8 bits, ~6.7 per A with the 1k5 CS resistor */
+#define MOTOR_CS_CHANNEL	6		//ADC6 (TQFP/QFN package only, PORTC pins are all used)
+#define CURRENT_LIMIT		60		//Average above this => stall (~9 A)
+#define CURRENT_STEP		20		//Jump above the slow average => obstruction (~3 A)
+#define CURRENT_PEAK_SAMPLES	15		//ms the jump has to last
+#define CURRENT_BLANK_TIME	300		//ms after the start not checked (inrush, ramp up)
+
 /* States definition. Define all states of the machine */
 #define CLOSED		1
 #define CLOSING		2
@@ -44,13 +65,44 @@
 #define PRE_IDLE	12
 #define PRE_OPENING	13
 #define PRE_CLOSING	14
-#define PRE_LOCKED	15
+#define PARTLY_OPEN	15		//Stopped at the target of a partial opening
+
+/* Events for the state machine, see fsmTransitions[] in main.c */
+#define EV_NONE				0		//Nothing, e.g. a blink that doesn't end a state
+#define EV_OPEN_BTN			1		//Open button pressed (debounced)
+#define EV_CLOSE_BTN		2		//Close button pressed
+#define EV_OPEN_SWITCH		3		//Door hit the open end switch
+#define EV_CLOSE_SWITCH		4		//Door hit the closed end switch
+#define EV_EMERGENCY_BTN	5		//Emergency button pressed
+#define EV_TIMEOUT			6		//Motor ran too long without hitting the end switch
+#define EV_DONE				7		//LED sequence of a PRE_ state (or STARTING) finished
+#define EV_REMOTE_OPEN		8		//Remote commands
+#define EV_REMOTE_CLOSE		9
+#define EV_REMOTE_LOCK		10
+#define EV_OBSTRUCTION		11		//Motor current too high (stall) or jumped up (door hit something)
+#define EV_TARGET_REACHED	12		//Partial opening got to its target position
+#define EVENT_COUNT			13		//Number of events, size of the transition table
+#define STATE_COUNT			16		//Highest state number + 1, size of the transition table
 
 /* Period for de-bounce in ms */
 #define BOUNCETIME	30
+/* All debounced inputs, their events go to the state machine */
+#define BUTTONS_MASK	((1 << OPEN_BTN_PIN) | (1 << CLOSE_BTN_PIN) | (1 << OPEN_SWITCH_PIN) | (1 << CLOSE_SWITCH_PIN) | (1 << EMERGENCY_BTN_PIN))
+
+/* Power management, see power.h */
+#define POWER_IDLE_TIME		5000				//ms without activity before it goes to sleep
+#define POWER_SLEEP_MODE	SLEEP_MODE_PWR_DOWN	//Or SLEEP_MODE_IDLE to keep the UART running
+#define POWER_WAKE_MASK		BUTTONS_MASK		//Pins on PINB that wake it up
+#define POWER_WAKE_ON_UART	1					//1 => RX line (BT module) wakes it up too
 
 #define BAUDRATE	9600
 //#define UBRRVAL ((F_CPU/(BAUDRATE*16))-1)	//calculate UBRR value
 #define UBRRVAL		51
 
+/* Bluetooth commands */
+#define BT_BUFFER_SIZE	16		//Receive ring buffer, must be a power of 2
+#define BT_CMD_MAX_LEN	8		//Longest command
+#define BT_CMD_TIMEOUT	20		//ms without a byte ends a command (~1 ms per byte at 9600 baud)
+#define BT_LED_BLINK	200		//ms on and ms off for a received command, the off part shows on a lit LED
+
 #endif
\ No newline at end of file
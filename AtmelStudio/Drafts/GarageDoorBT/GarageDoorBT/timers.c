@@ -32,10 +32,14 @@
  *
  * So with 256 pre-scaler_
  * OCR0A = 15 => we get 1 ms square wave time period
+ *
+ * That's the square wave period (two compare matches). The interrupt itself fires every
+ * (OCR0A+1)*N/Fclk = 16*256/8000000 = 0.512 ms. The scheduler needs a real 1 ms tick:
+ * OCR0A = 124 with 64 pre-scaler => 125*64/8000000 = 1 ms between interrupts.
  */
 void debounceTimerStart() {
-	OCR0A = 15;
+	OCR0A = 124;
 	TCCR0A |= (1 << WGM01); 			//Set CTC mode
-	TCCR0B = (1 << CS02);				//Set 256 prescaler
+	TCCR0B = (1 << CS01) | (1 << CS00);	//Set 64 prescaler
 	TIMSK0 = (1 << OCIE0A);				//Timer/Counter0 Output Compare Match A Interrupt Enable
 }
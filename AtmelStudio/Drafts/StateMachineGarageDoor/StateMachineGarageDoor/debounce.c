@@ -0,0 +1,133 @@
+/*
+ * Vertical counter debouncer, see debounce.h for how to use it.
+ *
+ * Counter of a pin is reset to 3 (both bits 1) whenever the sample equals the debounced state
+ * and counts down while it differs: 3, 2, 1, 0 => the 4th sample that differs toggles
+ * the debounced state. Based on the well known debouncer from Peter Dannegger.
+ */
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "debounce.h"
+
+volatile uint8_t debounceState = 0;
+volatile uint8_t debouncePress = 0;
+volatile uint8_t debounceRelease = 0;
+uint8_t debounceCnt0 = 0xFF;				//Low bits of the 8 counters
+uint8_t debounceCnt1 = 0xFF;				//High bits of the 8 counters
+
+/* Event queue. debounceEvents() writes debounceHead, debounceGetEvent() writes debounceTail */
+volatile DEBOUNCE_EVENT_t debounceQueue[DEBOUNCE_QUEUE_SIZE];
+volatile uint8_t debounceHead = 0;
+volatile uint8_t debounceTail = 0;
+volatile uint8_t debounceOverflows = 0;		//Events dropped because the queue was full
+
+uint16_t debouncePressTime[8];				//Tick of the last press of every pin
+uint8_t debounceLongDone = 0;				//Bit per pin, long press already reported for this press
+uint8_t debounceDoubleArmed = 0;			//Bit per pin, next press within DEBOUNCE_DOUBLE_PRESS is a double press
+
+/* Take one sample of all 8 pins (1 = pressed). Can be called from an ISR or a task. */
+void debounceSample(uint8_t sample) {
+	uint8_t changed = debounceState ^ sample;
+
+	debounceCnt0 = ~(debounceCnt0 & changed);					//Count down or reset to 3
+	debounceCnt1 = debounceCnt0 ^ (debounceCnt1 & changed);
+	changed &= debounceCnt0 & debounceCnt1;						//Counter rolled over => accept the change
+	debounceState ^= changed;
+	debouncePress |= debounceState & changed;
+	debounceRelease |= ~debounceState & changed;
+}
+
+/* Return the press edges of the pins in mask and clear them, so every press is taken once */
+uint8_t debounceTakePressed(uint8_t mask) {
+	uint8_t edges;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		edges = debouncePress & mask;
+		debouncePress ^= edges;
+	}
+	return edges;
+}
+
+/* Same for the release edges */
+uint8_t debounceTakeReleased(uint8_t mask) {
+	uint8_t edges;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		edges = debounceRelease & mask;
+		debounceRelease ^= edges;
+	}
+	return edges;
+}
+
+/* Put the event to the queue, drop it if the queue is full. Only debounceEvents() calls it. */
+static void debouncePut(uint8_t type, uint8_t pin, uint16_t now) {
+	uint8_t head = debounceHead;
+	uint8_t next = (head + 1) & (DEBOUNCE_QUEUE_SIZE - 1);
+
+	if (next == debounceTail) {
+		debounceOverflows++;
+		return;
+	}
+	debounceQueue[head].type = type;
+	debounceQueue[head].pin = pin;
+	debounceQueue[head].time = now;
+	debounceHead = next;					//Publish only after the event is stored
+}
+
+/*
+ * Turn the edges of the pins in mask into events, call it right after debounceSample().
+ * now is the current tick in ms. Producer side of the queue, call it from one place only
+ * (the timer ISR or one task). Pins that are idle cost nothing.
+ */
+void debounceEvents(uint8_t mask, uint16_t now) {
+	uint8_t pin, bit;
+	uint8_t press = debounceTakePressed(mask);
+	uint8_t release = debounceTakeReleased(mask);
+	uint8_t held = debounceState & mask & ~debounceLongDone;
+
+	if ((press | release | held) == 0) {
+		return;
+	}
+	for (pin = 0, bit = 1; bit != 0; pin++, bit <<= 1) {
+		if (press & bit) {
+			debouncePut(DEBOUNCE_PRESS, pin, now);
+			if ((debounceDoubleArmed & bit) && ((uint16_t)(now - debouncePressTime[pin]) <= DEBOUNCE_DOUBLE_PRESS)) {
+				debouncePut(DEBOUNCE_DOUBLE, pin, now);
+				debounceDoubleArmed &= ~bit;	//A third press starts a new pair
+			} else {
+				debounceDoubleArmed |= bit;
+			}
+			debouncePressTime[pin] = now;
+			debounceLongDone &= ~bit;
+		}
+		if (release & bit) {
+			debouncePut(DEBOUNCE_RELEASE, pin, now);
+		}
+		if ((held & bit) && ((uint16_t)(now - debouncePressTime[pin]) >= DEBOUNCE_LONG_PRESS)) {
+			debouncePut(DEBOUNCE_LONG, pin, now);
+			debounceLongDone |= bit;
+		}
+	}
+}
+
+/* 1 when no pin is in the middle of a change (all counters reset) and no event is waiting */
+uint8_t debounceIdle(void) {
+	return ((debounceCnt0 & debounceCnt1) == 0xFF) && (debounceTail == debounceHead);
+}
+
+/* Take the oldest event from the queue. Returns 0 if there is none. Consumer side, one task only. */
+uint8_t debounceGetEvent(DEBOUNCE_EVENT_t *event) {
+	uint8_t tail = debounceTail;
+
+	if (tail == debounceHead) {
+		return 0;
+	}
+	event->type = debounceQueue[tail].type;
+	event->pin = debounceQueue[tail].pin;
+	event->time = debounceQueue[tail].time;
+	debounceTail = (tail + 1) & (DEBOUNCE_QUEUE_SIZE - 1);	//Free the slot only after it was read
+	return 1;
+}
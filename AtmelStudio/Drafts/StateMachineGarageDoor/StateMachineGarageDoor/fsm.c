@@ -0,0 +1,83 @@
+/*
+ * Table-driven state machine, see fsm.h for how to use it.
+ *
+ * Events are kept in a ring buffer. Producers are ISRs and tasks, so fsmRaise()
+ * stores the event with interrupts off. fsmDispatch() is the only consumer.
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "fsm.h"
+
+uint8_t fsmState = 0;
+volatile uint8_t fsmQueue[FSM_QUEUE_SIZE];
+volatile uint8_t fsmHead = 0;				//Next free slot
+volatile uint8_t fsmTail = 0;				//Next event to dispatch
+volatile uint8_t fsmOverflows = 0;			//Events dropped because the queue was full
+
+/* Call the entry or exit action, if there is one */
+static void fsmAction(const FSM_ACTION_t *action) {
+	FSM_ACTION_t function = (FSM_ACTION_t)pgm_read_word(action);
+
+	if (function != 0) {
+		function();
+	}
+}
+
+/* Set the first state and run its entry action. Call it before the scheduler starts. */
+void fsmStart(uint8_t initial) {
+	fsmState = initial;
+	fsmAction(&fsmStates[initial].entry);
+}
+
+/*
+ * Put the event to the queue. Returns 0 (and the event is lost) if the queue is full.
+ * Safe to call from an ISR, a task and from the entry/exit actions.
+ */
+uint8_t fsmRaise(uint8_t event) {
+	uint8_t next, stored = 0;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		next = (fsmHead + 1) & (FSM_QUEUE_SIZE - 1);
+		if (next != fsmTail) {
+			fsmQueue[fsmHead] = event;
+			fsmHead = next;
+			stored = 1;
+		} else {
+			fsmOverflows++;
+		}
+	}
+	return stored;
+}
+
+/* 1 when no event is waiting */
+uint8_t fsmIdle(void) {
+	return (fsmTail == fsmHead);
+}
+
+/*
+ * Dispatch all queued events, run by the scheduler every 1 ms.
+ * An event without a transition in the current state is dropped.
+ * Events raised by the actions are dispatched in the same call, after the ones already queued.
+ */
+void fsmDispatch(void) {
+	uint8_t tail, event, next;
+
+	while ((tail = fsmTail) != fsmHead) {
+		event = fsmQueue[tail];
+		fsmTail = (tail + 1) & (FSM_QUEUE_SIZE - 1);
+
+		if (event >= EVENT_COUNT) {
+			continue;
+		}
+		next = pgm_read_byte(&fsmTransitions[fsmState][event]);
+		if (next == FSM_NO_TRANSITION) {
+			continue;
+		}
+		fsmAction(&fsmStates[fsmState].exit);
+		fsmState = next;
+		fsmAction(&fsmStates[next].entry);
+	}
+}
@@ -13,36 +13,243 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 //#include <stdbool.h>
-#include <util/delay.h>
-
+#include "scheduler.h"
+#include "fsm.h"
+#include "debounce.h"
+#include "power.h"
+#include "current.h"
+#include "position.h"
+#include "led.h"
 
 /* Variables list:
- * state: initial state of the state machine
- * cntXXX: counter for button de-bouncing, used in ISR
- * cntTimeout: counter for timeout, used in ISR
- * chkLimit: setting for ms for button de-bouncing
- * timeoutLimit: setting for ms for timeout
+ * timeoutLimit: setting for ms for timeout, used only for OPENING and CLOSING states
  */
-volatile char state = STARTING;
-volatile uint8_t cntOpenButton, cntCloseButton, cntOpenSwitch, cntCloseSwitch, cntEmergencyButton = 0;
-volatile uint16_t cntTimeout = 0;
-uint8_t chkLimit = 30;
 uint16_t timeoutLimit = 10000;
 
+int8_t timeoutTask = SCHEDULER_NO_TASK;		//Motor timeout, runs only in OPENING and CLOSING
+uint8_t lockedAlarm = 0;					//1 => LOCKED was entered because of the motor timeout
+
+/* LED patterns: on ms, off ms, cycles, LED on at the end */
+const LED_PATTERN_t ledStartup PROGMEM = {500, 500, 2, 0};
+const LED_PATTERN_t ledReady PROGMEM = {250, 250, 2, 0};
+const LED_PATTERN_t ledConfirm PROGMEM = {250, 250, 1, 0};
+const LED_PATTERN_t ledAlarm PROGMEM = {250, 250, 2, 1};
+
 /* Declarations */
 void debounceTimerStart();
+void debounceButtons();
+void buttonEvents();
 void USART_Init();
+void receiverParse();
+void motorInit();
 void motorOpen();
 void motorStop();
+void motorBrake();
 void motorClose();
+void motorRampTick();
 void lock_solenoid();
 void unlock_solenoid();
 
-/* Turn all the LEDs off */
-void turnOffLEDs() {
-	OUTPUT_PORT &= ~(1 << OPEN_LED_PIN);
-	OUTPUT_PORT &= ~(1 << CLOSE_LED_PIN);
-	OUTPUT_PORT &= ~(1 << LOCKED_LED_PIN);
+/* Turn all the LEDs off, also a running pattern */
+void turnOffLEDs() {
+	ledOff((1 << OPEN_LED_PIN) | (1 << CLOSE_LED_PIN) | (1 << LOCKED_LED_PIN));
+}
+
+/* Raise the event if the input is already pressed. Events come only on a press, so a state
+ * entered with a switch already hit has to look at it itself.
+ */
+void raiseIfPressed(uint8_t pin, uint8_t event) {
+	if (debounceState & (1 << pin)) {
+		fsmRaise(event);
+	}
+}
+
+/* Motor ran for timeoutLimit ms without hitting the end switch */
+void motorTimeout() {
+	timeoutTask = SCHEDULER_NO_TASK;
+	lockedAlarm = 1;
+	fsmRaise(EV_TIMEOUT);
+}
+
+/* Start the motor timeout. No free slot in the scheduler => the motor must not run without it,
+ * it's reported like a timeout (LOCKED with alarm) and 0 is returned.
+ */
+uint8_t timeoutStart() {
+	timeoutTask = schedulerAddTask(motorTimeout, timeoutLimit, 0);
+	if (timeoutTask == SCHEDULER_NO_TASK) {
+		motorTimeout();
+		return 0;
+	}
+	return 1;
+}
+
+/* ################ ENTRY AND EXIT ACTIONS ################ */
+void startingEnter() {
+	turnOffLEDs();
+	ledPlay((1 << OPEN_LED_PIN) | (1 << CLOSE_LED_PIN) | (1 << LOCKED_LED_PIN), &ledStartup, EV_DONE);
+}
+
+void lockedEnter() {
+	motorBrake();
+	turnOffLEDs();
+	if (lockedAlarm) {
+		lockedAlarm = 0;
+		ledPlay((1 << LOCKED_LED_PIN), &ledAlarm, EV_NONE);
+	} else {
+		ledOn((1 << LOCKED_LED_PIN));
+	}
+}
+
+void oneEnter() {
+	turnOffLEDs();
+	ledOn((1 << OPEN_LED_PIN));
+}
+
+void twoEnter() {
+	turnOffLEDs();
+	ledOn((1 << CLOSE_LED_PIN));
+}
+
+void threeEnter() {
+	turnOffLEDs();
+	ledOn((1 << LOCKED_LED_PIN));
+}
+
+void preIdleEnter() {
+	turnOffLEDs();
+	ledPlay((1 << OPEN_LED_PIN) | (1 << CLOSE_LED_PIN) | (1 << LOCKED_LED_PIN), &ledReady, EV_DONE);
+}
+
+void idleEnter() {
+	turnOffLEDs();
+	ledOn((1 << OPEN_LED_PIN) | (1 << LOCKED_LED_PIN));
+	raiseIfPressed(OPEN_SWITCH_PIN, EV_OPEN_SWITCH);
+	raiseIfPressed(CLOSE_SWITCH_PIN, EV_CLOSE_SWITCH);
+}
+
+void openEnter() {
+	motorBrake();							//End switch: stop now, no ramp into the end stop
+	positionAtOpen();
+	ledOn((1 << OPEN_LED_PIN));
+}
+
+void closedEnter() {
+	motorBrake();							//End switch: stop now, no ramp into the end stop
+	positionAtClosed();
+	ledOn((1 << CLOSE_LED_PIN));
+}
+
+void partlyOpenEnter() {
+	ledOn((1 << OPEN_LED_PIN) | (1 << CLOSE_LED_PIN));
+}
+
+void preOpeningEnter() {
+	turnOffLEDs();
+	ledPlay((1 << OPEN_LED_PIN), &ledConfirm, EV_DONE);
+}
+
+void openingEnter() {
+	raiseIfPressed(EMERGENCY_BTN_PIN, EV_EMERGENCY_BTN);	//Held through the blink => LOCKED next
+	if (!timeoutStart()) {
+		return;
+	}
+	positionStart(POSITION_OPENING);
+	motorOpen();
+	currentStart();
+	raiseIfPressed(OPEN_SWITCH_PIN, EV_OPEN_SWITCH);
+}
+
+void preClosingEnter() {
+	turnOffLEDs();
+	ledPlay((1 << CLOSE_LED_PIN), &ledConfirm, EV_DONE);
+}
+
+void closingEnter() {
+	raiseIfPressed(EMERGENCY_BTN_PIN, EV_EMERGENCY_BTN);	//Held through the blink => LOCKED next
+	if (!timeoutStart()) {
+		return;
+	}
+	positionStart(POSITION_CLOSING);
+	motorClose();
+	currentStart();
+	raiseIfPressed(CLOSE_SWITCH_PIN, EV_CLOSE_SWITCH);
+}
+
+/* Leaving OPENING or CLOSING, whatever the reason. Soft stop in mid-travel, OPEN, CLOSED and
+ * LOCKED brake right away: the slow approach zone is what softens the arrival at the end stop.
+ */
+void movingExit() {
+	motorStop();
+	positionStop();
+	currentStop();
+	schedulerRemoveTask(timeoutTask);
+	timeoutTask = SCHEDULER_NO_TASK;
+	turnOffLEDs();
+}
+
+/*
+ * ################ STATE MACHINE TABLES ################
+ * Entry and exit action of every state. Unused state numbers are left empty.
+ */
+const FSM_STATE_t fsmStates[STATE_COUNT] PROGMEM = {
+	[STARTING]		= {startingEnter, 0},
+	[LOCKED]		= {lockedEnter, 0},
+	[ONE]			= {oneEnter, 0},
+	[TWO]			= {twoEnter, 0},
+	[THREE]			= {threeEnter, 0},
+	[PRE_IDLE]		= {preIdleEnter, 0},
+	[IDLE]			= {idleEnter, 0},
+	[OPEN]			= {openEnter, 0},
+	[CLOSED]		= {closedEnter, 0},
+	[PARTLY_OPEN]	= {partlyOpenEnter, 0},
+	[PRE_OPENING]	= {preOpeningEnter, 0},
+	[OPENING]		= {openingEnter, movingExit},
+	[PRE_CLOSING]	= {preClosingEnter, 0},
+	[CLOSING]		= {closingEnter, movingExit},
+};
+
+/* RF commands are taken in every state except STARTING */
+#define REMOTE_TRANSITIONS	[EV_REMOTE_OPEN] = PRE_OPENING, [EV_REMOTE_CLOSE] = PRE_CLOSING, [EV_REMOTE_LOCK] = LOCKED
+
+/*
+ * Next state for every (state, event), FSM_NO_TRANSITION (0) => event is ignored in that state.
+ * machinestatetable.md is the same table in readable form, keep them in sync.
+ */
+const uint8_t fsmTransitions[STATE_COUNT][EVENT_COUNT] PROGMEM = {
+	[STARTING]		= {[EV_DONE] = LOCKED},
+	[LOCKED]		= {REMOTE_TRANSITIONS, [EV_OPEN_BTN] = ONE},
+	[ONE]			= {REMOTE_TRANSITIONS, [EV_CLOSE_BTN] = TWO},
+	[TWO]			= {REMOTE_TRANSITIONS, [EV_OPEN_BTN] = THREE},
+	[THREE]			= {REMOTE_TRANSITIONS, [EV_EMERGENCY_BTN] = PRE_IDLE},
+	[PRE_IDLE]		= {REMOTE_TRANSITIONS, [EV_DONE] = IDLE},
+	[IDLE]			= {REMOTE_TRANSITIONS, [EV_OPEN_SWITCH] = OPEN, [EV_CLOSE_SWITCH] = CLOSED,
+					   [EV_OPEN_BTN] = PRE_OPENING, [EV_CLOSE_BTN] = PRE_CLOSING},
+	[CLOSED]		= {REMOTE_TRANSITIONS, [EV_OPEN_BTN] = PRE_OPENING, [EV_EMERGENCY_BTN] = LOCKED},
+	[PARTLY_OPEN]	= {REMOTE_TRANSITIONS, [EV_OPEN_BTN] = PRE_OPENING, [EV_CLOSE_BTN] = PRE_CLOSING, [EV_EMERGENCY_BTN] = LOCKED},
+	[PRE_OPENING]	= {REMOTE_TRANSITIONS, [EV_DONE] = OPENING, [EV_EMERGENCY_BTN] = LOCKED},
+	[OPENING]		= {REMOTE_TRANSITIONS, [EV_TIMEOUT] = LOCKED, [EV_OBSTRUCTION] = LOCKED, [EV_EMERGENCY_BTN] = LOCKED,
+					   [EV_OPEN_SWITCH] = OPEN, [EV_TARGET_REACHED] = PARTLY_OPEN},
+	[OPEN]			= {REMOTE_TRANSITIONS, [EV_CLOSE_BTN] = PRE_CLOSING, [EV_EMERGENCY_BTN] = LOCKED},
+	[PRE_CLOSING]	= {REMOTE_TRANSITIONS, [EV_DONE] = CLOSING, [EV_EMERGENCY_BTN] = LOCKED},
+	[CLOSING]		= {REMOTE_TRANSITIONS, [EV_TIMEOUT] = LOCKED, [EV_OBSTRUCTION] = LOCKED, [EV_EMERGENCY_BTN] = LOCKED,
+					   [EV_CLOSE_SWITCH] = CLOSED},
+};
+
+/* For power.c: 1 when nothing runs by time (motor, LED sequence) and no event is waiting */
+uint8_t powerCanSleep(void) {
+	switch (fsmState) {
+		case LOCKED:
+		case ONE:
+		case TWO:
+		case THREE:
+		case IDLE:
+		case OPEN:
+		case CLOSED:
+		case PARTLY_OPEN:
+			return ledIdle() && fsmIdle() && debounceIdle() && positionIdle();
+		default:
+			return 0;
+	} //end switch
 }
 
 /* Main code begins here */
@@ -61,295 +268,78 @@ int main(void) {
 	DDRD &= ~(1<< PD0);							//set PD0 as input (RX)
 	PORTD |= (1 << PD0);						//enable pull-up resistor on RX (PD0)
 	
-	debounceTimerStart();
+	debounceTimerStart();						//1 ms system tick for the scheduler
 	USART_Init();
+	motorInit();
+	positionInit();
+	fsmStart(STARTING);
+	schedulerAddTask(debounceButtons, 0, BOUNCETIME / DEBOUNCE_SAMPLES);	//All inputs sampled, edges to the event queue
+	schedulerAddTask(buttonEvents, 0, 1);		//Every 1 ms, button events to the state machine
+	schedulerAddTask(powerTask, 0, POWER_CHECK_PERIOD);	//Sleep when there's nothing to do
+	schedulerAddTask(currentMonitor, 0, 1);		//Every 1 ms, motor current while it runs
+	schedulerAddTask(positionTask, 0, POSITION_PERIOD);	//Slow approach, partial opening
+	schedulerAddTask(ledTask, 0, 1);			//Every 1 ms, LED patterns
+	schedulerAddTask(fsmDispatch, 0, 1);		//Every 1 ms, events to the state machine
+	schedulerAddTask(receiverParse, 0, 1);		//Every 1 ms, RF packets from the UART ring buffer
 	sei();
 	
 	while(1)
 	{
-		switch (state)
-		{
-			case STARTING:
-				turnOffLEDs();
-				OUTPUT_PORT |= (1 << OPEN_LED_PIN);
-				OUTPUT_PORT |= (1 << CLOSE_LED_PIN);
-				OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-				_delay_ms(500);
-				turnOffLEDs();
-				_delay_ms(500);
-				OUTPUT_PORT |= (1 << OPEN_LED_PIN);
-				OUTPUT_PORT |= (1 << CLOSE_LED_PIN);
-				OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-				_delay_ms(500);
-				turnOffLEDs();
-				OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-				state = LOCKED;
-				break;
-			
-			case LOCKED:
-				
-				motorStop();
-				if ((!(INPUT_PIN & (1 << OPEN_BTN_PIN))) & (cntOpenButton > chkLimit)) {
-					turnOffLEDs();
-					OUTPUT_PORT |= (1 << OPEN_LED_PIN);
-					state = ONE;
-				}
-				break;
-				
-			case ONE:
-				
-				
-				if ((!(INPUT_PIN & (1 << CLOSE_BTN_PIN))) & (cntCloseButton > chkLimit)) {
-					turnOffLEDs();
-					OUTPUT_PORT |= (1 << CLOSE_LED_PIN);
-					state = TWO;
-				}
-				break;
-				
-			case TWO:
-				
-				
-				if ((!(INPUT_PIN & (1 << OPEN_BTN_PIN))) & (cntOpenButton > chkLimit)) {
-					turnOffLEDs();
-					OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-					state = THREE;
-				}
-				break;
-				
-			case THREE:
-				if ((!(INPUT_PIN & (1 << EMERGENCY_BTN_PIN))) & (cntEmergencyButton > chkLimit)) {
-					turnOffLEDs();
-					state = PRE_IDLE;
-				}				
-				break;
-			
-			case PRE_IDLE:
-				OUTPUT_PORT |= (1 << OPEN_LED_PIN);
-				OUTPUT_PORT |= (1 << CLOSE_LED_PIN);
-				OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-				_delay_ms(250);
-				turnOffLEDs();
-				_delay_ms(250);
-				OUTPUT_PORT |= (1 << OPEN_LED_PIN);
-				OUTPUT_PORT |= (1 << CLOSE_LED_PIN);
-				OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-				_delay_ms(250);
-				turnOffLEDs();
-				OUTPUT_PORT |= (1 << OPEN_LED_PIN);
-				OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-				state = IDLE;
-				break;
-						
-			case IDLE:
-				/* If the Open door switch was pressed */
-				if ((!(INPUT_PIN & (1 << OPEN_SWITCH_PIN))) & (cntOpenSwitch > chkLimit)) {
-					OUTPUT_PORT |= (1 << OPEN_LED_PIN);
-					state = OPEN;
-				}
-				
-				/* If the Closed door switch was pressed */
-				if ((!(INPUT_PIN & (1 << CLOSE_SWITCH_PIN))) & (cntCloseSwitch > chkLimit)) {
-					OUTPUT_PORT |= (1 << CLOSE_LED_PIN);
-					state = CLOSED;
-				}
-				
-				/* If the Open button was pressed */
-				if ((!(INPUT_PIN & (1 << OPEN_BTN_PIN))) & (cntOpenButton > chkLimit)) {
-					state = PRE_OPENING;
-				}
-				
-				/* If the Close button was pressed */
-				if ((!(INPUT_PIN & (1 << CLOSE_BTN_PIN))) & (cntCloseButton > chkLimit)) {
-					state = PRE_CLOSING;
-				}
-				break;
+		schedulerRun();							//Run the tasks that are due, sleep (idle) when nothing is due
+	} //end while
+} //end main
 
-			case CLOSED:
-				/* If the Open button was pressed */
-				if (((!(INPUT_PIN & (1 << OPEN_BTN_PIN))) & (cntOpenButton > chkLimit))) {
-					state = PRE_OPENING;
-				}
-				
-				if ((!(INPUT_PIN & (1 << EMERGENCY_BTN_PIN))) & (cntEmergencyButton > chkLimit)) {
-					OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-					state = LOCKED;
-				}				
-				break;
-				
-			case PRE_OPENING:
-				turnOffLEDs();
-				OUTPUT_PORT ^= (1 << OPEN_LED_PIN);
-				_delay_ms(250);
-				OUTPUT_PORT ^= (1 << OPEN_LED_PIN);
-				_delay_ms(250);
-				state = OPENING;
+/*
+ * All inputs sampled at once (debounce.c), edges to the event queue with the tick.
+ * Run by the scheduler every BOUNCETIME / DEBOUNCE_SAMPLES ms, so the loop over the pins
+ * in debounceEvents() is not in the tick ISR.
+ */
+void debounceButtons()
+{
+	debounceSample(~INPUT_PIN);					//Pulled up, pressed pulls it low => 1 = pressed
+	debounceEvents(BUTTONS_MASK, schedulerTicks);
+}
+
+/*
+ * Button events from the debouncer queue to the state machine, run by the scheduler every 1 ms.
+ * Only presses are used now, release, long and double press are there for the next features.
+ */
+void buttonEvents()
+{
+	DEBOUNCE_EVENT_t event;
+
+	while (debounceGetEvent(&event)) {
+		powerActivity();
+		if (event.type != DEBOUNCE_PRESS) {
+			continue;
+		}
+		switch (event.pin) {
+			case OPEN_BTN_PIN:
+				fsmRaise(EV_OPEN_BTN);
 				break;
-				
-			case OPENING:
-				/* If the timeout happened */
-				if (cntTimeout > timeoutLimit) {
-					OUTPUT_PORT ^= (1 << LOCKED_LED_PIN);
-					_delay_ms(250);
-					OUTPUT_PORT ^= (1 << LOCKED_LED_PIN);
-					_delay_ms(250);
-					motorStop();
-					cntTimeout = 0;
-					state = LOCKED;
-				}
-				
-				motorOpen();
-				
-				/* If the Emergency button was pressed */
-				if ((!(INPUT_PIN & (1 << EMERGENCY_BTN_PIN))) & (cntEmergencyButton > chkLimit)) {
-					OUTPUT_PORT |= (1 << LOCKED_LED_PIN);
-					cntTimeout = 0;
-					state = LOCKED;
-				}
-				
-				/* If the Open door switch was hit */
-				if ((!(INPUT_PIN & (1 << OPEN_SWITCH_PIN))) & (cntOpenSwitch > chkLimit)) {
-					motorStop();
-					turnOffLEDs();
-					OUTPUT_PORT |= (1 << OPEN_LED_PIN);
-					cntTimeout = 0;
-					state = OPEN;
-				}
+			case CLOSE_BTN_PIN:
+				fsmRaise(EV_CLOSE_BTN);
 				break;
-
-			case OPEN:
-				/* If the Close button was pressed */
-				if ((!(INPUT_PIN & (1 << CLOSE_BTN_PIN))) & (cntCloseButton > chkLimit)) {
-					state = PRE_CLOSING;
-				}
-				
-				/* If the Emergency button was pressed */
-				if ((!(INPUT_PIN & (1 << EMERGENCY_BTN_PIN))) & (cntEmergencyButton > chkLimit)) {
-					state = LOCKED;
-				}				
+			case OPEN_SWITCH_PIN:
+				fsmRaise(EV_OPEN_SWITCH);
 				break;
-			
-			case PRE_CLOSING:
-				cli();
-				turnOffLEDs();
-				OUTPUT_PORT ^= (1 << CLOSE_LED_PIN);
-				_delay_ms(250);
-				OUTPUT_PORT ^= (1 << CLOSE_LED_PIN);
-				_delay_ms(250);
-				sei();
-				state = CLOSING;
+			case CLOSE_SWITCH_PIN:
+				fsmRaise(EV_CLOSE_SWITCH);
 				break;
-				
-			case CLOSING:
-				/* If the timeout happened */
-				if (cntTimeout > timeoutLimit) {
-					cli();
-					OUTPUT_PORT ^= (1 << LOCKED_LED_PIN);
-					_delay_ms(500);
-					OUTPUT_PORT ^= (1 << LOCKED_LED_PIN);
-					_delay_ms(500);
-					motorStop();
-					cntTimeout = 0;
-					sei();
-					state = LOCKED;
-				}
-				
-				motorClose();
-				
-				/* If the Emergency button was pressed */
-				if ((!(INPUT_PIN & (1 << EMERGENCY_BTN_PIN))) & (cntEmergencyButton > chkLimit)) {
-					cntTimeout = 0;
-					state = LOCKED;
-				}
-				
-				/* If the Closed door switch was hit */
-				if ((!(INPUT_PIN & (1 << CLOSE_SWITCH_PIN))) & (cntCloseSwitch > chkLimit)) {
-					cli();
-					motorStop();
-					turnOffLEDs();
-					OUTPUT_PORT |= (1 << CLOSE_LED_PIN);
-					cntTimeout = 0;
-					sei();
-					state = CLOSED;
-				}
-				
-				/* if photo-eye blocked - TBD => go to LOCKED state*/
+			case EMERGENCY_BTN_PIN:
+				fsmRaise(EV_EMERGENCY_BTN);
 				break;
-			
 			default:
 				break;
 		} //end switch
-	} //end while
-} //end main
+	}
+}
 
 /*
- * This one is a little bit clumsy :/
- * Compare vector for button debounce on 8-bit timer.
- * cntlimit value: 1 means 1 ms => 10000 is 10 seconds
- * timeoutLimit value: 15000 is 15 seconds => used only for OPENING and CLOSING states
+ * 1 ms system tick (debounceTimerStart) and motor ramps, everything else is done in the tasks.
  */
 ISR(TIMER0_COMPA_vect)
 {
-	static uint8_t cntLimit = 50;
-	static uint16_t ISRtimeoutLimit = 15000;
-
-	if (!(INPUT_PIN & (1 << CLOSE_BTN_PIN))) {
-		cntCloseButton++;
-		if (cntCloseButton > cntLimit) {
-			cntCloseButton = 0;
-		}	
-	} else {
-		if (cntCloseButton > 0) {
-			cntCloseButton--;
-		}
-	}
-	if (!(INPUT_PIN & (1 << OPEN_BTN_PIN))) {
-		cntOpenButton++;
-		if (cntOpenButton > cntLimit) {
-			cntOpenButton = 0;
-		}
-	} else {
-		if (cntOpenButton > 0) {
-			cntOpenButton--;
-		}
-	}
-	if (!(INPUT_PIN & (1 << OPEN_SWITCH_PIN))) {
-		cntOpenSwitch++;
-		if (cntOpenSwitch > cntLimit) {
-			cntOpenSwitch = 0;
-		}
-	} else {
-		if (cntOpenSwitch > 0) {
-			cntOpenSwitch--;
-		}
-	}
-	if (!(INPUT_PIN & (1 << CLOSE_SWITCH_PIN))) {
-		cntCloseSwitch++;
-		if (cntCloseSwitch > cntLimit) {
-			cntCloseSwitch = 0;
-		}
-	} else {
-		if (cntCloseSwitch > 0) {
-			cntCloseSwitch--;
-		}
-	}
-	if (!(INPUT_PIN & (1 << EMERGENCY_BTN_PIN))) {
-		cntEmergencyButton++;
-		if (cntEmergencyButton > cntLimit) {
-			cntEmergencyButton = 0;
-		}
-	} else {
-		if (cntEmergencyButton > 0) {
-			cntEmergencyButton--;
-		}
-	}
-	if ((state == 2) | (state == 4)) {		/* Opening or Closing state */
-		cntTimeout++;
-		if (cntTimeout > ISRtimeoutLimit) {
-			cntTimeout = 0;
-		}
-	} else {
-		if (cntTimeout > 0) {
-			cntTimeout--;
-		}		
-	}
+	schedulerTick();
+	motorRampTick();
 }
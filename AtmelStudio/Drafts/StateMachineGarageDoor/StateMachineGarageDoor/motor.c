@@ -1,33 +1,161 @@
 /* 
  * IN1		IN2		Motor Status
  * -------------------------------
- * LOW		LOW		Stops
+ * LOW		LOW		Stops (brake to GND)
  * LOW		HIGH	Clockwise
  * HIGH		LOW		Anti-Clockwise
  * HIGH		HIGH	Stops
+ *
+ * Speed is the duty of the VNH2SP30 PWM input, driven by Timer2 (OC2B = MOTOR_PWM_PIN),
+ * phase correct PWM without pre-scaler: 8000000 / 510 = 15.7 kHz (the VNH2SP30 takes up to 20 kHz).
+ * motorRampTick() (1 ms tick ISR) moves the duty to the target by MOTOR_ACCEL_STEP/MOTOR_DECEL_STEP
+ * every MOTOR_RAMP_PERIOD ms, so the motor starts and stops softly.
+ * Slow approach: after motorSlow() (position.c, before the end switch) the speed is limited
+ * to MOTOR_SLOW_SPEED. motorWork adds up the duty every ms, position.c estimates the travel from it.
+ * motorOpen()/motorClose() are called once, on entry of OPENING/CLOSING.
+ * Reversing while the motor still turns: both IN pins go low (brake to GND) and the new
+ * direction is switched on only when the ramp has brought the speed to 0, never plugged.
  */
 
 #ifndef F_CPU
 #define F_CPU 8000000UL
 #endif
 #include <avr/io.h>
+#include <util/atomic.h>
 #include "settings.h"
 
-/* Stop the motor. */
+#define MOTOR_STOPPED	0
+#define MOTOR_OPENING	1
+#define MOTOR_CLOSING	2
+
+/* Written by the main code with interrupts off, ramped by motorRampTick() in the tick ISR */
+volatile uint8_t motorDirection = MOTOR_STOPPED;
+volatile uint8_t motorSpeed = 0;				//Current duty
+volatile uint8_t motorTarget = 0;				//Duty to ramp to
+volatile uint8_t motorSlowZone = 0;				//1 => limit to MOTOR_SLOW_SPEED
+volatile uint32_t motorWork = 0;				//Sum of the duty every ms since the motor was started
+volatile uint8_t motorPending = MOTOR_STOPPED;	//Direction to start when the brake ramp reaches 0
+uint8_t motorRampDivider = 0;
+
+/* Set the PWM pin as output, PWM is connected only while the motor runs */
+void motorInit() {
+	DDRD |= (1 << MOTOR_PWM_PIN);
+	PORTD &= ~(1 << MOTOR_PWM_PIN);
+	OCR2B = 0;
+	TCCR2A = (1 << WGM20);						//Phase correct PWM, TOP = 0xFF
+	TCCR2B = 0;									//Stopped
+}
+
+/* Stop right away (emergency, timeout), no ramp */
+void motorBrake() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		motorDirection = MOTOR_STOPPED;
+		motorPending = MOTOR_STOPPED;
+		motorSpeed = 0;
+		motorTarget = 0;
+		TCCR2A &= ~(1 << COM2B1);				//PWM pin back to PORTD => low
+		TCCR2B = 0;
+		OCR2B = 0;
+		OUTPUT_PORT &= ~(1 << MOTOR_IN1_PIN);
+		OUTPUT_PORT &= ~(1 << MOTOR_IN2_PIN);
+	}
+}
+
+/* Switch the driver on in the direction and ramp up. Interrupts must be off. */
+static void motorDrive(uint8_t direction) {
+	if (direction == MOTOR_OPENING) {
+		OUTPUT_PORT &= ~(1 << MOTOR_IN1_PIN);
+		OUTPUT_PORT |= (1 << MOTOR_IN2_PIN);
+	} else {
+		OUTPUT_PORT |= (1 << MOTOR_IN1_PIN);
+		OUTPUT_PORT &= ~(1 << MOTOR_IN2_PIN);
+	}
+	motorDirection = direction;
+	motorPending = MOTOR_STOPPED;
+	motorTarget = MOTOR_MAX_SPEED;
+	motorSlowZone = 0;
+	motorWork = 0;
+	TCCR2A |= (1 << COM2B1);					//Non-inverting PWM on OC2B
+	TCCR2B = (1 << CS20);						//No pre-scaler
+}
+
+/* Set the direction and ramp up from 0. If it still turns the other way, it brakes to GND
+ * first and motorRampTick() starts the new direction when the speed is down to 0. */
+static void motorStart(uint8_t direction) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if ((motorDirection != MOTOR_STOPPED) && (motorDirection != direction) && motorSpeed) {
+			OUTPUT_PORT &= ~(1 << MOTOR_IN1_PIN);
+			OUTPUT_PORT &= ~(1 << MOTOR_IN2_PIN);
+			motorTarget = 0;
+			motorPending = direction;
+		} else {
+			motorDrive(direction);
+		}
+	}
+}
+
+/* Stop the motor, slows down with the MOTOR_DECEL_STEP ramp. */
 void motorStop() {
-	OUTPUT_PORT &= ~(1 << MOTOR_IN1_PIN);
-	OUTPUT_PORT &= ~(1 << MOTOR_IN2_PIN);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		motorTarget = 0;
+		motorPending = MOTOR_STOPPED;
+	}
 }
 
 /* Start turning the motor to close direction */
 void motorOpen() {
-	OUTPUT_PORT &= ~(1 << MOTOR_IN1_PIN);
-	OUTPUT_PORT |= (1 << MOTOR_IN2_PIN);
+	motorStart(MOTOR_OPENING);
 }
 
 /* Start turning the motor to open direction. Check directions in practice!!! */
 void motorClose() {
-	OUTPUT_PORT |= (1 << MOTOR_IN1_PIN);
-	OUTPUT_PORT &= ~(1 << MOTOR_IN2_PIN);
+	motorStart(MOTOR_CLOSING);
+}
+
+/* Slow down to MOTOR_SLOW_SPEED now, e.g. from a "door almost open/closed" switch */
+void motorSlow() {
+	motorSlowZone = 1;
 }
 
+/*
+ * Called from the 1 ms tick ISR. Moves the duty one step every MOTOR_RAMP_PERIOD ms,
+ * switches the driver off when a stop ramp reaches 0, or on in the other direction after
+ * the brake of a reversal.
+ */
+void motorRampTick() {
+	uint8_t target, speed;
+
+	if (motorDirection == MOTOR_STOPPED) {
+		return;
+	}
+	motorWork += motorSpeed;
+	if (++motorRampDivider < MOTOR_RAMP_PERIOD) {
+		return;
+	}
+	motorRampDivider = 0;
+
+	target = motorTarget;
+	if (motorSlowZone && (target > MOTOR_SLOW_SPEED)) {
+		target = MOTOR_SLOW_SPEED;
+	}
+
+	speed = motorSpeed;
+	if (speed < target) {
+		speed = ((target - speed) > MOTOR_ACCEL_STEP) ? (speed + MOTOR_ACCEL_STEP) : target;
+	} else if (speed > target) {
+		speed = ((speed - target) > MOTOR_DECEL_STEP) ? (speed - MOTOR_DECEL_STEP) : target;
+	}
+	motorSpeed = speed;
+	OCR2B = speed;
+
+	if ((speed == 0) && (target == 0)) {
+		if (motorPending != MOTOR_STOPPED) {
+			motorDrive(motorPending);			//Reversal: stopped, now the other way
+		} else {
+			motorBrake();						//Ramp finished, driver off
+		}
+	}
+}
@@ -0,0 +1,277 @@
+/*
+ * Door position estimate, see position.h.
+ */
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+#include <stddef.h>
+#include "settings.h"
+#include "fsm.h"
+#include "position.h"
+
+#define POSITION_SLOTS		2		//Saved to the slots in turn, a torn write leaves the other one good
+#define POSITION_LEARN_SHIFT	2		//New full travel = 3/4 old + 1/4 measured
+#define POSITION_CRC_INIT	0xA5		//Not 0, so an erased (0xFF) or zeroed slot fails the CRC
+
+extern volatile uint32_t motorWork;
+extern volatile uint8_t motorDirection;
+extern void motorSlow();
+
+/* Kept in EEPROM */
+typedef struct
+{
+	uint8_t sequence;					//+1 per save, the newer of the two good slots is loaded
+	uint32_t openWork;					//Work for the full travel, 0 => not learned yet
+	uint32_t closeWork;
+	uint16_t position;
+	uint8_t crc;						//CRC-8 of the bytes before it, a torn write doesn't match
+} POSITION_EEPROM_t;
+
+POSITION_EEPROM_t positionSaved[POSITION_SLOTS] EEMEM;
+POSITION_EEPROM_t position;				//RAM copy
+POSITION_EEPROM_t positionRecord;		//Copy being written, position can change during the save
+uint8_t positionSlot = 0;				//Slot of the last save
+
+uint8_t positionDirection = 0;			//0 => not moving
+uint16_t positionStartPos = 0;			//Where the current run started
+uint8_t positionFromEnd = 0;			//1 => run started at the opposite end switch, can be learned from
+uint16_t positionTarget = POSITION_FULL;
+uint8_t positionTargetDone = 0;
+uint8_t positionStopping = 0;			//1 => stopped by positionStop(), the motor is still ramping down
+uint8_t positionSavePending = 0;		//1 => the RAM copy is being written to EEPROM
+uint8_t positionSaveNext = 0;			//Next byte to write
+
+/* CRC-8 of a record, without the crc byte */
+static uint8_t positionCrc(const POSITION_EEPROM_t *record) {
+	uint8_t i, crc = POSITION_CRC_INIT;
+
+	for (i = 0; i < offsetof(POSITION_EEPROM_t, crc); i++) {
+		crc = _crc8_ccitt_update(crc, ((const uint8_t *)record)[i]);
+	}
+	return crc;
+}
+
+/*
+ * Read the model and the last position from EEPROM: the newer slot with a good CRC.
+ * Start with "unknown" if neither is good (empty EEPROM, or both torn).
+ */
+void positionInit(void) {
+	POSITION_EEPROM_t slot;
+	uint8_t i, found = 0;
+
+	for (i = 0; i < POSITION_SLOTS; i++) {
+		eeprom_read_block(&slot, &positionSaved[i], sizeof(slot));
+		if (slot.crc != positionCrc(&slot)) {
+			continue;
+		}
+		if (!found || ((int8_t)(slot.sequence - position.sequence) > 0)) {
+			position = slot;
+			positionSlot = i;
+			found = 1;
+		}
+	}
+	if (!found) {
+		position.sequence = 0;
+		position.openWork = 0;
+		position.closeWork = 0;
+		position.position = POSITION_FULL / 2;
+		positionSlot = 0;
+	}
+}
+
+/*
+ * Save the RAM copy, positionTask() writes it in the background to the other slot.
+ * A save that comes before the last one is done goes to the same slot, the other
+ * slot still holds the last complete record.
+ */
+static void positionSave(void) {
+	if (!positionSavePending) {
+		positionSlot = (positionSlot + 1) % POSITION_SLOTS;
+	}
+	position.sequence++;
+	position.crc = positionCrc(&position);
+	positionRecord = position;
+	positionSaveNext = 0;
+	positionSavePending = 1;
+}
+
+/*
+ * One step of the background EEPROM save, called every POSITION_PERIOD ms.
+ * Writes at most one changed byte and only when the EEPROM is ready, so it never waits
+ * (a byte takes ~3.4 ms, the period is longer). Unchanged bytes are skipped, no wear.
+ * The sequence number (byte 0) is written last: until then the slot is older than the
+ * other one, so a save torn anywhere in the record can't be loaded, whatever its CRC.
+ */
+static void positionSaveStep(void) {
+	uint8_t i;
+
+	while (positionSavePending && eeprom_is_ready()) {
+		i = ++positionSaveNext;
+		if (i >= sizeof(positionRecord)) {
+			i = 0;
+			positionSavePending = 0;
+		}
+		if (eeprom_read_byte((uint8_t *)&positionSaved[positionSlot] + i) != ((uint8_t *)&positionRecord)[i]) {
+			eeprom_write_byte((uint8_t *)&positionSaved[positionSlot] + i, ((uint8_t *)&positionRecord)[i]);
+			return;
+		}
+	}
+}
+
+/* 1 => nothing left to write or to settle (for powerCanSleep(), the tick stops in sleep) */
+uint8_t positionIdle(void) {
+	return !positionSavePending && !positionStopping;
+}
+
+/* Stop the next opening at target instead of the open end switch (partial opening) */
+void positionSetTarget(uint16_t target) {
+	positionTarget = (target > POSITION_FULL) ? POSITION_FULL : target;
+}
+
+/* Motor work since the start of the run */
+static uint32_t positionWork(void) {
+	uint32_t work;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		work = motorWork;
+	}
+	return work;
+}
+
+/*
+ * Estimated position, also while moving.
+ * work * POSITION_FULL doesn't fit in 32 bits after ~17 s at full duty (timeoutLimit can be
+ * up to 65 s), so work and full are halved together until it does.
+ */
+uint16_t positionGet(void) {
+	uint32_t full, work, moved;
+
+	if (positionDirection == 0) {
+		return position.position;
+	}
+	full = (positionDirection == POSITION_OPENING) ? position.openWork : position.closeWork;
+	if (full == 0) {
+		return positionStartPos;			//Not learned yet, can't tell
+	}
+	work = positionWork();
+	if (work >= full) {
+		moved = POSITION_FULL;				//Whole travel or more
+	} else {
+		while (full > (UINT32_MAX / POSITION_FULL)) {
+			work >>= 1;						//work < full, it fits when full does
+			full >>= 1;
+		}
+		moved = (work * POSITION_FULL) / full;
+	}
+	if (positionDirection == POSITION_OPENING) {
+		return ((positionStartPos + moved) > POSITION_FULL) ? POSITION_FULL : (positionStartPos + moved);
+	}
+	return (moved > positionStartPos) ? 0 : (positionStartPos - moved);
+}
+
+/* The stop ramp is over (or a new run starts), take the estimate as the position and save it */
+static void positionSettle(void) {
+	position.position = positionGet();
+	positionDirection = 0;
+	positionStopping = 0;
+	positionSave();
+}
+
+/* Motor starts, call it before motorOpen()/motorClose(), they reset motorWork */
+void positionStart(uint8_t direction) {
+	if (positionStopping) {
+		positionSettle();					//Previous stop ramp not over yet, it ends here
+	}
+	positionStartPos = position.position;
+	positionFromEnd = (direction == POSITION_OPENING) ? (positionStartPos == 0) : (positionStartPos == POSITION_FULL);
+	positionDirection = direction;
+	positionTargetDone = 0;
+	if ((direction != POSITION_OPENING) || (positionTarget <= positionStartPos)) {
+		positionTarget = POSITION_FULL;		//Partial target only for an opening that gets there
+	}
+}
+
+/*
+ * Motor stopped for any reason. The door still moves during the soft stop ramp,
+ * positionTask() takes the estimate and saves it once the motor is off.
+ */
+void positionStop(void) {
+	if (positionDirection == 0) {
+		return;
+	}
+	positionStopping = 1;
+	positionTarget = POSITION_FULL;
+}
+
+/* Learn the full travel from a complete run: work of the run that just ended */
+static void positionLearn(uint32_t *full) {
+	uint32_t measured = positionWork();
+
+	if (*full == 0) {
+		*full = measured;
+	} else {
+		*full = *full - (*full >> POSITION_LEARN_SHIFT) + (measured >> POSITION_LEARN_SHIFT);
+	}
+}
+
+/* Open end switch hit, call it after positionStop() */
+void positionAtOpen(void) {
+	if (positionFromEnd && (positionStartPos == 0)) {
+		positionLearn(&position.openWork);
+	}
+	positionFromEnd = 0;
+	positionDirection = 0;					//The end switch is exact, no need to wait for the ramp
+	positionStopping = 0;
+	position.position = POSITION_FULL;
+	positionSave();							//Once per run
+}
+
+/* Closed end switch hit, call it after positionStop() */
+void positionAtClosed(void) {
+	if (positionFromEnd && (positionStartPos == POSITION_FULL)) {
+		positionLearn(&position.closeWork);
+	}
+	positionFromEnd = 0;
+	positionDirection = 0;					//The end switch is exact, no need to wait for the ramp
+	positionStopping = 0;
+	position.position = 0;
+	positionSave();							//Once per run
+}
+
+/*
+ * Run by the scheduler every POSITION_PERIOD ms.
+ * Slow approach before the end switch or the target, EV_TARGET_REACHED at the target,
+ * the position after a stop and the EEPROM save.
+ */
+void positionTask(void) {
+	uint16_t now, end;
+
+	if (positionStopping && (motorDirection == 0)) {	//MOTOR_STOPPED, the ramp is over
+		positionSettle();
+	}
+	positionSaveStep();
+	if ((positionDirection == 0) || positionStopping) {
+		return;
+	}
+	if (((positionDirection == POSITION_OPENING) ? position.openWork : position.closeWork) == 0) {
+		motorSlow();						//Not learned yet, whole way slow
+		return;
+	}
+
+	now = positionGet();
+	if (positionDirection == POSITION_OPENING) {
+		end = positionTarget;
+		if ((now + POSITION_SLOW_ZONE) >= end) {
+			motorSlow();
+		}
+		if ((end < POSITION_FULL) && (now >= end) && !positionTargetDone) {
+			positionTargetDone = 1;
+			fsmRaise(EV_TARGET_REACHED);
+		}
+	} else if (now <= POSITION_SLOW_ZONE) {
+		motorSlow();
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef position_H
+#define position_H
+
+/*
+ * Door position estimate from a time-of-travel model
+ *
+ * Author      : rludvik
+ * Description : There is no encoder, so the position is estimated from the motor "work":
+ *               motorRampTick() adds the PWM duty every ms (motorWork), the door moves about
+ *               in proportion to it, also while ramping and in the slow zone.
+ *               Work for the full travel is learned from every complete run (end switch to
+ *               end switch), separately for opening and closing, and kept in EEPROM together
+ *               with the last position, so it's known after a power loss and after LOCKED.
+ *               Two slots are written in turn, each with a sequence number and a CRC-8, a
+ *               write torn by a power loss fails the CRC and the other slot is loaded.
+ *               The position is saved once per run, after the stop ramp, one byte per
+ *               positionTask() call, so the tasks are never held up by the EEPROM.
+ *               positionTask() slows the motor down POSITION_SLOW_ZONE before the end
+ *               switch (or the target of a partial opening) and raises EV_TARGET_REACHED.
+ *               Until the first complete run the door moves at slow speed all the way.
+ *
+ * Position: 0 = closed ... POSITION_FULL = open.
+ */
+
+#include <avr/io.h>
+
+#define POSITION_OPENING	1
+#define POSITION_CLOSING	2
+
+//functions
+extern void positionInit(void);
+extern void positionSetTarget(uint16_t target);
+extern void positionStart(uint8_t direction);
+extern void positionStop(void);
+extern void positionAtOpen(void);
+extern void positionAtClosed(void);
+extern uint16_t positionGet(void);
+extern uint8_t positionIdle(void);
+extern void positionTask(void);
+
+#endif      //position_H
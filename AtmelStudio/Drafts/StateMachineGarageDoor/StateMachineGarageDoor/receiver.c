@@ -11,10 +11,25 @@ Code for Receiver Model: XY-MK-5V Transmitting Frequency: 433.92MHz
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <util/delay.h>
+#include <util/atomic.h>
+#include "scheduler.h"
+#include "rfFrame.h"
+#include "fsm.h"
+#include "power.h"
 
-extern volatile char state;						//Needed to update the state machine in main.c
-//extern void restartTimer();
-extern void turnOffLEDs();
+/* Receive ring buffer. Single producer (USART_RX_vect writes rxHead) and single consumer
+ * (receiverParse() writes rxTail), so no locking is needed. One slot is always left empty
+ * to tell a full buffer from an empty one.
+ */
+volatile uint8_t rxBuffer[RX_BUFFER_SIZE];
+volatile uint8_t rxHead = 0;					//Next free slot, written only by the ISR
+volatile uint8_t rxTail = 0;					//Next byte to read, written only by the parser
+volatile uint8_t rxOverflows = 0;				//Bytes dropped because the buffer was full
+
+uint16_t packetLastByte = 0;					//Tick of the last byte, for the frame timeout
+uint8_t lastSequence = 0;						//Sequence number of the last command that was executed
+uint16_t lastCommandTime = 0;					//Tick of the last command that was executed
+uint8_t haveLastCommand = 0;					//0 => nothing received yet, lastSequence is not valid
 
 //Initializing UART
 void USART_Init(void) {
@@ -28,45 +43,82 @@ void USART_Init(void) {
 	UCSR0B = (1 << RXEN0) | (1 << RXCIE0);
 }
 
-//Read the value out of the UART buffer
-uint8_t USART_vReceiveByte(void) {
-		while((UCSR0A & (1 << RXC0)) == 0);		//Wait until a byte has been received
-		return UDR0;							//Return received data 
+//Take the next byte out of the ring buffer. Returns 0 if the buffer is empty.
+uint8_t rxBufferGet(uint8_t *data) {
+	uint8_t tail = rxTail;
+
+	if (tail == rxHead) {
+		return 0;
+	}
+	*data = rxBuffer[tail];
+	rxTail = (tail + 1) & (RX_BUFFER_SIZE - 1);	//Free the slot only after the byte was read
+	return 1;
+}
+
+//Act on a valid command
+void receiverCommand(uint8_t data) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		OUTPUT_PORT ^= (1 << RF_LED_PIN);		//Motor pins are on the same port, motorBrake() runs in the tick ISR
+	}
+	powerActivity();
+	
+	switch (data) {
+		case EMERGENCY_STOP_CMD:
+			fsmRaise(EV_REMOTE_LOCK);
+			break;
+		case MOTOR_OPEN_CMD:
+			fsmRaise(EV_REMOTE_OPEN);
+			break;
+		case MOTOR_CLOSE_CMD:
+			fsmRaise(EV_REMOTE_CLOSE);
+			break;
+		default:
+			break; 
+	} //end switch
 }
 
-//USART Receiver interrupt service routine
+/*
+ * Packet parser, run by the scheduler every 1 ms (main loop, not ISR).
+ * Bytes from the ring buffer go to the frame decoder (rfFrame.c), which resyncs on SYNC
+ * by itself after noise or a lost byte. A partial frame is thrown away when no byte came
+ * for RX_FRAME_TIMEOUT ms. A frame with the same sequence number as the last executed
+ * command within RF_DUPLICATE_WINDOW ms is a retransmission and is ignored.
+ */
+void receiverParse(void) {
+	uint8_t data;
+	uint16_t now = schedulerMillis();
+	RF_FRAME_t frame;
+
+	if ((uint16_t)(now - packetLastByte) > RX_FRAME_TIMEOUT) {
+		rfDecoderReset();						//Rest of the frame never came
+	}
+	
+	while (rxBufferGet(&data)) {
+		packetLastByte = now;
+		if (rfDecoderPut(data, &frame) && (frame.address == RADDR)) {
+			if (haveLastCommand && (frame.sequence == lastSequence) && ((uint16_t)(now - lastCommandTime) < RF_DUPLICATE_WINDOW)) {
+				continue;						//Retransmission of a command we already executed
+			}
+			lastSequence = frame.sequence;
+			lastCommandTime = now;
+			haveLastCommand = 1;
+			receiverCommand(frame.payload[0]);
+		}
+	}
+}
+
+//USART Receiver interrupt service routine. Only stores the byte, parsing is done in receiverParse()
 ISR(USART_RX_vect)
 {
-	uint8_t rsync, raddress, data, chk;			//define variables
-	rsync = USART_vReceiveByte();				//receive SYNC
-	raddress = USART_vReceiveByte();			//receive destination address
-	data = USART_vReceiveByte();				//receive data
-	chk = USART_vReceiveByte();					//receive checksum
-	
-	OUTPUT_PORT ^= (1 << RF_LED_PIN);
+	uint8_t data = UDR0;						//Read it in any case, this clears the interrupt
+	uint8_t head = rxHead;
+	uint8_t next = (head + 1) & (RX_BUFFER_SIZE - 1);
 	
-	if (rsync == SYNC) {
-		if(chk == (raddress+data)) {			//compare received checksum with calculated
-			if(raddress == RADDR) {				//compare transmitter address
-				//OUTPUT_PORT ^= (1 << LOCKED_LED_PIN);
-				//_delay_ms(500);
-				//OUTPUT_PORT ^= (1 << LOCKED_LED_PIN);
-				//_delay_ms(500);
-					switch (data) {
-						case EMERGENCY_STOP_CMD:
-							turnOffLEDs();
-							state = LOCKED;
-							break;
-						case MOTOR_OPEN_CMD:
-							state = PRE_OPENING;
-							break;
-						case MOTOR_CLOSE_CMD:
-							state = PRE_CLOSING;
-							break;
-						default:
-							break; 
-					} //end switch
-			} //end if raddress
-		} //end if chk
-	} //end if rsync
+	if (next != rxTail) {
+		rxBuffer[head] = data;
+		rxHead = next;							//Publish only after the byte is stored
+	} else {
+		rxOverflows++;							//Buffer full, byte is lost
+	}
 } //end ISR
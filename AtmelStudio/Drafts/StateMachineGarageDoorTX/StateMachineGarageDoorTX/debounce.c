@@ -0,0 +1,58 @@
+/*
+ * Vertical counter debouncer, see debounce.h for how to use it.
+ *
+ * Counter of a pin is reset to 3 (both bits 1) whenever the sample equals the debounced state
+ * and counts down while it differs: 3, 2, 1, 0 => the 4th sample that differs toggles
+ * the debounced state. Based on the well known debouncer from Peter Dannegger.
+ */
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "debounce.h"
+
+volatile uint8_t debounceState = 0;
+volatile uint8_t debouncePress = 0;
+volatile uint8_t debounceRelease = 0;
+uint8_t debounceCnt0 = 0xFF;				//Low bits of the 8 counters
+uint8_t debounceCnt1 = 0xFF;				//High bits of the 8 counters
+
+/* Take one sample of all 8 pins (1 = pressed). Can be called from an ISR or a task. */
+void debounceSample(uint8_t sample) {
+	uint8_t changed = debounceState ^ sample;
+
+	debounceCnt0 = ~(debounceCnt0 & changed);					//Count down or reset to 3
+	debounceCnt1 = debounceCnt0 ^ (debounceCnt1 & changed);
+	changed &= debounceCnt0 & debounceCnt1;						//Counter rolled over => accept the change
+	debounceState ^= changed;
+	debouncePress |= debounceState & changed;
+	debounceRelease |= ~debounceState & changed;
+}
+
+/* Return the press edges of the pins in mask and clear them, so every press is taken once */
+uint8_t debounceTakePressed(uint8_t mask) {
+	uint8_t edges;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		edges = debouncePress & mask;
+		debouncePress ^= edges;
+	}
+	return edges;
+}
+
+/* Same for the release edges */
+uint8_t debounceTakeReleased(uint8_t mask) {
+	uint8_t edges;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		edges = debounceRelease & mask;
+		debounceRelease ^= edges;
+	}
+	return edges;
+}
+
+/* 1 when no pin is in the middle of a change (all counters reset) */
+uint8_t debounceIdle(void) {
+	return (debounceCnt0 & debounceCnt1) == 0xFF;
+}
@@ -0,0 +1,43 @@
+#ifndef debounce_H
+#define debounce_H
+
+/*
+ * Vertical counter debouncer for all 8 pins of a port at once
+ *
+ * Author      : rludvik
+ * Description : Every bit has its own 2-bit counter, kept "vertically" in two bytes
+ *               (bit n of debounceCnt0 and debounceCnt1 is the counter of pin n).
+ *               A pin changes its debounced state only after DEBOUNCE_SAMPLES samples
+ *               in a row differ from it. One sample of all pins is a few XOR/AND operations,
+ *               no loop and no counter per button.
+ *               Debounce time is DEBOUNCE_SAMPLES x the period debounceSample() is called with.
+ *               The transmitter only needs the press edges. The receivers' copy of this module
+ *               also has the timestamped event queue (press, release, long and double press).
+ *
+ * HOW TO USE:
+ *		schedulerAddTask(debounceButtons, 0, BOUNCETIME / DEBOUNCE_SAMPLES);
+ *
+ *		void debounceButtons() {
+ *			debounceSample(~INPUT_PIN);				//Buttons pull the pin low => 1 = pressed
+ *			if (debounceTakePressed(1 << OPEN_BTN_PIN)) {
+ *				...									//Once per press
+ *			}
+ *		}
+ */
+
+#include <avr/io.h>
+
+#define DEBOUNCE_SAMPLES	4		//Same samples in a row to accept a change (2-bit counter)
+
+/* Bit per pin: debounced state (1 = pressed) and edges collected since they were taken */
+extern volatile uint8_t debounceState;
+extern volatile uint8_t debouncePress;
+extern volatile uint8_t debounceRelease;
+
+//functions
+extern void debounceSample(uint8_t sample);
+extern uint8_t debounceTakePressed(uint8_t mask);
+extern uint8_t debounceTakeReleased(uint8_t mask);
+extern uint8_t debounceIdle(void);
+
+#endif      //debounce_H
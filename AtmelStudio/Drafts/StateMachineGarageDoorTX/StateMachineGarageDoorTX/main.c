@@ -14,13 +14,28 @@
 #include <util/delay.h>
 #include <avr/interrupt.h>
 #include "settings.h"
+#include "scheduler.h"
+#include "rfFrame.h"
+#include "debounce.h"
 
-volatile uint8_t cntOpenButton, cntCloseButton, cntEmergencyButton = 0;
-uint8_t chkLimit = 30;
 char state = IDLE;
+uint8_t txSequence = 0;						//Sequence number of the last command sent
+
+/* Transmit ring buffer. Main code writes txHead, USART_UDRE_vect writes txTail */
+volatile uint8_t txBuffer[TX_BUFFER_SIZE];
+volatile uint8_t txHead = 0;				//Next free slot
+volatile uint8_t txTail = 0;				//Next byte to send
+
+/* Last frame, kept for the repeats of the burst */
+uint8_t txFrame[RF_FRAME_MAX_SIZE];
+uint8_t txFrameLength = 0;
+uint8_t txRepeatsLeft = 0;
+int8_t txRepeatTask = SCHEDULER_NO_TASK;
 
 /* Declarations */
 void debounceTimerStart();
+void stateMachineStep();
+void debounceButtons();
 //void USART_Init();
 
 
@@ -35,21 +50,64 @@ void USART_Init(void) {
 	UCSR0B = (1 << TXEN0);					//Enable Transmitter
 }
 
-// Transmit data(byte) function
-void USART_vSendByte(uint8_t u8Data) {
-	//Wait for transmit buffer to be empty
-	while((UCSR0A & (1 << UDRE0)) == 0);
-	//Transmit data - load data into transmit register
-	UDR0 = u8Data;
+// Put bytes to the transmit ring buffer and start the UDRE interrupt. Doesn't wait.
+// Returns TX_QUEUE_FULL (and queues nothing) if there's not enough space for all of them.
+uint8_t USART_Queue(const uint8_t *data, uint8_t length) {
+	uint8_t i, head = txHead;
+	uint8_t space = (txTail - head - 1) & (TX_BUFFER_SIZE - 1);
+
+	if (length > space) {
+		return TX_QUEUE_FULL;
+	}
+	for (i = 0; i < length; i++) {
+		txBuffer[head] = data[i];
+		head = (head + 1) & (TX_BUFFER_SIZE - 1);
+	}
+	txHead = head;							//Publish only after the bytes are stored
+	UCSR0B |= (1 << UDRIE0);				//Data register empty interrupt sends them
+	return TX_QUEUED;
+}
+
+// Send the same frame again, TX_REPEAT_COUNT times in total, TX_REPEAT_GAP ms apart. One-shot task.
+void sendRepeat(void) {
+	txRepeatTask = SCHEDULER_NO_TASK;
+	if (USART_Queue(txFrame, txFrameLength) == TX_QUEUED) {
+		txRepeatsLeft--;
+	}
+	if (txRepeatsLeft > 0) {
+		txRepeatTask = schedulerAddTask(sendRepeat, TX_REPEAT_GAP, 0);
+	}
 }
 
-// Send packet of data 
-void Send_Packet(uint8_t addr, uint8_t cmd)
+// Send packet of data (preamble, SYNC, header, command and CRC-8, see rfFrame.h).
+// Returns as soon as the frame is queued, repeats are sent by sendRepeat().
+// A new command stops the repeats of the previous one.
+// Returns TX_QUEUE_FULL if the frame didn't fit into the transmit buffer, try again later.
+// Nothing changes then, the repeats of the previous command go on.
+uint8_t Send_Packet(uint8_t addr, uint8_t cmd)
 {
-	USART_vSendByte(SYNC);					//Send synchronization byte
-	USART_vSendByte(addr);					//Send receiver address
-	USART_vSendByte(cmd);					//Send increment command
-	USART_vSendByte((addr+cmd));			//Send checksum
+	uint8_t i, length;
+	uint8_t frame[RF_FRAME_MAX_SIZE];
+
+	length = rfFrameEncode(frame, addr, txSequence + 1, &cmd, 1);
+	if (USART_Queue(frame, length) == TX_QUEUE_FULL) {
+		return TX_QUEUE_FULL;
+	}
+	txSequence++;							//New command => new sequence number, repeats keep it
+	for (i = 0; i < length; i++) {
+		txFrame[i] = frame[i];
+	}
+	txFrameLength = length;
+
+	if (txRepeatTask != SCHEDULER_NO_TASK) {
+		schedulerRemoveTask(txRepeatTask);
+		txRepeatTask = SCHEDULER_NO_TASK;
+	}
+	txRepeatsLeft = TX_REPEAT_COUNT - 1;
+	if (txRepeatsLeft > 0) {
+		txRepeatTask = schedulerAddTask(sendRepeat, TX_REPEAT_GAP, 0);
+	}
+	return TX_QUEUED;
 }
 
 int main(void)
@@ -62,83 +120,88 @@ int main(void)
 	INPUT_REG &= ~(1 << MOTOR_STOP_BTN_PIN);			//set CLOSE_SWITCH_PIN as input for the button
 	INPUT_PORT |= (1 << MOTOR_STOP_BTN_PIN);			//enable pull-up resistor on button input
 
-	debounceTimerStart();
+	debounceTimerStart();						//1 ms system tick for the scheduler
 	USART_Init();
+	schedulerAddTask(debounceButtons, 0, BOUNCETIME / DEBOUNCE_SAMPLES);	//BOUNCETIME ms for a change
+	schedulerAddTask(stateMachineStep, 0, 1);	//Every 1 ms
 	sei();
 	
 	while(1)
 	{
-		switch (state){
-			case IDLE:
-				OUTPUT_PORT &= ~(1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state				
-				if ((!(INPUT_PIN & (1 << OPEN_BTN_PIN))) & (cntOpenButton > chkLimit)) {
-					Send_Packet(RADDR, MOTOR_OPEN_CMD);		//send Open cmd
-					state = OPENING;					//switch state
-				}
-				if ((!(INPUT_PIN & (1 << CLOSE_BTN_PIN))) & (cntCloseButton > chkLimit)) {				
-					Send_Packet(RADDR, MOTOR_CLOSE_CMD);		//send Close cmd
-					state = CLOSING;					//switch state					
-				}				
-				if ((!(INPUT_PIN & (1 << MOTOR_STOP_BTN_PIN))) & (cntEmergencyButton > chkLimit)) {
-					Send_Packet(RADDR, MOTOR_STOP_CMD);	//send Stop motor cmd
-					state = STOPPING;					//switch state					
-				}				
-				break;
-			case OPENING:
-				OUTPUT_PORT |= (1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state
-				state = IDLE;
-				break;
-			case CLOSING:
-				OUTPUT_PORT |= (1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state			
-				//_delay_ms(WAIT_TIME);						//wait a little bit
-				//OUTPUT_PORT &= ~(1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state				
-				state = IDLE;
-				break;
-			case STOPPING:
-				OUTPUT_PORT |= (1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state			
-				//_delay_ms(WAIT_TIME);						//wait a little bit
-				//OUTPUT_PORT &= ~(1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state
-				state = IDLE;
-				break;
-			default:
-				break;			
-		} //end switch
+		schedulerRun();							//Run the tasks that are due, sleep (idle) when nothing is due
 	}
 	return 0;
 }
 
-ISR(TIMER0_COMPA_vect)
+/*
+ * One step of the state machine, run by the scheduler every 1 ms.
+ */
+void stateMachineStep() {
+	switch (state){
+		case IDLE:
+			OUTPUT_PORT &= ~(1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state				
+			//Press edges stay set until the command is queued, so a full buffer is retried on the next step
+			if (debouncePress & (1 << OPEN_BTN_PIN)) {
+				if (Send_Packet(RADDR, MOTOR_OPEN_CMD) == TX_QUEUED) {		//send Open cmd
+					debounceTakePressed(1 << OPEN_BTN_PIN);
+					state = OPENING;					//switch state
+				}
+			}
+			if (debouncePress & (1 << CLOSE_BTN_PIN)) {
+				if (Send_Packet(RADDR, MOTOR_CLOSE_CMD) == TX_QUEUED) {		//send Close cmd
+					debounceTakePressed(1 << CLOSE_BTN_PIN);
+					state = CLOSING;					//switch state
+				}					
+			}				
+			if (debouncePress & (1 << MOTOR_STOP_BTN_PIN)) {
+				if (Send_Packet(RADDR, MOTOR_STOP_CMD) == TX_QUEUED) {	//send Stop motor cmd
+					debounceTakePressed(1 << MOTOR_STOP_BTN_PIN);
+					state = STOPPING;					//switch state
+				}					
+			}				
+			break;
+		case OPENING:
+			OUTPUT_PORT |= (1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state
+			state = IDLE;
+			break;
+		case CLOSING:
+			OUTPUT_PORT |= (1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state			
+			//_delay_ms(WAIT_TIME);						//wait a little bit
+			//OUTPUT_PORT &= ~(1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state				
+			state = IDLE;
+			break;
+		case STOPPING:
+			OUTPUT_PORT |= (1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state			
+			//_delay_ms(WAIT_TIME);						//wait a little bit
+			//OUTPUT_PORT &= ~(1 << RF_LED_PIN);			//turn off the LEDs and go to IDLE state
+			state = IDLE;
+			break;
+		default:
+			break;			
+	} //end switch
+}
+
+/* Button debounce, run by the scheduler every BOUNCETIME / DEBOUNCE_SAMPLES ms. All buttons at once, see debounce.c */
+void debounceButtons()
 {
-	static uint8_t cntLimit = 50;
+	debounceSample(~INPUT_PIN);					//Pulled up, pressed pulls it low => 1 = pressed
+}
 
-	if (!(INPUT_PIN & (1 << CLOSE_BTN_PIN))) {
-		cntCloseButton++;
-		if (cntCloseButton > cntLimit) {
-			cntCloseButton = 0;
-		}
-	} else {
-		if (cntCloseButton > 0) {
-			cntCloseButton--;
-		}
-	}
-	if (!(INPUT_PIN & (1 << OPEN_BTN_PIN))) {
-		cntOpenButton++;
-		if (cntOpenButton > cntLimit) {
-			cntOpenButton = 0;
-		}
-	} else {
-		if (cntOpenButton > 0) {
-			cntOpenButton--;
-		}
-	}
-	if (!(INPUT_PIN & (1 << MOTOR_STOP_BTN_PIN))) {
-		cntEmergencyButton++;
-		if (cntEmergencyButton > cntLimit) {
-			cntEmergencyButton = 0;
-		}
-	} else {
-		if (cntEmergencyButton > 0) {
-			cntEmergencyButton--;
-		}
+/* Transmit the next byte from the ring buffer, switch itself off when the buffer is empty */
+ISR(USART_UDRE_vect)
+{
+	uint8_t tail = txTail;
+
+	if (tail == txHead) {
+		UCSR0B &= ~(1 << UDRIE0);
+		return;
 	}
+	UDR0 = txBuffer[tail];
+	txTail = (tail + 1) & (TX_BUFFER_SIZE - 1);
+}
+
+/* 1 ms system tick (debounceTimerStart), everything else is done in the tasks */
+ISR(TIMER0_COMPA_vect)
+{
+	schedulerTick();
 }
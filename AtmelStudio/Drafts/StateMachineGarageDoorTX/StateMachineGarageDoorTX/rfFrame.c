@@ -0,0 +1,171 @@
+/*
+ * Encoder and streaming decoder for the RF frames, see rfFrame.h for the format.
+ * Same file in the TX and RX firmware.
+ */
+
+#include <avr/io.h>
+#include <string.h>
+#include <util/crc16.h>
+#include "settings.h"
+#include "rfFrame.h"
+
+/* Decoder states */
+#define RF_WAIT_SYNC		0
+#define RF_WAIT_VERSION		1
+#define RF_WAIT_LENGTH		2
+#define RF_WAIT_ADDRESS		3
+#define RF_WAIT_SEQUENCE	4
+#define RF_WAIT_PAYLOAD		5
+#define RF_WAIT_CRC			6
+
+/* rfDecoderStep() results */
+#define RF_MORE				0					//Byte taken, frame not complete yet
+#define RF_DONE				1					//Valid frame
+#define RF_BAD				2					//Frame is bad, the byte was the last one taken
+
+#define RF_DECODER_BYTES	(RF_FRAME_MAX_SIZE - RF_PREAMBLE_LEN - 1)	//Longest frame after SYNC
+
+uint8_t rfDecoderState = RF_WAIT_SYNC;
+uint8_t rfDecoderBytes[RF_DECODER_BYTES];		//Bytes taken since the SYNC, for the rescan of a bad frame
+uint8_t rfDecoderTaken = 0;
+uint8_t rfDecoderCrc;
+uint8_t rfDecoderCount;							//Payload bytes received so far
+RF_FRAME_t rfDecoderFrame;						//Frame being received
+
+/*
+ * Build the frame in buffer (at least RF_FRAME_MAX_SIZE bytes).
+ * Returns the number of bytes to send, 0 if the payload is too long.
+ */
+uint8_t rfFrameEncode(uint8_t *buffer, uint8_t address, uint8_t sequence, const uint8_t *payload, uint8_t length) {
+	uint8_t i, n = 0, crc = 0;
+
+	if ((length == 0) || (length > RF_MAX_PAYLOAD)) {
+		return 0;
+	}
+
+	for (i = 0; i < RF_PREAMBLE_LEN; i++) {
+		buffer[n++] = RF_PREAMBLE;
+	}
+	buffer[n++] = SYNC;
+
+	buffer[n++] = RF_FRAME_VERSION;
+	buffer[n++] = length;
+	buffer[n++] = address;
+	buffer[n++] = sequence;
+	for (i = 0; i < length; i++) {
+		buffer[n++] = payload[i];
+	}
+
+	for (i = RF_PREAMBLE_LEN + 1; i < n; i++) {	//CRC from VERSION to the end of the payload
+		crc = _crc8_ccitt_update(crc, buffer[i]);
+	}
+	buffer[n++] = crc;
+	return n;
+}
+
+/* Start looking for a new frame, e.g. after a timeout in the middle of the frame */
+void rfDecoderReset(void) {
+	rfDecoderState = RF_WAIT_SYNC;
+}
+
+/* One byte through the decoder states, RF_MORE, RF_DONE (frame filled in) or RF_BAD */
+static uint8_t rfDecoderStep(uint8_t data, RF_FRAME_t *frame) {
+	if (rfDecoderState == RF_WAIT_SYNC) {
+		if (data == SYNC) {
+			rfDecoderTaken = 0;
+			rfDecoderState = RF_WAIT_VERSION;
+		}
+		return RF_MORE;
+	}
+	rfDecoderBytes[rfDecoderTaken++] = data;
+
+	switch (rfDecoderState) {
+		case RF_WAIT_VERSION:
+			if (data == RF_FRAME_VERSION) {
+				rfDecoderCrc = _crc8_ccitt_update(0, data);
+				rfDecoderState = RF_WAIT_LENGTH;
+				return RF_MORE;
+			}
+			break;
+
+		case RF_WAIT_LENGTH:
+			if ((data > 0) && (data <= RF_MAX_PAYLOAD)) {
+				rfDecoderCrc = _crc8_ccitt_update(rfDecoderCrc, data);
+				rfDecoderFrame.length = data;
+				rfDecoderState = RF_WAIT_ADDRESS;
+				return RF_MORE;
+			}
+			break;
+
+		case RF_WAIT_ADDRESS:
+			rfDecoderCrc = _crc8_ccitt_update(rfDecoderCrc, data);
+			rfDecoderFrame.address = data;
+			rfDecoderState = RF_WAIT_SEQUENCE;
+			return RF_MORE;
+
+		case RF_WAIT_SEQUENCE:
+			rfDecoderCrc = _crc8_ccitt_update(rfDecoderCrc, data);
+			rfDecoderFrame.sequence = data;
+			rfDecoderCount = 0;
+			rfDecoderState = RF_WAIT_PAYLOAD;
+			return RF_MORE;
+
+		case RF_WAIT_PAYLOAD:
+			rfDecoderCrc = _crc8_ccitt_update(rfDecoderCrc, data);
+			rfDecoderFrame.payload[rfDecoderCount++] = data;
+			if (rfDecoderCount == rfDecoderFrame.length) {
+				rfDecoderState = RF_WAIT_CRC;
+			}
+			return RF_MORE;
+
+		case RF_WAIT_CRC:
+			if (data == rfDecoderCrc) {
+				*frame = rfDecoderFrame;
+				rfDecoderState = RF_WAIT_SYNC;
+				return RF_DONE;
+			}
+			break;
+
+		default:
+			break;
+	} //end switch
+
+	rfDecoderState = RF_WAIT_SYNC;
+	return RF_BAD;
+}
+
+/*
+ * Feed one received byte to the decoder.
+ * Returns 1 and fills in frame when the byte completed a valid frame, 0 otherwise.
+ * On any error (unknown version, bad length, CRC) the bytes taken since the SYNC of the bad
+ * frame are scanned again from the start: a SYNC among them (a corrupted length makes the
+ * decoder run into the next frame) starts a new frame right there, so that frame isn't lost.
+ * The preamble is not needed for that, it's only for the receiver AGC.
+ */
+uint8_t rfDecoderPut(uint8_t data, RF_FRAME_t *frame) {
+	uint8_t pending[RF_DECODER_BYTES];
+	uint8_t count, i, kept, result, done = 0;
+
+	result = rfDecoderStep(data, frame);
+	if (result != RF_BAD) {
+		return (result == RF_DONE);
+	}
+
+	count = rfDecoderTaken;
+	memcpy(pending, rfDecoderBytes, count);
+	i = 0;
+	while (i < count) {
+		result = rfDecoderStep(pending[i++], frame);
+		if (result == RF_DONE) {
+			done = 1;
+		} else if (result == RF_BAD) {
+			/* Bad again: bytes since this SYNC first, then the ones not fed yet. Always fewer than before. */
+			kept = rfDecoderTaken;
+			memmove(&pending[kept], &pending[i], count - i);
+			memcpy(pending, rfDecoderBytes, kept);
+			count = kept + count - i;
+			i = 0;
+		}
+	}
+	return done;
+}
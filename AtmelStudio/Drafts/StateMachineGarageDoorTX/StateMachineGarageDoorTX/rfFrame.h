@@ -0,0 +1,39 @@
+#ifndef rfFrame_H
+#define rfFrame_H
+
+/*
+ * Frame format for the 433 MHz RF link (FS1000A -> XY-MK-5V over UART).
+ * Same file in the TX (StateMachineGarageDoorTX) and RX (StateMachineGarageDoor) firmware.
+ *
+ * Version 1:
+ *   PREAMBLE x RF_PREAMBLE_LEN | SYNC | VERSION | LENGTH | ADDRESS | SEQUENCE | PAYLOAD x LENGTH | CRC-8
+ *
+ * - Preamble (0x55 = 01010101) lets the AGC of the ASK receiver settle, it's skipped by the decoder.
+ * - CRC-8 (polynomial 0x07, _crc8_ccitt_update from avr-libc) covers VERSION up to the last PAYLOAD byte.
+ * - SEQUENCE is incremented by the transmitter for every new command, repeats of the same
+ *   command keep it, so the receiver can tell a retransmission from a new command.
+ */
+
+#include <avr/io.h>
+
+#define RF_FRAME_VERSION	1
+#define RF_PREAMBLE			0x55				//Alternating bits for the receiver AGC
+#define RF_PREAMBLE_LEN		4
+#define RF_MAX_PAYLOAD		4					//Longest payload (commands are 1 byte now)
+#define RF_FRAME_MAX_SIZE	(RF_PREAMBLE_LEN + 6 + RF_MAX_PAYLOAD)	//Buffer size for rfFrameEncode()
+
+/* Decoded frame */
+typedef struct
+{
+	uint8_t address;
+	uint8_t sequence;
+	uint8_t length;
+	uint8_t payload[RF_MAX_PAYLOAD];
+} RF_FRAME_t;
+
+//functions
+extern uint8_t rfFrameEncode(uint8_t *buffer, uint8_t address, uint8_t sequence, const uint8_t *payload, uint8_t length);
+extern void rfDecoderReset(void);
+extern uint8_t rfDecoderPut(uint8_t data, RF_FRAME_t *frame);
+
+#endif      //rfFrame_H
@@ -36,6 +36,12 @@ RF signal sending	- blue LED
 #define MOTOR_STOP_CMD		0x69				//Command to stop the motor
 #define MOTOR_OPEN_CMD		0xA0				//Command to open the door
 #define MOTOR_CLOSE_CMD		0x25				//Command to close the door
+//Transmit buffer and repeats
+#define TX_BUFFER_SIZE		64					//UART transmit ring buffer, must be a power of 2
+#define TX_REPEAT_COUNT		3					//Every command is sent this many times (FS1000A link is unreliable)
+#define TX_REPEAT_GAP		30					//ms between two repeats
+#define TX_QUEUED			1					//Send_Packet() return values
+#define TX_QUEUE_FULL		0
 
 //#define WAIT_TIME		500				//Time to wait after a button is press
 
@@ -31,14 +31,18 @@
  * OCR0B = 255 => we get 16 ms square wave time period
  * TIMSK0 = (1 << OCIE0B); HAS TO BE RUN AFTER THE LOCK IS PULLED AND HOLD UNTIL COMPARE MATCH (~4 seconds)
  * This will be set in unlock_solenoid() and unset WHERE???
+ *
+ * That's the square wave period (two compare matches). The interrupt itself fires every
+ * (OCR0A+1)*N/Fclk = 16*256/8000000 = 0.512 ms. The scheduler needs a real 1 ms tick:
+ * OCR0A = 124 with 64 pre-scaler => 125*64/8000000 = 1 ms between interrupts.
  */
 void debounceTimerStart() {
 	//OCR0A = 249;
-	OCR0A = 15;
+	OCR0A = 124;
 	//OCR0B = 255;
 	TCCR0A |= (1 << WGM01); 			//Set CTC mode
 	//TCCR0B = (1 << CS01);				//Set 8 prescaler
-	TCCR0B = (1 << CS02);				//Set 256 prescaler
+	TCCR0B = (1 << CS01) | (1 << CS00);	//Set 64 prescaler
 	TIMSK0 = (1 << OCIE0A);				//Timer/Counter0 Output Compare Match A Interrupt Enable
 	//TIMSK0 = (1 << OCIE0B);			//Timer/Counter0 Output Compare Match B Interrupt Enable
 	//sei();							//Will be set in main
@@ -41,42 +41,144 @@ sudo avrdude -v -v -c usbtiny -p ATmega328P -U flash:w:DHT22_OnSevSeg.hex:i -U l
 
 #define F_CPU 8000000UL
 #include <avr/io.h>
-#include <util/delay.h>
+#include <avr/interrupt.h>
 
 #include "SevSeg.h"
+#include "ssdGlyphs.h"			// Board profile (ATmega328p wiring) is set in SevSeg.h
 
-void ssdDisplay(int numToDisplay) {
-	// Array of chars to display (0..9)
-	//ATtiny4313
-	   //char seg_code[]={0xc0,0xf9,0xa4,0xb0,0x99,0x92,0x82,0xf8,0x80,0x90};	// just numbers
-	//char seg_code_dp[]={0x40,0x79,0x24,0x30,0x19,0x12,0x02,0x78,0x00,0x10};	// numbers with DP on 
-	//ATmega328p
-	   char seg_code[]={0x81,0xcf,0x92,0x86,0xcc,0xa4,0xa0,0x8f,0x80,0x84};	// just numbers
-	char seg_code_dp[]={0x01,0x4f,0x12,0x06,0x4c,0x24,0x20,0x0f,0x00,0x04};	// numbers with DP on 
-	int num, temp, i;
+// Digit select value for each position, left to right
+const uint8_t ssdDigitSelect[SSD_NR_OF_DIGITS] = {SegOne, SegTwo, SegThree};
+
+// Powers of ten for each position, used instead of division
+const uint16_t ssdPowersOfTen[SSD_NR_OF_DIGITS] = {100, 10, 1};
+
+// Frame buffer with segment bytes, ready to be written to DATA_PORT
+volatile uint8_t ssdFrameBuffer[SSD_NR_OF_DIGITS] = {SSD_BLANK, SSD_BLANK, SSD_BLANK};
+
+// Glyph cache. Filled only when the value changes, copied to the frame buffer by the ISR
+volatile uint8_t ssdGlyphs[SSD_NR_OF_DIGITS];
+volatile uint8_t ssdDirty = 0;			// 1 => ssdGlyphs holds a new frame
+uint16_t ssdValue = 0;					// Last number converted to ssdGlyphs
+uint8_t ssdValueValid = 0;				// 0 => ssdGlyphs doesn't hold ssdValue (raw or nothing)
+
+/*
+ * Set up the ports and start the refresh timer.
+ * Interrupts have to be enabled (sei) by the caller.
+ */
+void ssdInit(void) {
 	//Set registers as output
-	DIGIT_CONTROL_DDR = (1<<PD0) | (1<<PD1) | (1<<PD2);
+	DIGIT_CONTROL_DDR |= SSD_DIGIT_MASK;
 	DATA_DDR = 0xff;
-	//Loop 100 times and show each number
-	for (i = 0; i < 300; i++)
+	DATA_PORT = SSD_BLANK;
+
+	SSD_TIMER_SETUP_CTC
+	SSD_TIMER_OCR_REGISTER = SSD_TICKS_PER_DIGIT - 1;
+	ssdSetBrightness(SSD_BRIGHTNESS_LEVELS - 1);
+	SSD_TIMER_ENABLE_CTC_INTERRUPT
+	SSD_TIMER_ENABLE_BLANK_INTERRUPT
+	SSD_TIMER_START
+}
+
+/*
+ * Set the on-time of every digit, 0 is the dimmest and SSD_BRIGHTNESS_LEVELS - 1 is full brightness.
+ * Even at full brightness the last SSD_BLANK_TICKS of the tick are blank, so the
+ * segments are never on while the digit select changes.
+ */
+void ssdSetBrightness(uint8_t level) {
+	if (level >= SSD_BRIGHTNESS_LEVELS)
 	{
-		num = numToDisplay;
-		temp = num / 100;
-		num = num % 100;
-		DIGIT_CONTROL_PORT = SegOne;				// Select digit 1
-		DATA_PORT = seg_code[temp];					// Display corresponding char from array
-		_delay_ms(1);												// And the same for other 3 digits below
-
-		temp = num / 10;
-		num = num % 10;
-		DIGIT_CONTROL_PORT = SegTwo;
-		DATA_PORT = seg_code[temp];
-		_delay_ms(1);
-
-		temp = num % 10;
-		PORTD = SegThree;
-		PORTB = seg_code_dp[temp];
-		_delay_ms(1);
+		level = SSD_BRIGHTNESS_LEVELS - 1;
 	}
+	SSD_TIMER_BLANK_OCR_REGISTER = ((uint16_t)(SSD_TICKS_PER_DIGIT - SSD_BLANK_TICKS) * (level + 1)) / SSD_BRIGHTNESS_LEVELS;
+}
 
+/*
+ * Convert the number to segment bytes and hand them over to the ISR.
+ * Only the last SSD_NR_OF_DIGITS digits are shown, the last one with DP on.
+ * Returns immediately. If the number didn't change, nothing is done, so it can be
+ * called on every loop.
+ * Digits are found by subtracting powers of ten, no (software) division on AVR.
+ */
+void ssdSetNumber(int numToDisplay) {
+	uint16_t num = numToDisplay;
+	uint8_t i, temp;
+
+	if (ssdValueValid && (num == ssdValue))
+	{
+		return;
+	}
+	ssdValue = num;
+
+	while (num >= SSD_NUMBER_LIMIT)		// Drop the digits we can't show
+	{
+		num -= SSD_NUMBER_LIMIT;
+	}
+
+	ssdDirty = 0;						// ISR must not latch a half written frame
+	for (i = 0; i < SSD_NR_OF_DIGITS; i++)
+	{
+		temp = 0;
+		while (num >= ssdPowersOfTen[i])
+		{
+			num -= ssdPowersOfTen[i];
+			temp++;
+		}
+		ssdGlyphs[i] = ssdGlyph(temp);
+	}
+	ssdGlyphs[SSD_NR_OF_DIGITS - 1] = SSD_DP(ssdGlyph(temp));
+	ssdValueValid = 1;
+	ssdDirty = 1;
+}
+
+/*
+ * Put raw segment bytes (one per digit, left to right) to the frame buffer.
+ * Used for letters and other things that are not numbers.
+ */
+void ssdSetRaw(const uint8_t *segments) {
+	uint8_t i;
+
+	ssdDirty = 0;						// ISR must not latch a half written frame
+	for (i = 0; i < SSD_NR_OF_DIGITS; i++)
+	{
+		ssdGlyphs[i] = segments[i];
+	}
+	ssdValueValid = 0;
+	ssdDirty = 1;
+}
+
+/*
+ * Refresh the display, one digit per compare match.
+ * Nothing is calculated here, the frame buffer already holds the segment bytes.
+ */
+ISR(SSD_TIMER_CTC_VECTOR)
+{
+	static uint8_t digit = 0;
+	uint8_t i;
+
+	if ((digit == 0) && ssdDirty)		// Take the new frame only at the start of the frame
+	{
+		for (i = 0; i < SSD_NR_OF_DIGITS; i++)
+		{
+			ssdFrameBuffer[i] = ssdGlyphs[i];
+		}
+		ssdDirty = 0;
+	}
+
+	DATA_PORT = SSD_BLANK;																	// Segments off while switching digits
+	DIGIT_CONTROL_PORT = (DIGIT_CONTROL_PORT & ~SSD_DIGIT_MASK) | ssdDigitSelect[digit];	// Select digit
+	DATA_PORT = ssdFrameBuffer[digit];														// Display corresponding char from buffer
+
+	digit++;
+	if (digit >= SSD_NR_OF_DIGITS)
+	{
+		digit = 0;
+	}
+}
+
+/*
+ * End of the on-time of the digit. Segments stay off until the next digit is selected.
+ */
+ISR(SSD_TIMER_BLANK_VECTOR)
+{
+	DATA_PORT = SSD_BLANK;
 }
@@ -6,13 +6,27 @@
  *
  * Author      : Robert Ludvik
  * Description : 7-segment Library for harvested 3-digit SSD
+ *
+ * The display is refreshed from the timer compare interrupt, one digit per tick.
+ * ssdSetNumber() and ssdSetRaw() only fill the frame buffer and return immediately.
+ * Brightness is software PWM: the second compare channel switches the segments off
+ * after the on-time of the digit, the rest of the tick the digit is blank.
+ *
+ * HOW TO USE:
+ *		ssdInit();
+ *		sei();
+ *		ssdSetNumber(248);
+ *		ssdSetBrightness(7);		// 0 (dim garage) .. SSD_BRIGHTNESS_LEVELS - 1 (bright room)
  */
 
 #include <stdio.h>
 #include <avr/io.h>
 
 //functions
-extern void ssdDisplay(int numToDisplay);
+extern void ssdInit(void);
+extern void ssdSetNumber(int numToDisplay);
+extern void ssdSetRaw(const uint8_t *segments);
+extern void ssdSetBrightness(uint8_t level);
 
 //Registers used
 #define DIGIT_CONTROL_DDR   DDRD
@@ -25,10 +39,30 @@ extern void ssdDisplay(int numToDisplay);
 #define SegTwo   0x02		//PD1
 #define SegThree 0x04		//PD2
 
-// Array of chars to display (0..9)
-//char seg_code[]={0xc0,0xf9,0xa4,0xb0,0x99,0x92,0x82,0xf8,0x80,0x90};	// just numbers
-//char seg_code_dp[]={0x40,0x79,0x24,0x30,0x19,0x12,0x02,0x78,0x00,0x10};	// numbers with DP on
-extern char seg_code[];	// just numbers
-extern char seg_code_dp[];	// numbers with DP on
+#define SSD_NR_OF_DIGITS	3
+#define SSD_NUMBER_LIMIT	1000		// 10^SSD_NR_OF_DIGITS
+#define SSD_DIGIT_MASK		(SegOne | SegTwo | SegThree)
+#define SSD_BLANK			0xff		// Common anode => all segments off
+
+#define SSD_BRIGHTNESS_LEVELS	16		// ssdSetBrightness() levels, the last one is full brightness
+#define SSD_BLANK_TICKS			4		// Segments stay off at least this long before the next digit is selected (no ghosting)
+
+/* Refresh timer (8-bit Timer2 in CTC mode, Timer0 is used by main.c)
+ * 8 MHz / 64 prescaler = 125 kHz => 125 ticks = 1 ms per digit, 3 ms per frame (333 Hz)
+ */
+#define SSD_TIMER_SETUP_CTC				TCCR2A = (1 << WGM21);		// Code to configure the timer in CTC mode.
+#define SSD_TIMER_ENABLE_CTC_INTERRUPT	TIMSK2 |= (1 << OCIE2A);	// Code to enable Compare Match Interrupt
+#define SSD_TIMER_OCR_REGISTER			OCR2A						// Timer output compare register.
+#define SSD_TIMER_START					TCCR2B = (1 << CS22);		// Code to start timer with 64 prescaler
+#define SSD_TIMER_CTC_VECTOR			TIMER2_COMPA_vect
+#define SSD_TICKS_PER_DIGIT				125
+
+/* Second compare channel of the same timer ends the on-time of the digit (brightness) */
+#define SSD_TIMER_ENABLE_BLANK_INTERRUPT	TIMSK2 |= (1 << OCIE2B);	// Code to enable Compare Match B Interrupt
+#define SSD_TIMER_BLANK_OCR_REGISTER		OCR2B						// Timer output compare register B.
+#define SSD_TIMER_BLANK_VECTOR				TIMER2_COMPB_vect
+
+// Segment bytes for the numbers come from the glyph table in flash (ssdGlyphs.h)
+#define SSD_BOARD			SSD_BOARD_328P
 
 #endif      //SevSeg_H
@@ -0,0 +1,233 @@
+/* Copyright rludvik <r@aufbix.org> 2022
+ *
+ * Input capture backend of Moreto's DHT22 Interrupt Driven library for AVR,
+ * same API as DHT22int.c (see Copyright section there).
+ *
+ * This file is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This file comes WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * Please consult the GNU General Public License at http://www.gnu.org/licenses/.
+ */
+
+/*
+ * DHT22icp.c
+ *
+ * Compiled instead of DHT22int.c when DHT22_BACKEND is DHT22_ICP (DHT22int_4313.h).
+ * The data line has to be on the ICP1 pin (PD6 on ATtiny4313).
+ *
+ * DHT22int.c reads and resets the timer in the INT0 handler, so the interrupt latency
+ * (e.g. while the display ISR runs) ends up in the measured width. Here the Timer1
+ * input capture unit latches the timer at the edge in hardware and the handler only
+ * stores that timestamp. Every falling edge is captured:
+ *
+ *   edge 0         sensor pulls the line low (response, P3)
+ *   edge 1         end of the 80us high (P4), first bit starts
+ *   edge 2 .. 41   end of each bit, the falling-to-falling width is 50us + 26..28us (0) or 50us + 70us (1)
+ *
+ * The widths are computed and the bits decoded in DHT22_CheckStatus(), after the frame.
+ * Timer1 keeps running in CTC mode for the display, so a timestamp wraps at SSD_TICKS_PER_DIGIT.
+ * All widths are much shorter than that (1 ms), so one wrap between two edges is enough.
+ *
+ * Timer0 generates the host start (P1, P2) like in DHT22int.c and then
+ * fires once more if the frame isn't complete in ICP_TIMEOUT_TICKS.
+ */
+
+#define F_CPU 1000000UL
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "DHT22int_4313.h"
+#include "ssd.h"			// SSD_TICKS_PER_DIGIT, Timer1 period
+
+#if DHT22_BACKEND == DHT22_ICP
+
+#if SSD_TICKS_PER_DIGIT > 256
+#error "Timer1 TOP doesn't fit in ICR1L, read the whole ICR1 in ICP_VECTOR"
+#endif
+
+/* Global variables for this file */
+DHT22_STATE_t state;
+uint8_t overflow_cnt = 0;
+volatile uint8_t edgeCount = 0;
+volatile uint8_t edgeTime[ICP_EDGES];		// Timer1 timestamps of the falling edges
+
+/*
+ * Stop capturing and release the sensor, from both interrupt handlers.
+ */
+static void DHT22_Stop(void){
+	TIMER_STOP
+	ICP_DISABLE_INTERRUPT
+	SET_PIN_OUTPUT(DHT22_DDR,DHT22_PIN);
+	PIN_HIGH(DHT22_PORT,DHT22_PIN);
+}
+
+/*
+ * Timer Compare Match interrupt handler
+ *
+ * Host start conditions (Periods P1 and P2) as in DHT22int.c, then the frame timeout.
+ */
+ISR(TIMER_CTC_VECTOR){
+
+	if((state == DHT_HOST_START) && (overflow_cnt < (OVERFLOWS_HOST_START - 1))){
+		overflow_cnt++;
+	}
+	else if(state == DHT_HOST_START){ // 510us have passed, pin high for period P2.
+		PIN_HIGH(DHT22_PORT,DHT22_PIN);
+		overflow_cnt = 0;
+		state = DHT_HOST_PULLUP;
+		TIMER_OCR_REGISTER = 40;
+	}
+	/* P2 has passed. Switch to input and capture the falling edges until the frame is complete
+	   or the timeout fires. */
+	else if(state == DHT_HOST_PULLUP){
+		TIMER_STOP
+		SET_PIN_INPUT(DHT22_DDR,DHT22_PIN);
+		PIN_HIGH(DHT22_PORT,DHT22_PIN); // Pullup.
+		edgeCount = 0;
+		ICP_CLEAR_FLAG // Don't count the edge of our own start condition.
+		ICP_ENABLE_INTERRUPT
+		state = DHT_TRANSFERING;
+		TIMER_OCR_REGISTER = ICP_TIMEOUT_TICKS;
+		TIMER_COUNTER_REGISTER = 0;
+		ICP_TIMEOUT_START
+	}
+	/* Frame is not complete in time, the sensor didn't respond (or stopped in the middle). */
+	else{
+		DHT22_Stop();
+		state = DHT_ERROR_NOT_RESPOND;
+	}
+}
+
+/*
+ * Input capture interrupt handler
+ *
+ * Only stores the timestamp, the width doesn't depend on when this handler runs.
+ */
+ISR(ICP_VECTOR){
+
+	edgeTime[edgeCount] = ICP_REGISTER;
+	if (++edgeCount >= ICP_EDGES){
+		DHT22_Stop();
+		state = DHT_CHECK_CRC;
+	}
+}
+
+/*
+ * Timer1 ticks between two captured edges.
+ */
+static uint8_t DHT22_Width(uint8_t edge){
+	uint8_t from = edgeTime[edge - 1];
+	uint8_t to = edgeTime[edge];
+
+	if (to < from){ // Timer1 wrapped at TOP
+		return to + (SSD_TICKS_PER_DIGIT - from);
+	}
+	return to - from;
+}
+
+/*
+ * DHT22_STATE_t DHT22_CheckStatus(DHT22_DATA_t* data)
+ *
+ * Same as in DHT22int.c. The captured frame is decoded here:
+ *    DHT_ERROR_NOT_RESPOND: also if the response (P3 + P4) is not ~160us.
+ *    DHT_ERROR_CHECKSUM: also if any bit has an invalid width.
+ */
+DHT22_STATE_t DHT22_CheckStatus(DHT22_DATA_t* data){
+	uint8_t bytes[5] = {0, 0, 0, 0, 0};
+	uint8_t i, width;
+	uint16_t rawHumidity, rawTemperature;
+
+	if (state != DHT_CHECK_CRC){
+		return state;
+	}
+
+	/* P3 + P4, 80us + 80us */
+	width = DHT22_Width(1);
+	if ((width <= ICP_US(100)) || (width > ICP_US(200))){
+		state = DHT_ERROR_NOT_RESPOND;
+		return state;
+	}
+
+	/* P5, same limits as DHT22int.c: 50..110us is 0, 110..160us is 1 */
+	for (i = 0; i < DHT22_DATA_BIT_COUNT; i++){
+		width = DHT22_Width(i + 2);
+		if ((width <= ICP_US(50)) || (width > ICP_US(160))){
+			state = DHT_ERROR_CHECKSUM;
+			return state;
+		}
+		bytes[i >> 3] <<= 1;
+		if (width > ICP_US(110)){
+			bytes[i >> 3] |= 1;
+		}
+	}
+
+	if (bytes[4] != (uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3])){
+		state = DHT_ERROR_CHECKSUM;
+		return state;
+	}
+
+	rawHumidity = ((uint16_t)bytes[0] << 8) | bytes[1];
+	rawTemperature = ((uint16_t)bytes[2] << 8) | bytes[3];
+	data->humidity_integral = (uint8_t)(rawHumidity / 10);
+	data->humidity_decimal = (uint8_t)(rawHumidity % 10);
+	if (rawTemperature & 0x8000){ // Sign bit, not two's complement
+		rawTemperature &= 0x7FFF;
+		data->temperature_integral = (int8_t)(rawTemperature / 10) * -1;
+	} else {
+		data->temperature_integral = (int8_t)(rawTemperature / 10);
+	}
+	data->temperature_decimal = (uint8_t)(rawTemperature % 10);
+	state = DHT_DATA_READY;
+	return state;
+}
+
+/*
+ * void DHT22_Init(void)
+ *
+ * Call it after ssdInit(), SSD_TIMER_START overwrites the capture settings in TCCR1B.
+ */
+void DHT22_Init(void){
+
+	DHT22_DDR |= (1 << DHT22_PIN);
+	PIN_HIGH(DHT22_PORT,DHT22_PIN);
+
+	TIMER_SETUP_CTC
+	TIMER_ENABLE_CTC_INTERRUPT
+	TIMER_STOP
+
+	ICP_DISABLE_INTERRUPT
+	ICP_SETUP
+
+	state = DHT_STOPPED;
+}
+
+/*
+ * DHT22_STATE_t DHT22_StartReading(void)
+ *
+ * Same as in DHT22int.c.
+ */
+DHT22_STATE_t DHT22_StartReading(void){
+
+	if (state == DHT_STOPPED || state == DHT_DATA_READY || state == DHT_ERROR_CHECKSUM || state == DHT_ERROR_NOT_RESPOND){
+		overflow_cnt = 0;
+		ICP_DISABLE_INTERRUPT
+		DHT22_DDR |= (1 << DHT22_PIN);
+		PIN_LOW(DHT22_PORT,DHT22_PIN); // Start condition (P1).
+		TIMER_OCR_REGISTER = 255;
+		TIMER_COUNTER_REGISTER = 0;
+		state = DHT_HOST_START;
+		TIMER_START
+		return DHT_STARTED;
+	}
+	else{
+		return DHT_BUSY;
+	}
+}
+
+#endif // DHT22_BACKEND == DHT22_ICP
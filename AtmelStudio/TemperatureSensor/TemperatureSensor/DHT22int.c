@@ -101,6 +101,8 @@
 
 #include "DHT22int_4313.h"
 
+#if DHT22_BACKEND == DHT22_INT0 // rludvik: otherwise DHT22icp.c is compiled
+
 /* Global variables for this file */
 DHT22_STATE_t state;
 uint8_t overflow_cnt = 0;
@@ -352,4 +354,6 @@ DHT22_STATE_t DHT22_StartReading(void){
 		return DHT_BUSY; // If state machine is busy, return this value.
 	}
 	
-} // end DHT22_StartReading
\ No newline at end of file
+} // end DHT22_StartReading
+
+#endif // DHT22_BACKEND == DHT22_INT0
@@ -49,6 +49,16 @@
 #define OVERFLOWS_HOST_START 2 // How many times a timer overflow is used to generate Period P1.
 #define DHT22_DATA_BIT_COUNT 40 // Number of bits that the sensor send.
 
+// rludvik: only the INT0 backend (DHT22int.c) on the ATmega328P. The input capture backend (DHT22icp.c,
+// see DHT22int_4313.h) needs the ICP1 pin, which is PB0 here and drives segment G of the display
+// (the whole PORTB is the segment port, ssdGlyphs.h). It is for the ATtiny4313 board, ICP1 is PD6 there.
+#define DHT22_INT0 0
+#define DHT22_ICP 1
+#define DHT22_BACKEND DHT22_INT0
+#if DHT22_BACKEND != DHT22_INT0
+#error "ICP1 (PB0) is a segment pin on the ATmega328P board"
+#endif
+
 /* Macros: */
 #define PIN_LOW(port,pin) port &= ~(1<<pin)
 #define PIN_HIGH(port,pin) port |= (1<<pin)
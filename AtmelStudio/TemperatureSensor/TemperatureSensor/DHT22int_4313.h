@@ -50,6 +50,15 @@
 #define OVERFLOWS_HOST_START 2 // How many times a timer overflow is used to generate Period P1.
 #define DHT22_DATA_BIT_COUNT 40 // Number of bits that the sensor send.
 
+// rludvik: two backends, only the selected one is compiled
+//   DHT22_INT0 - DHT22int.c, pulse widths measured with INT0 + 8-bit Timer0 (pin PD2)
+//   DHT22_ICP  - DHT22icp.c, falling edges timestamped by the Timer1 input capture unit (pin ICP1 = PD6),
+//                decoded after the frame. Timer0 only generates the host start and the timeout.
+//                The display ISRs can't move the edges, so this is the default. The sensor is on PD6.
+#define DHT22_INT0 0
+#define DHT22_ICP 1
+#define DHT22_BACKEND DHT22_ICP
+
 /* Macros: */
 #define PIN_LOW(port,pin) port &= ~(1<<pin)
 #define PIN_HIGH(port,pin) port |= (1<<pin)
@@ -59,7 +68,12 @@
 
 /* Pin definition (change accordingly)
    The pin must be a INT pin. Pin Change Interrupt is not sopported yet. */
+// rludvik attiny4313
+#if DHT22_BACKEND == DHT22_ICP
+#define DHT22_PIN PIND6 // ICP1 (PB0 on ATmega328P)
+#else
 #define DHT22_PIN PIND2 // INT0
+#endif
 #define DHT22_DDR DDRD
 #define DHT22_PORT PORTD
 
@@ -99,7 +113,7 @@ occurs between TCNT2 and OCR2A, and then counter (TCNT2) is cleared.
 */
 // rludvik attiny4313
 //#define TIMER_ENABLE_CTC_INTERRUPT		TIMSK2 = (1 << OCIE2A);  // Code to enable Compare Match Interrupt
-#define TIMER_ENABLE_CTC_INTERRUPT		TIMSK = (1 << OCIE0A);  // Code to enable Compare Match Interrupt
+#define TIMER_ENABLE_CTC_INTERRUPT		TIMSK |= (1 << OCIE0A);  // Code to enable Compare Match Interrupt (TIMSK is shared with the display timer)
 
 // rludvik attiny4313
 //#define TIMER_OCR_REGISTER				OCR2A			// Timer output compare register.
@@ -144,6 +158,26 @@ occurs between TCNT2 and OCR2A, and then counter (TCNT2) is cleared.
 #define TIMER_CTC_VECTOR				TIMER0_COMPA_vect
 #define EXT_INTERRUPT_VECTOR			INT0_vect
 
+/* rludvik: input capture backend (DHT22icp.c)
+   Timer1 belongs to the display (ssd.c): CTC mode, 1 MHz / 8 = 8us tick, TOP = SSD_TICKS_PER_DIGIT - 1.
+   It is not reconfigured, the capture unit just latches TCNT1 at each falling edge. TOP fits in 8 bits,
+   so only ICR1L is stored. Reading it uses the 16-bit TEMP register, so 16-bit Timer1 registers must be written
+   with interrupts disabled (see ssdSetBrightness()). DHT22_Init() must be called after ssdInit(). */
+//#define ICP_ENABLE_INTERRUPT			TIMSK1 |= (1 << ICIE1);
+#define ICP_ENABLE_INTERRUPT			TIMSK |= (1 << ICIE1);  // Code to enable Input Capture Interrupt (TIMSK is shared with the display timer)
+//#define ICP_DISABLE_INTERRUPT			TIMSK1 &= ~(1 << ICIE1);
+#define ICP_DISABLE_INTERRUPT			TIMSK &= ~(1 << ICIE1); // Code to disable Input Capture Interrupt
+#define ICP_SETUP						TCCR1B = (TCCR1B & ~(1 << ICES1)) | (1 << ICNC1); // Falling edge, noise canceler on (4 clocks constant delay)
+//#define ICP_CLEAR_FLAG				TIFR1 = (1 << ICF1);
+#define ICP_CLEAR_FLAG					TIFR = (1 << ICF1);     // Written, not ORed: |= would also clear pending display timer flags
+#define ICP_REGISTER					ICR1L			// Low byte of the capture register
+#define ICP_VECTOR						TIMER1_CAPT_vect
+#define ICP_TICK_US						8				// Timer1 tick (set by ssd.c)
+#define ICP_US(us)						((us) / ICP_TICK_US)	// Microseconds to Timer1 ticks
+#define ICP_EDGES						(DHT22_DATA_BIT_COUNT + 2)	// Response start, first bit start and the end of every bit
+#define ICP_TIMEOUT_START				TCCR0B = (1 << CS01) | (1 << CS00); // Timer0 with 64 prescaler (64us tick) for the frame timeout
+#define ICP_TIMEOUT_TICKS				125				// 125 x 64us = 8 ms, the frame takes ~5 ms
+
 /* Typedef of a enumeration of the possible states and error status */
 typedef enum
 {
@@ -22,6 +22,7 @@
  * Make use of DHT22 temperature and humidity sensor and display values on 7-segment display.
  *
  * See lines in DHT22_int_4313.h commented with "//rludvik attiny4313" for changes made!
+ * The DHT22 is on PD6 (ICP1) for the input capture backend, on PD2 (INT0) with DHT22_BACKEND DHT22_INT0.
  *
  * Author : rludvik, September 2022
  * 
@@ -31,7 +32,7 @@
 *	| DHT22 |                | Attiny 4313  |                | 7-segment display |
 *	|       |                |              |                |                   |
 *	|       |                |          PB6 | -------------> | A                 |
-*	|     2 | <------------> | PD2      PB5 | -------------> | B                 |
+*	|     2 | <------------> | PD6      PB5 | -------------> | B                 |
 *	|       |       |        |          PB4 | -------------> | C                 |
 *	|       |      _|_       |          PB3 | -------------> | D                 |
 *	|_______|     |4k7|      |          PB2 | -------------> | E                 |
@@ -65,104 +66,91 @@
 #include <util/delay.h>
 
 #include "DHT22int_4313.h"
+#include "ssd.h"				// Digit select pins (PD0, PD1, PD3), refresh timer and brightness
+#include "ssdGlyphs.h"			// ATtiny4313 wiring (SSD_BOARD_4313), picked in ssd.h
+#include "scheduler.h"			// 1 ms tick comes from the display refresh timer (ssd.c)
 
-#define SegOne 0x01
-#define SegTwo 0x02
-#define SegThree 0x08
-
+#define READ_PERIOD		2000		// DHT22 needs at least 2 s between two readings
+#define SHOW_DELAY		50			// Reading is finished well before that
+
+DHT22_DATA_t sensor_data;
+
+/*
+* Show the result of the reading started in readSensor(). One-shot task.
+*/
+void showReading(void)
+{
+	// Segment bytes for numbers and letters come from the glyph table in flash (ssdGlyphs.h)
+	// frame holds the digits left to right
+	uint8_t frame[SSD_NR_OF_DIGITS];
+	int temp_integral_tens, temp_integral_ones, temp_decimal_tens;
+	DHT22_STATE_t state;
+
+	state = DHT22_CheckStatus(&sensor_data);
+	if (state == DHT_DATA_READY){
+		/* 12.34 -> 12.3 (because we only have 3-digit display basically). D4 will not be used
+			Example:
+				sensor_data.temperature_integral = 12
+				sensor_data.temperature_decima = 34
+			translates to:
+			D3 = 1
+			D2 = 2 + DP
+			D1 = 3
+		*/
+		temp_integral_tens = sensor_data.temperature_integral / 10;
+		temp_integral_ones = sensor_data.temperature_integral % 10;
+		temp_decimal_tens = sensor_data.temperature_decimal / 10;
+		frame[0] = ssdGlyph(temp_integral_tens);
+		frame[1] = SSD_DP(ssdGlyph(temp_integral_ones));
+		frame[2] = ssdGlyph(temp_decimal_tens);
+		ssdSetRaw(frame);
+		// sensor_data.humidity_integral
+		// sensor_data.humidity_decimal
+	}
+	else if (state == DHT_ERROR_CHECKSUM){
+		// Display "CS.E" = CheckSum.Error
+		frame[0] = ssdGlyph(SSD_GLYPH_C);
+		frame[1] = SSD_DP(ssdGlyph(SSD_GLYPH_S));
+		frame[2] = ssdGlyph(SSD_GLYPH_E);
+		ssdSetRaw(frame);
+	}
+	else if (state == DHT_ERROR_NOT_RESPOND){
+		// Display "dG.E" = DataGather.Error
+		frame[0] = ssdGlyph(SSD_GLYPH_D);
+		frame[1] = SSD_DP(ssdGlyph(SSD_GLYPH_G));
+		frame[2] = ssdGlyph(SSD_GLYPH_E);
+		ssdSetRaw(frame);
+	}
+	// Still busy => keep showing the last value
+}
+
+/*
+* Start a new reading every READ_PERIOD ms, the result is shown SHOW_DELAY ms later.
+*/
+void readSensor(void)
+{
+	if (DHT22_StartReading() == DHT_STARTED){
+		schedulerAddTask(showReading, SHOW_DELAY, 0);
+	}
+}
 
 int main(void)
 {
 /*
 * 7-segment display things
+* Display is refreshed from the Timer1 interrupt (ssd.c), which is also the scheduler tick
 */
-
-// Array of chars to display (0..9)
-char seg_code[]={0xc0,0xf9,0xa4,0xb0,0x99,0x92,0x82,0xf8,0x80,0x90};	// "ordinary" numbers
-char seg_code_dp[]={0x40,0x79,0x24,0x30,0x19,0x12,0x02,0x78,0x00,0x10};	// Numbers with DP on
-int temp_integral_tens, temp_integral_ones, temp_decimal_tens;
-DDRB = 0xff;			// Output to 7-segment display
-DDRD |= ~(1<<PIND0);	// Select digit pins
-DDRD |= ~(1<<PIND1);
-DDRD |= ~(1<<PIND3);
+ssdInit();
 
 /*
 * DHT22 + main things
 */
-
-DHT22_STATE_t state;
-DHT22_DATA_t sensor_data;
 DHT22_Init();
+schedulerAddTask(readSensor, 0, READ_PERIOD);
 sei();
 
     while (1) 
     {
-		state = DHT22_StartReading();
-		// Check the state if you want to confirm that the state machine has started.
-		//  In your main loop, check periodically when the data is available and in
-		//  case of available, do something:
-		state = DHT22_CheckStatus(&sensor_data);
-		if (state == DHT_DATA_READY){
-			// Do something with the data.
-			
-		/* 12.34 -> 12.3 (because we only have 3-digit display basically). D4 will not be used
-			Example:
-				sensor_data.temperature_integral = 12
-				sensor_data.temperature_decima = 34
-			translates to:
-			D3 = 1
-			D2 = 2 + DP
-			D1 = 3
-		*/
-			temp_integral_tens = sensor_data.temperature_integral / 10;
-			temp_integral_ones = sensor_data.temperature_integral % 10;
-			PORTD = SegOne;
-			PORTB = seg_code[temp_integral_tens];
-			_delay_ms(1);
-			PORTD = SegTwo;
-			PORTB = seg_code_dp[temp_integral_ones];
-			_delay_ms(1);
-			temp_decimal_tens = sensor_data.temperature_decimal / 10;
-			PORTD = SegThree;
-			PORTB = seg_code[temp_decimal_tens];	
-			_delay_ms(1);
-			// sensor_data.humidity_integral
-			// sensor_data.humidity_decimal
-		}
-		else if (state == DHT_ERROR_CHECKSUM){
-			// Do something if there is a Checksum error
-			// Display "CS.E" = CheckSum.Error
-			// C = 0xC6
-			// S. = 0x12
-			// E = 0x86
-			PORTD = SegThree;
-			PORTB = 0xc6;
-			_delay_ms(1);
-			PORTD = SegTwo;
-			PORTB = 0x12;
-			_delay_ms(1);
-			PORTD = SegOne;
-			PORTB = 0x86;
-			_delay_ms(1);
-			
-		}
-		else if (state == DHT_ERROR_NOT_RESPOND){
-			// Do something if the sensor did not respond
-			// Display "DG.E" = DataGather.Error
-			// D = 0 = 0xc0
-			// G. 6. = 0x02
-			// E = 0x86
-			PORTD = SegThree;
-			PORTB = 0xc0;
-			_delay_ms(1);
-			PORTD = SegTwo;
-			PORTB = 0x02;
-			_delay_ms(1);
-			PORTD = SegOne;
-			PORTB = 0x86;
-			_delay_ms(1);
-		}
-		//_delay_ms(10000);
+		schedulerRun();		// Run the tasks that are due, sleep (idle) in between
     }
 }
-
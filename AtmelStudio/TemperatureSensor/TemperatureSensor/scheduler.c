@@ -0,0 +1,114 @@
+/*
+ * Cooperative task scheduler, see scheduler.h for how to use it.
+ *
+ * Tick counter is 16-bit, so due times are compared as a signed difference
+ * and the wrap-around after ~65 s doesn't matter. Longest delay or period is 32767 ms.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+#include "scheduler.h"
+
+/* One entry in the task table */
+typedef struct
+{
+	SCHEDULER_TASK_t task;		//0 => free slot
+	uint16_t due;				//Tick when the task runs next
+	uint16_t period;			//0 => one-shot, the slot is freed when it runs
+} SCHEDULER_ENTRY_t;
+
+volatile uint16_t schedulerTicks = 0;
+SCHEDULER_ENTRY_t schedulerTasks[SCHEDULER_MAX_TASKS];
+
+/*
+ * Ticks (ms) since start. The 16-bit counter is read with interrupts off,
+ * so the ISR can't change it between the two bytes.
+ */
+uint16_t schedulerMillis(void) {
+	uint16_t ticks;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ticks = schedulerTicks;
+	}
+	return ticks;
+}
+
+/*
+ * Register the task to run after delay ms and then every period ms (period 0 => only once).
+ * Returns the task id for schedulerRemoveTask() or SCHEDULER_NO_TASK if the table is full.
+ * Can be called from a task, also to re-arm a one-shot task.
+ */
+int8_t schedulerAddTask(SCHEDULER_TASK_t task, uint16_t delay, uint16_t period) {
+	int8_t i;
+
+	for (i = 0; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		if (schedulerTasks[i].task == 0)
+		{
+			schedulerTasks[i].due = schedulerMillis() + delay;
+			schedulerTasks[i].period = period;
+			schedulerTasks[i].task = task;
+			return i;
+		}
+	}
+	return SCHEDULER_NO_TASK;
+}
+
+/* Remove the task, it won't run anymore */
+void schedulerRemoveTask(int8_t taskId) {
+	if ((taskId >= 0) && (taskId < SCHEDULER_MAX_TASKS))
+	{
+		schedulerTasks[taskId].task = 0;
+	}
+}
+
+/*
+ * Run all tasks that are due, call it forever from the main loop.
+ * Periodic tasks keep their rate (due += period). If a task was late for more than
+ * a period (something blocked), it runs once and continues from now, no catching up.
+ * If nothing was due, sleep in idle mode until the next interrupt. Timers and UART keep running.
+ */
+void schedulerRun(void) {
+	uint8_t i, ran = 0;
+	uint16_t now = schedulerMillis();
+	SCHEDULER_TASK_t task;
+
+	for (i = 0; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		task = schedulerTasks[i].task;
+		if ((task != 0) && ((int16_t)(now - schedulerTasks[i].due) >= 0))
+		{
+			if (schedulerTasks[i].period == 0)
+			{
+				schedulerTasks[i].task = 0;			//One-shot, free the slot before it runs
+			}
+			else
+			{
+				schedulerTasks[i].due += schedulerTasks[i].period;
+				if ((int16_t)(now - schedulerTasks[i].due) >= 0)
+				{
+					schedulerTasks[i].due = now + schedulerTasks[i].period;
+				}
+			}
+			task();
+			ran = 1;
+		}
+	}
+
+	if (!ran)
+	{
+		cli();
+		if (schedulerTicks == now)					//No tick since we looked, safe to sleep
+		{
+			set_sleep_mode(SLEEP_MODE_IDLE);
+			sleep_enable();
+			sei();									//sei + sleep are executed together, the tick can't slip in between
+			sleep_cpu();
+			sleep_disable();
+		}
+		sei();
+	}
+}
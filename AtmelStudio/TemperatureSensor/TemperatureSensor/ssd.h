@@ -0,0 +1,77 @@
+#ifndef SSD_H
+#define SSD_H
+
+/*
+ * 7-segment display for Attiny2313/4313 and ATmega328P
+ *
+ * Author      : Robert Ludvik
+ * Description : 7-segment Library for harvested 3-digit SSD
+ *
+ * The display is refreshed from the timer compare interrupt, one digit per tick.
+ * ssdSetNumber() and ssdSetRaw() only fill the frame buffer and return immediately.
+ * Brightness is software PWM: the second compare channel switches the segments off
+ * after the on-time of the digit, the rest of the tick the digit is blank.
+ *
+ * HOW TO USE:
+ *		ssdInit();
+ *		sei();
+ *		ssdSetNumber(248);
+ *		ssdSetBrightness(7);		// 0 (dim garage) .. SSD_BRIGHTNESS_LEVELS - 1 (bright room)
+ */
+
+#include <stdio.h>
+#include <avr/io.h>
+
+//functions
+extern void ssdInit(void);
+extern void ssdSetNumber(int numToDisplay);
+extern void ssdSetRaw(const uint8_t *segments);
+extern void ssdSetBrightness(uint8_t level);
+
+//Registers used
+#define DIGIT_CONTROL_DDR   DDRD
+#define DIGIT_CONTROL_PORT  PORTD
+#define DATA_DDR            DDRB
+#define DATA_PORT           PORTB
+
+#define SegOne   0x01		// Digit select pins on DIGIT_CONTROL_DDR
+#define SegTwo   0x02
+#define SegThree 0x08		// PD2 is the DHT22 data pin
+
+#define SSD_NR_OF_DIGITS	3
+#define SSD_NUMBER_LIMIT	1000		// 10^SSD_NR_OF_DIGITS
+#define SSD_DIGIT_MASK		(SegOne | SegTwo | SegThree)
+#define SSD_BLANK			0xff		// Common anode => all segments off
+
+#define SSD_BRIGHTNESS_LEVELS	16		// ssdSetBrightness() levels, the last one is full brightness
+#define SSD_BLANK_TICKS			4		// Segments stay off at least this long before the next digit is selected (no ghosting)
+
+/* Board profile, picked by the MCU the project is built for (-mmcu), so main.c and ssd.c always agree.
+ * Refresh timer is the 16-bit Timer1 in CTC mode (Timer0/Timer2 are used by DHT22int.c).
+ * Both profiles tick at 125 kHz => 125 ticks = 1 ms per digit, 3 ms per frame (333 Hz), 1 ms scheduler tick.
+ */
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__)
+/* ATmega328P at 8 MHz (main.c): 8 MHz / 64 prescaler, timer interrupts are in TIMSK1 */
+#define SSD_TIMER_SETUP_CTC				TCCR1A = 0;					// Code to configure the timer in CTC mode (WGM12 is in TCCR1B).
+#define SSD_TIMER_ENABLE_CTC_INTERRUPT	TIMSK1 |= (1 << OCIE1A);	// Code to enable Compare Match Interrupt
+#define SSD_TIMER_START					TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10);	// Code to start timer in CTC mode with 64 prescaler
+#define SSD_TIMER_ENABLE_BLANK_INTERRUPT	TIMSK1 |= (1 << OCIE1B);	// Code to enable Compare Match B Interrupt
+#define SSD_BOARD						SSD_BOARD_328P				// A on PB6 ... G on PB0 (ssdGlyphs.h)
+#else
+/* ATtiny4313 at 1 MHz (main-4313.c): 1 MHz / 8 prescaler, timer interrupts are in TIMSK */
+#define SSD_TIMER_SETUP_CTC				TCCR1A = 0;					// Code to configure the timer in CTC mode (WGM12 is in TCCR1B).
+#define SSD_TIMER_ENABLE_CTC_INTERRUPT	TIMSK |= (1 << OCIE1A);		// Code to enable Compare Match Interrupt
+#define SSD_TIMER_START					TCCR1B = (1 << WGM12) | (1 << CS11);	// Code to start timer in CTC mode with 8 prescaler
+#define SSD_TIMER_ENABLE_BLANK_INTERRUPT	TIMSK |= (1 << OCIE1B);	// Code to enable Compare Match B Interrupt
+#define SSD_BOARD						SSD_BOARD_4313				// A on PB0 ... G on PB6 (ssdGlyphs.h)
+#endif
+
+#define SSD_TIMER_OCR_REGISTER			OCR1A						// Timer output compare register.
+#define SSD_TIMER_CTC_VECTOR			TIMER1_COMPA_vect
+#define SSD_TICKS_PER_DIGIT				125
+
+/* Second compare channel of the same timer ends the on-time of the digit (brightness) */
+#define SSD_TIMER_BLANK_OCR_REGISTER		OCR1B						// Timer output compare register B.
+#define SSD_TIMER_BLANK_VECTOR				TIMER1_COMPB_vect
+
+#endif      //SSD_H
@@ -6,16 +6,20 @@
  */ 
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
 
 #include "ssd.h"				//Include my own header library
 
 
 int main(void)
 {
+	ssdInit();					//Display is refreshed from the timer interrupt
+	sei();
+	ssdSetNumber(248);
+
     /* Replace with your application code */
     while (1) 
     {
-		ssdDisplay(248);
     }
 }
 
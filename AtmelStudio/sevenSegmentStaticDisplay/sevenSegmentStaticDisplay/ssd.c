@@ -0,0 +1,182 @@
+/*
+ * sevenSegmentStaticDisplay.c
+ *
+ * First C program! Code snippet was taken from internetz.
+ * 7-segment display was harvested form old darts board and "reverse engineered".
+ * See photos for more info.
+ * Reason for doing it: son bought ATtiny 4313, which is not supported in Arduino,
+ * so I decided to make a use of it in some other way. I bought USBtinyISP programmer
+ * and made it happen.
+ *
+ * I used Atmel Studio for coding and building. Because I didn't manage to make USBTiny to work
+ * in virtual Windoze machine, I use avrdude on Linux host to flash HEX file to uC like this:
+ *
+ * $ sudo avrdude -v -v -v -c usbtiny -p t4313 -U flash:w:sevenSegmentStaticDisplay.hex:i
+ *
+ * ATtiny 4313 pinout: https://colinkeef.com/images/attiny_x313/attiny_x313_pinout.jpg
+ *
+ * Created: 8/29/2022 4:45:29 AM
+ * Author : rludvik
+ *
+ * Schematic:
+			  ______________                  ___________________
+			 | Attiny 4313  |                | 7-segment display |
+			 |              |                |                   |
+			 |          PB7 | -------------> | dp                |
+			 |          PB6 | -------------> | A                 |
+			 |          PB5 | -------------> | B                 |
+			 |          PB4 | -------------> | C                 |
+			 |          PB3 | -------------> | D                 |
+			 |          PB2 | -------------> | E                 |
+			 |          PB1 | -------------> | F                 |
+			 |          PB0 | -------------> | G                 |
+			 |              |                |                   |
+			 |              |                |                   |
+			 |          PD2 | -------------> | D1                |
+			 |          PD1 | -------------> | D2                |
+			 |          PD0 | -------------> | D3                |
+			 |______________|                |___________________|
+ *
+ */
+
+#define F_CPU 1000000UL		// MCU frequency at 1 MHz
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "ssd.h"
+#include "ssdGlyphs.h"
+
+// Digit select value for each position, left to right
+const uint8_t ssdDigitSelect[SSD_NR_OF_DIGITS] = {SegOne, SegTwo, SegThree, SegFour};
+
+// Powers of ten for each position, used instead of division
+const uint16_t ssdPowersOfTen[SSD_NR_OF_DIGITS] = {1000, 100, 10, 1};
+
+// Frame buffer with segment bytes, ready to be written to DATA_PORT
+volatile uint8_t ssdFrameBuffer[SSD_NR_OF_DIGITS] = {SSD_BLANK, SSD_BLANK, SSD_BLANK, SSD_BLANK};
+
+// Glyph cache. Filled only when the value changes, copied to the frame buffer by the ISR
+volatile uint8_t ssdGlyphs[SSD_NR_OF_DIGITS];
+volatile uint8_t ssdDirty = 0;			// 1 => ssdGlyphs holds a new frame
+uint16_t ssdValue = 0;					// Last number converted to ssdGlyphs
+uint8_t ssdValueValid = 0;				// 0 => ssdGlyphs doesn't hold ssdValue (raw or nothing)
+
+/*
+ * Set up the ports and start the refresh timer.
+ * Interrupts have to be enabled (sei) by the caller.
+ */
+void ssdInit(void) {
+	//Set registers as output
+	DIGIT_CONTROL_DDR |= SSD_DIGIT_MASK;
+	DATA_DDR = 0xff;
+	DATA_PORT = SSD_BLANK;
+
+	SSD_TIMER_SETUP_CTC
+	SSD_TIMER_OCR_REGISTER = SSD_TICKS_PER_DIGIT - 1;
+	ssdSetBrightness(SSD_BRIGHTNESS_LEVELS - 1);
+	SSD_TIMER_ENABLE_CTC_INTERRUPT
+	SSD_TIMER_ENABLE_BLANK_INTERRUPT
+	SSD_TIMER_START
+}
+
+/*
+ * Set the on-time of every digit, 0 is the dimmest and SSD_BRIGHTNESS_LEVELS - 1 is full brightness.
+ * Even at full brightness the last SSD_BLANK_TICKS of the tick are blank, so the
+ * segments are never on while the digit select changes.
+ */
+void ssdSetBrightness(uint8_t level) {
+	if (level >= SSD_BRIGHTNESS_LEVELS)
+	{
+		level = SSD_BRIGHTNESS_LEVELS - 1;
+	}
+	SSD_TIMER_BLANK_OCR_REGISTER = ((uint16_t)(SSD_TICKS_PER_DIGIT - SSD_BLANK_TICKS) * (level + 1)) / SSD_BRIGHTNESS_LEVELS;
+}
+
+/*
+ * Convert the number to segment bytes and hand them over to the ISR.
+ * Only the last SSD_NR_OF_DIGITS digits are shown. Returns immediately.
+ * If the number didn't change, nothing is done, so it can be called on every loop.
+ * Digits are found by subtracting powers of ten, no (software) division on AVR.
+ */
+void ssdSetNumber(int numToDisplay) {
+	uint16_t num = numToDisplay;
+	uint8_t i, temp;
+
+	if (ssdValueValid && (num == ssdValue))
+	{
+		return;
+	}
+	ssdValue = num;
+
+	while (num >= SSD_NUMBER_LIMIT)		// Drop the digits we can't show
+	{
+		num -= SSD_NUMBER_LIMIT;
+	}
+
+	ssdDirty = 0;						// ISR must not latch a half written frame
+	for (i = 0; i < SSD_NR_OF_DIGITS; i++)
+	{
+		temp = 0;
+		while (num >= ssdPowersOfTen[i])
+		{
+			num -= ssdPowersOfTen[i];
+			temp++;
+		}
+		ssdGlyphs[i] = ssdGlyph(temp);
+	}
+	ssdValueValid = 1;
+	ssdDirty = 1;
+}
+
+/*
+ * Put raw segment bytes (one per digit, left to right) to the frame buffer.
+ * Used for letters and other things that are not numbers.
+ */
+void ssdSetRaw(const uint8_t *segments) {
+	uint8_t i;
+
+	ssdDirty = 0;						// ISR must not latch a half written frame
+	for (i = 0; i < SSD_NR_OF_DIGITS; i++)
+	{
+		ssdGlyphs[i] = segments[i];
+	}
+	ssdValueValid = 0;
+	ssdDirty = 1;
+}
+
+/*
+ * Refresh the display, one digit per compare match.
+ * Nothing is calculated here, the frame buffer already holds the segment bytes.
+ */
+ISR(SSD_TIMER_CTC_VECTOR)
+{
+	static uint8_t digit = 0;
+	uint8_t i;
+
+	if ((digit == 0) && ssdDirty)		// Take the new frame only at the start of the frame
+	{
+		for (i = 0; i < SSD_NR_OF_DIGITS; i++)
+		{
+			ssdFrameBuffer[i] = ssdGlyphs[i];
+		}
+		ssdDirty = 0;
+	}
+
+	DATA_PORT = SSD_BLANK;																	// Segments off while switching digits
+	DIGIT_CONTROL_PORT = (DIGIT_CONTROL_PORT & ~SSD_DIGIT_MASK) | ssdDigitSelect[digit];	// Select digit
+	DATA_PORT = ssdFrameBuffer[digit];														// Display corresponding char from buffer
+
+	digit++;
+	if (digit >= SSD_NR_OF_DIGITS)
+	{
+		digit = 0;
+	}
+}
+
+/*
+ * End of the on-time of the digit. Segments stay off until the next digit is selected.
+ */
+ISR(SSD_TIMER_BLANK_VECTOR)
+{
+	DATA_PORT = SSD_BLANK;
+}
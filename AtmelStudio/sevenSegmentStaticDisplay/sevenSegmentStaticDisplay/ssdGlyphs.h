@@ -0,0 +1,121 @@
+#ifndef SSDGLYPHS_H
+#define SSDGLYPHS_H
+
+/*
+ * Glyph table for the harvested 7-segment display (common anode => LOW lights up the segment)
+ *
+ * Author      : Robert Ludvik
+ * Description : One set of glyphs (digits, hex A..F, letters for error codes) kept in flash.
+ *               The board profile says which PORTB bit drives which segment, so the same
+ *               table gives 0xc0.. on the ATtiny4313 wiring and 0x81.. on the ATmega328p wiring.
+ *
+ * HOW TO USE:
+ *		#define SSD_BOARD SSD_BOARD_328P		// before the include, default is SSD_BOARD_4313
+ *		#include "ssdGlyphs.h"
+ *
+ *		PORTB = ssdGlyph(7);					// 7
+ *		PORTB = SSD_DP(ssdGlyph(SSD_GLYPH_S));	// S.
+ *
+ *    ___A___
+ *   |       |
+ *   F       B
+ *   |___G___|
+ *   |       |
+ *   E       C
+ *   |___D___|  .DP
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+/* Board profiles */
+#define SSD_BOARD_4313		1		// A on PB0, B on PB1 ... G on PB6, DP on PB7
+#define SSD_BOARD_328P		2		// A on PB6, B on PB5 ... G on PB0, DP on PB7
+
+#ifndef SSD_BOARD
+#define SSD_BOARD			SSD_BOARD_4313
+#endif
+
+#if SSD_BOARD == SSD_BOARD_4313
+	#define SSD_SEG_A		0
+	#define SSD_SEG_B		1
+	#define SSD_SEG_C		2
+	#define SSD_SEG_D		3
+	#define SSD_SEG_E		4
+	#define SSD_SEG_F		5
+	#define SSD_SEG_G		6
+	#define SSD_SEG_DP		7
+#elif SSD_BOARD == SSD_BOARD_328P
+	#define SSD_SEG_A		6
+	#define SSD_SEG_B		5
+	#define SSD_SEG_C		4
+	#define SSD_SEG_D		3
+	#define SSD_SEG_E		2
+	#define SSD_SEG_F		1
+	#define SSD_SEG_G		0
+	#define SSD_SEG_DP		7
+#else
+	#error "Unknown SSD_BOARD"
+#endif
+
+/* Segment byte for the glyph, 1 means the segment is on. DP is off. */
+#define SSD_SEGMENTS(a, b, c, d, e, f, g)	((uint8_t)~(((a) << SSD_SEG_A) | ((b) << SSD_SEG_B) | ((c) << SSD_SEG_C) | \
+											((d) << SSD_SEG_D) | ((e) << SSD_SEG_E) | ((f) << SSD_SEG_F) | ((g) << SSD_SEG_G)))
+
+/* Switch on the decimal point on a segment byte */
+#define SSD_DP(segments)					((uint8_t)((segments) & ~(1 << SSD_SEG_DP)))
+
+/* Glyph indexes for letters. Digits and hex A..F have their own value as index (0..15) */
+#define SSD_GLYPH_A			10
+#define SSD_GLYPH_B			11
+#define SSD_GLYPH_C			12
+#define SSD_GLYPH_D			13
+#define SSD_GLYPH_E			14
+#define SSD_GLYPH_F			15
+#define SSD_GLYPH_G			16
+#define SSD_GLYPH_H			17
+#define SSD_GLYPH_L			18
+#define SSD_GLYPH_N			19
+#define SSD_GLYPH_O			20
+#define SSD_GLYPH_P			21
+#define SSD_GLYPH_R			22
+#define SSD_GLYPH_S			23
+#define SSD_GLYPH_U			24
+#define SSD_GLYPH_MINUS		25
+#define SSD_GLYPH_BLANK		26
+
+static const uint8_t ssd_glyphs[] PROGMEM = {
+//					 A  B  C  D  E  F  G
+	SSD_SEGMENTS(1, 1, 1, 1, 1, 1, 0),	// 0
+	SSD_SEGMENTS(0, 1, 1, 0, 0, 0, 0),	// 1
+	SSD_SEGMENTS(1, 1, 0, 1, 1, 0, 1),	// 2
+	SSD_SEGMENTS(1, 1, 1, 1, 0, 0, 1),	// 3
+	SSD_SEGMENTS(0, 1, 1, 0, 0, 1, 1),	// 4
+	SSD_SEGMENTS(1, 0, 1, 1, 0, 1, 1),	// 5
+	SSD_SEGMENTS(1, 0, 1, 1, 1, 1, 1),	// 6
+	SSD_SEGMENTS(1, 1, 1, 0, 0, 0, 0),	// 7
+	SSD_SEGMENTS(1, 1, 1, 1, 1, 1, 1),	// 8
+	SSD_SEGMENTS(1, 1, 1, 1, 0, 1, 1),	// 9
+	SSD_SEGMENTS(1, 1, 1, 0, 1, 1, 1),	// A
+	SSD_SEGMENTS(0, 0, 1, 1, 1, 1, 1),	// b
+	SSD_SEGMENTS(1, 0, 0, 1, 1, 1, 0),	// C
+	SSD_SEGMENTS(0, 1, 1, 1, 1, 0, 1),	// d
+	SSD_SEGMENTS(1, 0, 0, 1, 1, 1, 1),	// E
+	SSD_SEGMENTS(1, 0, 0, 0, 1, 1, 1),	// F
+	SSD_SEGMENTS(1, 0, 1, 1, 1, 1, 0),	// G
+	SSD_SEGMENTS(0, 1, 1, 0, 1, 1, 1),	// H
+	SSD_SEGMENTS(0, 0, 0, 1, 1, 1, 0),	// L
+	SSD_SEGMENTS(0, 0, 1, 0, 1, 0, 1),	// n
+	SSD_SEGMENTS(0, 0, 1, 1, 1, 0, 1),	// o
+	SSD_SEGMENTS(1, 1, 0, 0, 1, 1, 1),	// P
+	SSD_SEGMENTS(0, 0, 0, 0, 1, 0, 1),	// r
+	SSD_SEGMENTS(1, 0, 1, 1, 0, 1, 1),	// S
+	SSD_SEGMENTS(0, 1, 1, 1, 1, 1, 0),	// U
+	SSD_SEGMENTS(0, 0, 0, 0, 0, 0, 1),	// -
+	SSD_SEGMENTS(0, 0, 0, 0, 0, 0, 0),	// blank
+};
+
+/* Read the segment byte for the glyph index from flash */
+#define ssdGlyph(index)		pgm_read_byte(&ssd_glyphs[(index)])
+
+#endif      //SSDGLYPHS_H
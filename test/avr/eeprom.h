@@ -0,0 +1,26 @@
+/*
+ * Host stand-in for <avr/eeprom.h>
+ *
+ * EEMEM variables are ordinary RAM. Every byte that really changes is counted in
+ * hostEepromWrites, so a test can tell how often the firmware wears the EEPROM.
+ */
+
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EEMEM
+
+extern uint32_t hostEepromWrites;
+extern void eeprom_read_block(void *dst, const void *src, size_t n);
+extern void eeprom_update_block(const void *src, void *dst, size_t n);
+extern uint8_t eeprom_read_byte(const uint8_t *p);
+extern void eeprom_update_byte(uint8_t *p, uint8_t value);
+extern void eeprom_write_byte(uint8_t *p, uint8_t value);
+
+/* A write is never in progress on the PC */
+#define eeprom_is_ready()	1
+
+#endif      //HOST_AVR_EEPROM_H
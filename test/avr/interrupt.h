@@ -0,0 +1,19 @@
+/*
+ * Host stand-in for <avr/interrupt.h>
+ *
+ * An ISR is an ordinary function with the vector's name, a test "fires" the
+ * interrupt by calling it. sei()/cli() only keep the I flag in SREG.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector, ...)	void vector(void); void vector(void)
+#define EMPTY_INTERRUPT(vector)	void vector(void); void vector(void) {}
+#define ISR_ALIAS(vector, target)
+#define sei()				(SREG |= 0x80)
+#define cli()				(SREG &= (uint8_t)~0x80)
+
+#endif      //HOST_AVR_INTERRUPT_H
@@ -0,0 +1,204 @@
+/*
+ * Host stand-in for <avr/io.h>
+ *
+ * I/O registers are plain variables (defined in host.c), so the firmware sources
+ * compile with gcc on the PC and the tests can look at the ports or set the inputs.
+ * Bit numbers are the ATmega328P ones. ATtiny4313-only registers (TIMSK, GIMSK, ...)
+ * are there too, with the 328P numbers of the same bits, they are only written.
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#define _BV(bit)	(1 << (bit))
+
+/* 8-bit registers */
+#define HOST_REGS8(X) \
+	X(PINA) X(DDRA) X(PORTA) X(PINB) X(DDRB) X(PORTB) X(PINC) X(DDRC) X(PORTC) X(PIND) X(DDRD) X(PORTD) \
+	X(TCCR0A) X(TCCR0B) X(TCNT0) X(OCR0A) X(OCR0B) X(TIMSK0) X(TIFR0) \
+	X(TCCR1A) X(TCCR1B) X(TCCR1C) X(TIMSK1) X(TIFR1) X(ICR1L) X(ICR1H) \
+	X(TCCR2A) X(TCCR2B) X(TCNT2) X(OCR2A) X(OCR2B) X(TIMSK2) X(TIFR2) \
+	X(TIMSK) X(TIFR) X(GIMSK) X(GIFR) X(MCUCR) X(PCMSK) \
+	X(EICRA) X(EIMSK) X(EIFR) X(PCICR) X(PCIFR) X(PCMSK0) X(PCMSK1) X(PCMSK2) \
+	X(ADMUX) X(ADCSRA) X(ADCSRB) X(ADCH) X(ADCL) X(DIDR0) X(PRR) X(SMCR) X(SREG) \
+	X(UCSR0A) X(UCSR0B) X(UCSR0C) X(UDR0) X(UBRR0H) X(UBRR0L) \
+	X(UCSRA) X(UCSRB) X(UCSRC) X(UDR) X(UBRRH) X(UBRRL) \
+	X(TWBR) X(TWSR) X(TWAR) X(TWDR) X(TWCR) \
+	X(EECR) X(EEDR) X(EEARL) X(EEARH)
+
+/* 16-bit registers */
+#define HOST_REGS16(X) \
+	X(TCNT1) X(OCR1A) X(OCR1B) X(ICR1) X(ADC) X(UBRR0) X(EEAR)
+
+#define HOST_DECLARE8(r)	extern volatile uint8_t r;
+#define HOST_DECLARE16(r)	extern volatile uint16_t r;
+HOST_REGS8(HOST_DECLARE8)
+HOST_REGS16(HOST_DECLARE16)
+
+/* Port bits */
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define PIND0 0
+#define PIND2 2
+#define PIND6 6
+#define PORTD0 0
+#define PORTD3 3
+
+/* Timer0 */
+#define WGM00 0
+#define WGM01 1
+#define COM0B0 4
+#define COM0B1 5
+#define COM0A0 6
+#define COM0A1 7
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM02 3
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+#define OCF0A 1
+
+/* Timer1 */
+#define WGM10 0
+#define WGM11 1
+#define COM1A0 6
+#define COM1A1 7
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define WGM13 4
+#define ICES1 6
+#define ICNC1 7
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define ICIE1 5
+#define OCF1A 1
+#define OCF1B 2
+#define ICF1 5
+
+/* Timer2 */
+#define WGM20 0
+#define WGM21 1
+#define COM2B0 4
+#define COM2B1 5
+#define COM2A0 6
+#define COM2A1 7
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM22 3
+#define TOIE2 0
+#define OCIE2A 1
+#define OCIE2B 2
+#define OCF2A 1
+
+/* External and pin change interrupts */
+#define ISC00 0
+#define ISC01 1
+#define ISC10 2
+#define ISC11 3
+#define INT0 0
+#define INT1 1
+#define INTF0 0
+#define INTF1 1
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+#define PCINT0 0
+#define PCINT7 7
+#define PCINT16 0
+#define PCINT23 7
+
+/* ADC, power reduction */
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+#define ADLAR 5
+#define REFS0 6
+#define REFS1 7
+#define ADTS0 0
+#define ADTS1 1
+#define ADTS2 2
+#define PRADC 0
+#define PRUSART0 1
+#define PRTIM1 3
+#define PRTIM0 5
+#define PRTIM2 6
+#define PRTWI 7
+
+/* USART */
+#define U2X0 1
+#define UDRE0 5
+#define UDRE 5
+#define TXC0 6
+#define RXC0 7
+#define UCSZ02 2
+#define TXEN0 3
+#define RXEN0 4
+#define UDRIE0 5
+#define TXCIE0 6
+#define RXCIE0 7
+#define UCSZ00 1
+#define UCSZ01 2
+#define USBS0 3
+#define UPM00 4
+#define UPM01 5
+#define UMSEL00 6
+#define UMSEL01 7
+
+/* TWI */
+#define TWIE 0
+#define TWEN 2
+#define TWWC 3
+#define TWSTO 4
+#define TWSTA 5
+#define TWEA 6
+#define TWINT 7
+#define TWPS0 0
+#define TWPS1 1
+
+/* EEPROM */
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+#define EERIE 3
+
+#endif      //HOST_AVR_IO_H
@@ -0,0 +1,24 @@
+/*
+ * Host stand-in for <avr/pgmspace.h>, flash is ordinary memory on the PC.
+ * pgm_read_word() returns the pointed-to type, it also reads function pointers (fsm.c).
+ * Byte reads are counted in hostFlashReads, e.g. glyph table lookups.
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)					(s)
+extern uint32_t hostFlashReads;
+
+#define pgm_read_byte(p)		(hostFlashReads++, *(const uint8_t *)(p))
+#define pgm_read_word(p)		(*(p))
+#define pgm_read_dword(p)		(*(p))
+#define pgm_read_ptr(p)			(*(void * const *)(p))
+#define memcpy_P				memcpy
+#define strlen_P				strlen
+
+#endif      //HOST_AVR_PGMSPACE_H
@@ -0,0 +1,27 @@
+/*
+ * Host stand-in for <avr/sleep.h>
+ *
+ * sleep_cpu() calls hostSleep() (host.c) with the selected mode. A test can set
+ * hostSleepHook to advance time or fire the interrupt that wakes the uC.
+ */
+
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#include <stdint.h>
+
+#define SLEEP_MODE_IDLE			0
+#define SLEEP_MODE_ADC			1
+#define SLEEP_MODE_PWR_DOWN		2
+#define SLEEP_MODE_PWR_SAVE		3
+
+extern uint8_t hostSleepMode;
+extern void hostSleep(void);
+
+#define set_sleep_mode(mode)	(hostSleepMode = (mode))
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()				hostSleep()
+#define sleep_mode()			hostSleep()
+
+#endif      //HOST_AVR_SLEEP_H
@@ -0,0 +1,429 @@
+/*
+ * HD44780 LCD model for the OnLCDLib tests, see hd44780.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <util/delay.h>
+#include "host.h"
+#include "hd44780.h"
+
+#define EPSILON			1e-6
+#define POWER_ON_US		15000			// Internal reset after power on
+#define SPIN_US			1				// Time of one pass of a busy-wait loop
+#define SPIN_LIMIT		1000000UL		// Passes without an interrupt => the loop never ends
+#define DRAIN_STEP_US	10				// lcdDrain() looks at the queue this often
+#define DRAIN_LIMIT_US	100000.0		// The queue is never empty after this long
+
+#define PIN_RS			0x01			// PD0, P0 of the PCF8574
+#define PIN_RW			0x02			// PD1, P1
+#define PIN_E			0x04			// PD2, P2
+#define PIN_BACKLIGHT	0x08			// P3
+
+/* Datasheet timing: enable pulse width, enable cycle time, execution times */
+typedef struct {
+	const char *name;
+	double enableHighUs, enableCycleUs;
+	double clearUs, commandUs, dataUs;
+} LCD_TIMING_t;
+
+static const LCD_TIMING_t timings[] = {
+	{"HD44780", 0.45, 1.0, 1520, 37, 41},		// Data write 37 us + tADD 4 us
+	{"ST7066", 0.46, 1.2, 1520, 37, 43},
+	{"KS0066", 0.23, 0.5, 1530, 39, 43},
+};
+
+double lcdTimeUs, lcdWaitUs, lcdIsrUs, lcdReadyUs;
+uint32_t lcdIsrCalls, lcdCommands, lcdCharacters, lcdErrors;
+uint8_t lcdI2CAddress = 0x27;
+uint32_t lcdI2CBytes, lcdI2CTransactions, lcdI2CDark;
+void (*lcdTimer2Isr)(void);
+void (*lcdTwiIsr)(void);
+uint8_t (*lcdQueueIdle)(void);
+
+static const LCD_TIMING_t *timing;
+static uint8_t bus, inIsr;
+static uint32_t fcpu, spins;
+
+/* LCD */
+static uint8_t ddram[128], cgram[64], address, cgMode, increment, shift;
+static uint8_t eightBit, twoLines, displayOn, functionSets;
+static uint8_t lastE, latchData, latchRs, latchRw, nibble, nibbleData, readNibble;
+static double riseUs, lastRiseUs;
+
+/* Timer2 and TWI */
+static double timerNextUs, twiDoneUs;
+static uint8_t twiOp, twiAddressed;
+
+static void error(const char *what) {
+	lcdErrors++;
+	hostFailures++;
+	printf("  LCD %s at %.2f us: %s\n", timing->name, lcdTimeUs, what);
+}
+
+static void busy(double us) {
+	lcdReadyUs = lcdTimeUs + us;
+}
+
+static void moveAddress(void) {
+	if (cgMode) {
+		address = (address + (increment ? 1 : -1)) & 0x3F;
+	} else if (increment) {
+		address = (address == 0x27) ? 0x40 : ((address == 0x67) ? 0x00 : address + 1);
+	} else {
+		address = (address == 0x40) ? 0x27 : ((address == 0x00) ? 0x67 : address - 1);
+	}
+}
+
+static void execute(uint8_t rs, uint8_t data) {
+	if (rs) {
+		if (cgMode) {
+			cgram[address] = data & 0x1F;
+		} else {
+			ddram[address & 0x7F] = data;
+		}
+		moveAddress();
+		lcdCharacters++;
+		busy(timing->dataUs);
+		return;
+	}
+
+	lcdCommands++;
+	busy(timing->commandUs);
+	if (data & 0x80) {							// DDRAM address
+		address = data & 0x7F;
+		cgMode = 0;
+	} else if (data & 0x40) {					// CGRAM address
+		address = data & 0x3F;
+		cgMode = 1;
+	} else if (data & 0x20) {					// Function set
+		eightBit = (data >> 4) & 1;
+		twoLines = (data >> 3) & 1;
+		functionSets++;
+	} else if (data & 0x10) {					// Cursor or display shift
+		if (data & 0x08) {
+			shift = (data & 0x04) ? (shift + 39) % 40 : (shift + 1) % 40;
+		}
+	} else if (data & 0x08) {					// Display control
+		displayOn = (data >> 2) & 1;
+	} else if (data & 0x04) {					// Entry mode
+		increment = (data >> 1) & 1;
+	} else if (data & 0x02) {					// Return home
+		address = 0;
+		cgMode = 0;
+		shift = 0;
+		busy(timing->clearUs);
+	} else if (data & 0x01) {					// Clear display
+		memset(ddram, ' ', sizeof(ddram));
+		address = 0;
+		cgMode = 0;
+		shift = 0;
+		increment = 1;
+		busy(timing->clearUs);
+	}
+}
+
+/* The LCD pins at lcdTimeUs. data is D7-D0, D3-D0 are 0 with a 4-bit bus */
+static void pins(uint8_t e, uint8_t rs, uint8_t rw, uint8_t data) {
+	uint8_t status;
+
+	if (e && !lastE) {
+		if (lcdTimeUs - lastRiseUs < timing->enableCycleUs - EPSILON) {
+			error("enable cycle time too short");
+		}
+		riseUs = lastRiseUs = lcdTimeUs;
+		if (rw) {								// Status read, the LCD drives the bus while E is HIGH
+			if (bus == LCD_MODEL_I2C) {
+				error("read through the PCF8574");
+			} else if (bus == LCD_MODEL_BUS8) {
+				if (DDRB) {
+					error("bus conflict, data pins are outputs while reading");
+				}
+				PINB = ((lcdTimeUs < lcdReadyUs) ? 0x80 : 0) | (address & 0x7F);
+			} else {
+				if (DDRB & 0xF0) {
+					error("bus conflict, data pins are outputs while reading");
+				}
+				status = ((lcdTimeUs < lcdReadyUs) ? 0x80 : 0) | (address & 0x7F);
+				PINB = (PINB & 0x0F) | (readNibble ? (status << 4) : (status & 0xF0));
+			}
+		}
+	}
+
+	if (e) {
+		latchData = data;
+		latchRs = rs;
+		latchRw = rw;
+	} else if (lastE) {
+		if (lcdTimeUs - riseUs < timing->enableHighUs - EPSILON) {
+			error("enable pulse too short");
+		}
+		if (latchRw) {
+			if (nibble) {
+				error("read between the two nibbles of a write");
+			}
+			if (!eightBit) {
+				readNibble ^= 1;
+			}
+		} else if (!eightBit && !nibble) {		// High nibble, the LCD waits for the low one
+			if (lcdTimeUs < lcdReadyUs - EPSILON) {
+				error("write while the LCD is busy");
+			}
+			nibble = 1;
+			nibbleData = latchData & 0xF0;
+		} else {
+			if (!nibble && lcdTimeUs < lcdReadyUs - EPSILON) {
+				error("write while the LCD is busy");
+			}
+			if (nibble) {
+				latchData = nibbleData | (latchData >> 4);
+				nibble = 0;
+			}
+			execute(latchRs, latchData);
+		}
+	}
+	lastE = e;
+}
+
+/* Parallel bus: read the port pins */
+static void poll(void) {
+	uint8_t data;
+
+	if (bus == LCD_MODEL_I2C) {
+		return;
+	}
+	data = (bus == LCD_MODEL_BUS8) ? PORTB : (PORTB & 0xF0);
+	pins(PORTD & PIN_E, PORTD & PIN_RS, PORTD & PIN_RW, data);
+}
+
+static void interrupt(void (*isr)(void)) {
+	inIsr = 1;
+	lcdIsrCalls++;
+	spins = 0;
+	isr();
+	poll();										// E may have changed after the last delay
+	inIsr = 0;
+}
+
+/* PCF8574 outputs after a byte */
+static void pcfWrite(uint8_t out) {
+	lcdI2CBytes++;
+	if (!(out & PIN_BACKLIGHT)) {
+		lcdI2CDark++;
+	}
+	pins(out & PIN_E, out & PIN_RS, out & PIN_RW, out & 0xF0);
+}
+
+static double twiBitUs(void) {
+	static const uint8_t prescaler[] = {1, 4, 16, 64};
+
+	return (16.0 + 2.0 * TWBR * prescaler[TWSR & 0x03]) * 1e6 / fcpu;
+}
+
+/* Software wrote TWINT: start what TWCR asks for */
+static void twiStart(void) {
+	if (twiOp || !(TWCR & (1 << TWINT)) || !(TWCR & (1 << TWEN))) {
+		return;
+	}
+	TWCR &= ~(1 << TWINT);
+	if (TWCR & (1 << TWSTA)) {
+		twiOp = 'S';
+		twiDoneUs = lcdTimeUs + twiBitUs();
+	} else if (TWCR & (1 << TWSTO)) {
+		twiOp = 'P';
+		twiDoneUs = lcdTimeUs + twiBitUs();
+	} else {
+		twiOp = 'D';
+		twiDoneUs = lcdTimeUs + 9 * twiBitUs();	// 8 bits + ACK
+	}
+}
+
+static void twiDone(void) {
+	uint8_t op = twiOp;
+
+	twiOp = 0;
+	switch (op) {
+		case 'S':
+			lcdI2CTransactions++;
+			twiAddressed = 1;
+			TWSR = (TWSR & 0x03) | 0x08;
+			break;
+
+		case 'P':
+			TWCR &= ~(1 << TWSTO);
+			twiAddressed = 0;
+			return;							// No interrupt after a stop condition
+
+		case 'D':
+			if (twiAddressed == 1) {		// SLA+W
+				twiAddressed = ((TWDR >> 1) == lcdI2CAddress && !(TWDR & 1)) ? 2 : 3;
+				TWSR = (TWSR & 0x03) | ((twiAddressed == 2) ? 0x18 : 0x20);
+			} else if (twiAddressed == 2) {
+				pcfWrite(TWDR);
+				TWSR = (TWSR & 0x03) | 0x28;
+			} else {
+				TWSR = (TWSR & 0x03) | 0x30;	// Nobody listens
+			}
+			break;
+	}
+	if ((TWCR & (1 << TWIE)) && lcdTwiIsr && (SREG & 0x80)) {
+		interrupt(lcdTwiIsr);
+	}
+}
+
+/* TCNT2 is set to the count of the timer before the interrupt, a write to it restarts the period */
+static void timer2Interrupt(double periodUs) {
+	double countUs = 8 * 1e6 / fcpu;
+	uint8_t count = (uint8_t)((periodUs - (timerNextUs - lcdTimeUs)) / countUs + EPSILON);
+
+	TCNT2 = count;
+	interrupt(lcdTimer2Isr);
+	if (TCNT2 != count) {
+		timerNextUs = lcdTimeUs + periodUs - TCNT2 * countUs;
+	}
+}
+
+/* Run the timer and the TWI until end */
+static void advance(double end) {
+	double periodUs = 0, next;
+
+	for (;;) {
+		if (TCCR2B & 0x07) {
+			periodUs = (OCR2A + 1.0) * 8 * 1e6 / fcpu;	// Prescaler 8 as in LCDAsyncSetup()
+			if (timerNextUs == 0) {
+				timerNextUs = lcdTimeUs + periodUs;
+			}
+		} else {
+			timerNextUs = 0;
+		}
+
+		if ((TIFR2 & (1 << OCF2A)) && (TIMSK2 & (1 << OCIE2A)) && lcdTimer2Isr && (SREG & 0x80)) {
+			TIFR2 &= ~(1 << OCF2A);
+			timer2Interrupt(periodUs);
+			continue;
+		}
+		twiStart();
+
+		next = end;
+		if (timerNextUs != 0 && timerNextUs < next) {
+			next = timerNextUs;
+		}
+		if (twiOp && twiDoneUs < next) {
+			next = twiDoneUs;
+		}
+		if (next >= end) {
+			break;
+		}
+		if (next > lcdTimeUs) {
+			lcdTimeUs = next;
+		}
+		if (timerNextUs != 0 && timerNextUs <= lcdTimeUs) {
+			TIFR2 |= 1 << OCF2A;
+			timerNextUs += periodUs;
+		}
+		if (twiOp && twiDoneUs <= lcdTimeUs) {
+			twiDone();
+		}
+	}
+	if (lcdTimeUs < end) {
+		lcdTimeUs = end;
+	}
+}
+
+/* _delay_us() of the library */
+static void delay(double us) {
+	poll();
+	if (inIsr) {
+		lcdIsrUs += us;
+		lcdTimeUs += us;
+		return;
+	}
+	lcdWaitUs += us;
+	advance(lcdTimeUs + us);
+}
+
+void lcdModelReset(uint8_t controller, uint8_t newBus, uint32_t newFcpu) {
+	timing = &timings[controller];
+	bus = newBus;
+	fcpu = newFcpu;
+	lcdTimeUs = lcdWaitUs = lcdIsrUs = 0;
+	lcdReadyUs = POWER_ON_US;
+	lcdIsrCalls = lcdCommands = lcdCharacters = lcdErrors = 0;
+	lcdI2CBytes = lcdI2CTransactions = lcdI2CDark = 0;
+	lcdTimer2Isr = lcdTwiIsr = 0;
+	lcdQueueIdle = 0;
+	inIsr = 0;
+	spins = 0;
+
+	memset(ddram, ' ', sizeof(ddram));
+	memset(cgram, 0, sizeof(cgram));
+	address = cgMode = shift = 0;
+	increment = 1;
+	eightBit = 1;								// Power on state, 8-bit interface, 1 line, display off
+	twoLines = displayOn = functionSets = 0;
+	lastE = nibble = readNibble = 0;
+	riseUs = lastRiseUs = -1e9;
+	timerNextUs = 0;
+	twiOp = twiAddressed = 0;
+	hostDelayHook = delay;
+}
+
+void lcdRun(double us) {
+	poll();
+	advance(lcdTimeUs + us);
+}
+
+void lcdSpin(void) {
+	if (++spins > SPIN_LIMIT) {
+		printf("  LCD %s: busy-wait loop never ends\n", timing->name);
+		exit(1);
+	}
+	lcdWaitUs += SPIN_US;
+	lcdRun(SPIN_US);
+}
+
+uint8_t lcdDrain(void) {
+	double startUs = lcdTimeUs;
+
+	while (lcdQueueIdle && !lcdQueueIdle()) {
+		if (lcdTimeUs - startUs > DRAIN_LIMIT_US) {
+			return 0;
+		}
+		lcdRun(DRAIN_STEP_US);
+	}
+	if (lcdTimeUs < lcdReadyUs) {
+		lcdRun(lcdReadyUs - lcdTimeUs);
+	}
+	return 1;
+}
+
+const uint8_t *lcdRow(uint8_t row) {
+	static uint8_t line[LCD_MODEL_COLUMNS];
+	uint8_t column;
+
+	for (column = 0; column < LCD_MODEL_COLUMNS; column++) {
+		line[column] = ddram[row * 0x40 + (column + shift) % 40];
+	}
+	return line;
+}
+
+uint8_t lcdRowIs(uint8_t row, const char *text) {
+	const uint8_t *line = lcdRow(row);
+	uint8_t column;
+
+	for (column = 0; column < LCD_MODEL_COLUMNS; column++) {
+		if (line[column] != (*text ? (uint8_t)*text++ : ' ')) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+const uint8_t *lcdCGRAM(uint8_t code) {
+	return &cgram[(code & 0x07) * 8];
+}
+
+uint8_t lcdInitialized(void) {
+	return functionSets && (eightBit == (bus == LCD_MODEL_BUS8)) && twoLines && displayOn && !nibble;
+}
@@ -0,0 +1,71 @@
+/*
+ * HD44780 LCD model for the OnLCDLib tests
+ *
+ * Author      : rludvik
+ * Description : A 16x2 character LCD on the pins of OnLCDLib.h: data on PORTB (D4-D7 on
+ *               PB4-PB7 with a 4-bit bus), RS on PD0, RW on PD1, E on PD2. Or behind a
+ *               PCF8574 I2C backpack (P0 RS, P1 RW, P2 E, P3 backlight, P4-P7 D4-D7).
+ *               The model reads the pins at every _delay_us() of the library and after
+ *               every interrupt, latches on the falling edge of E and keeps DDRAM, CGRAM
+ *               and the address counter. Enable pulse width, enable cycle time and writes
+ *               before the last instruction has finished are checked against the datasheet
+ *               of the controller, a violation is printed and fails the test.
+ *               Timer2 (compare match A, CTC) and the TWI master run in simulated time while
+ *               the library waits: in _delay_us(), in lcdRun() and in lcdSpin(), which the
+ *               host copy of OnLCDLib.h calls from its busy-wait loops (see Makefile).
+ */
+
+#ifndef hd44780_H
+#define hd44780_H
+
+#include <stdint.h>
+
+#define LCD_MODEL_BUS4			4		// Parallel, D4-D7
+#define LCD_MODEL_BUS8			8		// Parallel, D0-D7
+#define LCD_MODEL_I2C			1		// PCF8574, D4-D7
+
+#define LCD_MODEL_COLUMNS		16
+#define LCD_MODEL_ROWS			2
+
+/* Time since lcdModelReset() */
+extern double lcdTimeUs;
+/* CPU time the main code waited: delays and busy-wait loops outside the interrupts */
+extern double lcdWaitUs;
+/* Interrupts run by the model and the time of the delays in them */
+extern uint32_t lcdIsrCalls;
+extern double lcdIsrUs;
+/* The LCD is busy with the last instruction until then */
+extern double lcdReadyUs;
+/* Instructions executed by the LCD: commands and characters (a 4-bit byte is one) */
+extern uint32_t lcdCommands, lcdCharacters;
+/* Timing or protocol errors */
+extern uint32_t lcdErrors;
+
+/* PCF8574: its address, bytes written to it, TWI start conditions, bytes with the backlight off */
+extern uint8_t lcdI2CAddress;
+extern uint32_t lcdI2CBytes, lcdI2CTransactions, lcdI2CDark;
+
+/* Interrupts of the library, set the ones it has (NULL => not there) */
+extern void (*lcdTimer2Isr)(void);
+extern void (*lcdTwiIsr)(void);
+/* LCDQueueIdle() of the asynchronous library, for lcdDrain() (NULL => blocking library) */
+extern uint8_t (*lcdQueueIdle)(void);
+
+/* Power on the LCD: controller as LCD_CONTROLLER of OnLCDLib.h, bus LCD_MODEL_BUS4/BUS8/I2C. After hostReset() */
+extern void lcdModelReset(uint8_t controller, uint8_t bus, uint32_t fcpu);
+/* Let time pass while the main code does something else, the interrupts run */
+extern void lcdRun(double us);
+/* One step of a busy-wait loop of the library */
+extern void lcdSpin(void);
+/* Let time pass until the queue is empty and the LCD has done the last instruction, 0 if the queue never empties */
+extern uint8_t lcdDrain(void);
+/* Visible characters of a line (0 based), display shift included */
+extern const uint8_t *lcdRow(uint8_t row);
+/* 1 if the line shows text, padded with spaces */
+extern uint8_t lcdRowIs(uint8_t row, const char *text);
+/* Pattern of a custom character (8 rows) */
+extern const uint8_t *lcdCGRAM(uint8_t code);
+/* 1 if the LCD was set up for the bus, 2 lines, display on */
+extern uint8_t lcdInitialized(void);
+
+#endif      //hd44780_H
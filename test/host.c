@@ -0,0 +1,100 @@
+/*
+ * Host test support, see host.h.
+ */
+
+#include <string.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <util/delay.h>
+#include "host.h"
+
+#define HOST_DEFINE8(r)		volatile uint8_t r;
+#define HOST_DEFINE16(r)	volatile uint16_t r;
+HOST_REGS8(HOST_DEFINE8)
+HOST_REGS16(HOST_DEFINE16)
+
+int hostFailures = 0;
+uint8_t hostSleepMode = 0;
+uint32_t hostSleeps = 0;
+void (*hostSleepHook)(void) = 0;
+uint32_t hostEepromWrites = 0;
+uint32_t hostFlashReads = 0;
+double hostDelayUs = 0;
+void (*hostDelayHook)(double us) = 0;
+static uint32_t hostRandomState = 1;
+
+#define HOST_CLEAR(r)		r = 0;
+
+void hostReset(void) {
+	HOST_REGS8(HOST_CLEAR)
+	HOST_REGS16(HOST_CLEAR)
+	hostSleeps = 0;
+	hostSleepHook = 0;
+	hostEepromWrites = 0;
+	hostFlashReads = 0;
+	hostDelayUs = 0;
+	hostDelayHook = 0;
+}
+
+int hostResult(const char *name) {
+	printf("%s: %s\n", name, hostFailures ? "FAIL" : "PASS");
+	return hostFailures ? 1 : 0;
+}
+
+void hostSeed(uint32_t seed) {
+	hostRandomState = seed ? seed : 1;
+}
+
+uint32_t hostRandom(void) {
+	hostRandomState ^= hostRandomState << 13;
+	hostRandomState ^= hostRandomState >> 17;
+	hostRandomState ^= hostRandomState << 5;
+	return hostRandomState;
+}
+
+void hostSleep(void) {
+	hostSleeps++;
+	if (hostSleepHook) {
+		hostSleepHook();
+	}
+}
+
+void hostDelay(double us) {
+	hostDelayUs += us;
+	if (hostDelayHook) {
+		hostDelayHook(us);
+	}
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n) {
+	memcpy(dst, src, n);
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n) {
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		if (((uint8_t *)dst)[i] != ((const uint8_t *)src)[i]) {
+			((uint8_t *)dst)[i] = ((const uint8_t *)src)[i];
+			hostEepromWrites++;
+		}
+	}
+}
+
+uint8_t eeprom_read_byte(const uint8_t *p) {
+	return *p;
+}
+
+void eeprom_write_byte(uint8_t *p, uint8_t value) {
+	*p = value;
+	hostEepromWrites++;
+}
+
+void eeprom_update_byte(uint8_t *p, uint8_t value) {
+	if (*p != value) {
+		*p = value;
+		hostEepromWrites++;
+	}
+}
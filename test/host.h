@@ -0,0 +1,36 @@
+/*
+ * Host test support
+ *
+ * Author      : rludvik
+ * Description : The firmware sources are compiled with gcc against the stand-in AVR headers
+ *               in this directory (avr/, util/). Registers are variables, ISRs are functions,
+ *               delays and sleep only count. CHECK() reports a failed condition and the
+ *               test program returns 1 at the end (hostResult()).
+ */
+
+#ifndef host_H
+#define host_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+extern int hostFailures;
+
+#define CHECK(cond)		do { if (!(cond)) { hostFailures++; \
+							printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); } } while (0)
+#define CHECK_EQ(a, b)	do { long hostA = (long)(a), hostB = (long)(b); if (hostA != hostB) { hostFailures++; \
+							printf("%s:%d: CHECK failed: %s == %s (%ld != %ld)\n", __FILE__, __LINE__, #a, #b, hostA, hostB); } } while (0)
+
+/* Called by sleep_cpu() with the mode in hostSleepMode, NULL => just count */
+extern void (*hostSleepHook)(void);
+extern uint32_t hostSleeps;
+
+/* Reset the registers, counters and hooks between test cases */
+extern void hostReset(void);
+/* Print PASS/FAIL for the program, return value for main() */
+extern int hostResult(const char *name);
+/* Repeatable pseudo-random numbers (xorshift32), the same on every PC */
+extern void hostSeed(uint32_t seed);
+extern uint32_t hostRandom(void);
+
+#endif      //host_H
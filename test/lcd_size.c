@@ -0,0 +1,30 @@
+/*
+ * Flash and RAM of the fixed point vs the float display on the AVR (user-020)
+ *
+ * Author      : rludvik
+ * Description : Not a host test, "make size" builds it twice with avr-gcc for the ATmega328P:
+ *               the DHT22 demo's display of a reading with LCDWriteFixed(), and with
+ *               LCDWriteFloat() as before (SIZE_FLOAT). It prints the sizes and the float
+ *               routines of libgcc that each one links. The .lss listings show the code.
+ */
+
+#define F_CPU			8000000UL
+#include <avr/io.h>
+#include "OnLCDLib.h"
+
+volatile uint8_t I_Temp = 0x00, D_Temp = 0xEB;	// 23.5 C, volatile so nothing is computed at compile time
+
+int main(void) {
+	LCDSetup(LCD_CURSOR_NONE);
+	while (1) {
+		LCDClear();
+#ifdef SIZE_FLOAT
+		float T = (float)I_Temp * 256.0 + D_Temp;
+		T = T / 10.0;
+		LCDWriteFloat(T, 0, 2);
+#else
+		LCDWriteFixed(((uint16_t)I_Temp << 8) | D_Temp, 1);
+#endif
+		LCDFlush();
+	}
+}
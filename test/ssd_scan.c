@@ -0,0 +1,57 @@
+/*
+ * Scan loop of the 7-segment display on the AVR, before and after the frame buffer (user-001, user-002)
+ *
+ * Author      : rludvik
+ * Description : Not a host test, "make scan" builds it twice with avr-gcc for the ATmega328P:
+ *               SCAN_OLD is one pass of the old ssdDisplay() loop (the 3 digits, without the
+ *               _delay_ms() between them), the other one is SevSeg.c with its refresh ISRs.
+ *               It prints the instructions of the old pass and of the two ISRs, and the
+ *               calls to the division routines of libgcc, from the .lss listings.
+ */
+
+#define F_CPU			8000000UL
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "SevSeg.h"
+
+volatile int number = 123;					// volatile so nothing is computed at compile time
+
+#ifdef SCAN_OLD
+/* The body of the old loop, as in ssdDisplay() before the timer refresh */
+void __attribute__((noinline)) ssdScanOld(int numToDisplay) {
+	char seg_code[]={0x81,0xcf,0x92,0x86,0xcc,0xa4,0xa0,0x8f,0x80,0x84};
+	char seg_code_dp[]={0x01,0x4f,0x12,0x06,0x4c,0x24,0x20,0x0f,0x00,0x04};
+	int num, temp;
+
+	num = numToDisplay;
+	temp = num / 100;
+	num = num % 100;
+	DIGIT_CONTROL_PORT = SegOne;
+	DATA_PORT = seg_code[temp];
+
+	temp = num / 10;
+	num = num % 10;
+	DIGIT_CONTROL_PORT = SegTwo;
+	DATA_PORT = seg_code[temp];
+
+	temp = num % 10;
+	PORTD = SegThree;
+	PORTB = seg_code_dp[temp];
+}
+
+int main(void) {
+	DIGIT_CONTROL_DDR = (1<<PD0) | (1<<PD1) | (1<<PD2);
+	DATA_DDR = 0xff;
+	while (1) {
+		ssdScanOld(number);
+	}
+}
+#else
+int main(void) {
+	ssdInit();
+	sei();
+	while (1) {
+		ssdSetNumber(number);
+	}
+}
+#endif
@@ -0,0 +1,218 @@
+/*
+ * Host test for the Bluetooth command path of GarageDoorBT (user-009)
+ *
+ * Author      : rludvik
+ * Description : Characters arrive from the HC-05 at 9600 baud (1.04 ms each), the RX ISR
+ *               stores them, btParse() and ledTask() run every 1 ms tick as in main.c.
+ *               fsmRaise(), powerActivity() and positionSetTarget() are stand-ins that
+ *               record the time of the command.
+ *               Command latency is compared with a model of the old ISR, which blinked the
+ *               LED with two _delay_ms(200) before it set the state, one character at a time.
+ */
+
+#include <avr/io.h>
+#include <util/delay.h>
+#include "host.h"
+#include "settings.h"
+#include "scheduler.h"
+#include "led.h"
+
+#define CHAR_US			1042			// 10 bits at 9600 baud
+#define OLD_ISR_US		400000UL		// Two _delay_ms(200) in the old ISR
+#define OLD_UART_HOLD	3				// Characters the USART keeps while the ISR is blocked (2 in UDR0 + shift register)
+
+void USART_RX_vect(void);
+extern void btParse(void);
+extern volatile uint8_t btHead, btTail, btOverflows;
+extern uint8_t btCommandLength;
+
+/* Stand-ins for fsm.c, power.c and position.c */
+static uint32_t clockUs;
+static uint8_t events[16];
+static uint32_t eventUs[16];
+static uint8_t eventCount;
+static uint16_t lastTarget;
+
+uint8_t fsmRaise(uint8_t event) {
+	if (event != EV_NONE && eventCount < sizeof(events)) {
+		eventUs[eventCount] = clockUs;
+		events[eventCount++] = event;
+	}
+	return 1;
+}
+
+void powerActivity(void) {
+}
+
+void positionSetTarget(uint16_t target) {
+	lastTarget = target;
+}
+
+/* Characters on the line: text[i] is complete at atUs[i] */
+typedef struct {
+	const char *text;
+	uint32_t atUs[16];
+} BT_INPUT_t;
+
+static void reset(void) {
+	hostReset();
+	btHead = btTail = btOverflows = 0;
+	btCommandLength = 0;
+	eventCount = 0;
+	lastTarget = 0;
+	clockUs = 0;
+	schedulerTicks += 1000;
+	ledOff(1 << POWER_LED_PIN);
+}
+
+static const BT_INPUT_t quiet = {""};
+
+/* Run the new firmware for ms milliseconds with the characters arriving as in input */
+static void runNew(const BT_INPUT_t *input, uint16_t ms) {
+	uint8_t next = 0;
+
+	while (ms--) {
+		clockUs += 1000;
+		while (input->text[next] && input->atUs[next] <= clockUs) {
+			UDR0 = input->text[next++];
+			USART_RX_vect();
+		}
+		schedulerTick();
+		btParse();
+		ledTask();
+	}
+}
+
+/* Old ISR: 400 ms per character, the state is set at the end. Returns the time of each command */
+static uint8_t runOld(const BT_INPUT_t *input, uint32_t *doneUs) {
+	uint32_t busyUntil = 0;
+	uint8_t i, held = 0, done = 0;
+
+	for (i = 0; input->text[i]; i++) {
+		if (input->atUs[i] < busyUntil) {
+			if (++held > OLD_UART_HOLD) {
+				continue;							// Overrun, the character is lost
+			}
+		} else {
+			held = 0;
+			busyUntil = input->atUs[i];
+		}
+		busyUntil += OLD_ISR_US;
+		if (input->text[i] == 'a' || input->text[i] == 'o' || input->text[i] == 'c') {
+			doneUs[done++] = busyUntil;
+		}
+	}
+	return done;
+}
+
+/* Letters and words, line end or a pause ends a command, unknown and too long are ignored */
+static void testCommands(void) {
+	static const struct {
+		const char *text;
+		uint8_t event;
+		uint16_t target;
+	} cases[] = {
+		{"o", EV_REMOTE_OPEN, POSITION_FULL}, {"c", EV_REMOTE_CLOSE, 0}, {"a", EV_REMOTE_LOCK, 0},
+		{"h", EV_REMOTE_OPEN, POSITION_HALF}, {"open\r\n", EV_REMOTE_OPEN, POSITION_FULL},
+		{"close\n", EV_REMOTE_CLOSE, 0}, {"lock\r", EV_REMOTE_LOCK, 0}, {"half", EV_REMOTE_OPEN, POSITION_HALF},
+		{"x", EV_NONE, 0}, {"opened\r", EV_NONE, 0}, {"openopenopen\r", EV_NONE, 0},
+	};
+	BT_INPUT_t input;
+	uint8_t i, j;
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		reset();
+		input.text = cases[i].text;
+		for (j = 0; cases[i].text[j]; j++) {
+			input.atUs[j] = (j + 1) * CHAR_US;
+		}
+		runNew(&input, 100);
+		if (cases[i].event == EV_NONE) {
+			CHECK_EQ(eventCount, 0);
+		} else {
+			CHECK_EQ(eventCount, 1);
+			CHECK_EQ(events[0], cases[i].event);
+			CHECK_EQ(lastTarget, cases[i].target);
+		}
+		CHECK(hostDelayUs == 0);					// Nothing waits, in the ISR or in the parser
+	}
+}
+
+/* The power LED blinks once for a command and is back to what it was afterwards */
+static void testLedFeedback(void) {
+	BT_INPUT_t input = {"o\r", {CHAR_US, 2 * CHAR_US}};
+
+	reset();
+	ledOn(1 << POWER_LED_PIN);
+	runNew(&input, 5);
+	CHECK(OUTPUT_PORT & (1 << POWER_LED_PIN));
+	runNew(&quiet, BT_LED_BLINK);
+	CHECK(!(OUTPUT_PORT & (1 << POWER_LED_PIN)));	// Off part of the blink
+	runNew(&quiet, BT_LED_BLINK);
+	CHECK(OUTPUT_PORT & (1 << POWER_LED_PIN));		// Restored
+	CHECK(ledIdle());
+}
+
+/* More characters than the buffer holds before the parser runs: counted, the next line works */
+static void testOverflow(void) {
+	BT_INPUT_t input = {"\rc\r", {1000, 2000, 3000}};
+	uint8_t i;
+
+	reset();
+	for (i = 0; i < BT_BUFFER_SIZE + 2; i++) {
+		UDR0 = 'x';
+		USART_RX_vect();
+	}
+	CHECK_EQ(btOverflows, 3);
+	runNew(&quiet, 1);								// Parser takes the 15 that fit, a command too long
+	runNew(&input, 10);
+	CHECK_EQ(eventCount, 1);
+	CHECK_EQ(events[0], EV_REMOTE_CLOSE);
+}
+
+/* Worst-case command latency, new path vs the old blocking ISR */
+static void latency(const char *name, const BT_INPUT_t *input, uint8_t commands, const uint8_t *lastChar) {
+	uint32_t oldUs[16], worstNew = 0, worstOld = 0, us;
+	uint8_t i, oldDone;
+
+	reset();
+	runNew(input, 2000);
+	CHECK_EQ(eventCount, commands);
+	for (i = 0; i < eventCount && i < commands; i++) {
+		us = eventUs[i] - input->atUs[lastChar[i]];
+		if (us > worstNew) {
+			worstNew = us;
+		}
+	}
+	oldDone = runOld(input, oldUs);
+	for (i = 0; i < oldDone; i++) {
+		us = oldUs[i] - input->atUs[lastChar[i]];
+		if (us > worstOld) {
+			worstOld = us;
+		}
+	}
+	printf("  %-26s new: %u of %u commands, worst %4.1f ms | old ISR: %u of %u, worst %4lu ms\n", name,
+		eventCount, commands, worstNew / 1000.0, oldDone, commands, (unsigned long)(worstOld / 1000));
+	CHECK(worstNew <= (BT_CMD_TIMEOUT + 2) * 1000UL);
+}
+
+static void testLatency(void) {
+	static const BT_INPUT_t single = {"o", {CHAR_US}};
+	static const BT_INPUT_t lineEnd = {"o\r", {CHAR_US, 2 * CHAR_US}};
+	static const BT_INPUT_t stop = {"o\ra\r", {CHAR_US, 2 * CHAR_US, 50000, 50000 + CHAR_US}};
+	static const BT_INPUT_t burst = {"o\rc\ro\rc\ra\r", {1042, 2084, 3126, 4168, 5210, 6252, 7294, 8336, 9378, 10420}};
+	static const uint8_t lastSingle[] = {0}, lastLineEnd[] = {1}, lastStop[] = {1, 3}, lastBurst[] = {1, 3, 5, 7, 9};
+
+	latency("'o' from the app", &single, 1, lastSingle);
+	latency("'o' + CR", &lineEnd, 1, lastLineEnd);
+	latency("'o', 'a' 50 ms later", &stop, 2, lastStop);
+	latency("5 commands back to back", &burst, 5, lastBurst);
+}
+
+int main(void) {
+	testCommands();
+	testLedFeedback();
+	testOverflow();
+	testLatency();
+	return hostResult(TEST_NAME);
+}
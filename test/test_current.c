@@ -0,0 +1,142 @@
+/*
+ * Host test for the motor current stall/obstruction detection (user-015)
+ *
+ * Author      : rludvik
+ * Description : Synthetic VNH2SP30 CS traces (8-bit ADC values, ~6.7 per A) are fed one
+ *               sample per 1 ms tick: ADCH is set, ADC_vect() called as after the auto-triggered
+ *               conversion, then currentMonitor() runs as the 1 ms task.
+ *               fsmRaise() is a stand-in that records when EV_OBSTRUCTION came.
+ */
+
+#include <math.h>
+#include <avr/io.h>
+#include "host.h"
+#include "settings.h"
+#include "scheduler.h"
+#include "current.h"
+
+#define RUN_MS			10000			// Every trace is a 10 s door run
+#define NORMAL			30				// ~4.5 A while the door moves
+
+void ADC_vect(void);
+extern volatile uint8_t currentOverflows;
+
+static uint16_t eventMs;				// ms after the start, 0 => no event
+static uint8_t events;
+static uint16_t nowMs;
+
+uint8_t fsmRaise(uint8_t event) {
+	CHECK_EQ(event, EV_OBSTRUCTION);
+	if (events++ == 0) {
+		eventMs = nowMs;
+	}
+	return 1;
+}
+
+static int noise(int amplitude) {
+	return (int)(hostRandom() % (2 * amplitude + 1)) - amplitude;
+}
+
+static uint8_t clip(int value) {
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+/* Motor start: inrush of ~18 A decaying to the normal current in ~100 ms */
+static int normal(uint16_t ms) {
+	return NORMAL + (int)(90 * exp(-ms / 30.0)) + noise(4);
+}
+
+static uint8_t traceNormal(uint16_t ms) {
+	return clip(normal(ms));
+}
+
+/* Commutation spikes of the brushes, single samples */
+static uint8_t traceSpikes(uint16_t ms) {
+	return clip(normal(ms) + ((ms % 37) == 0 ? 80 : 0));
+}
+
+/* Door gets heavier slowly (springs, cold grease): +15 over the whole run */
+static uint8_t traceSlowRise(uint16_t ms) {
+	return clip(normal(ms) + 15 * ms / RUN_MS);
+}
+
+/* Door blocked at 4 s: motor stalls, ~15 A */
+static uint8_t traceStall(uint16_t ms) {
+	return clip(ms < 4000 ? normal(ms) : 100 + noise(4));
+}
+
+/* Door hits something soft at 4 s: current jumps ~4 A but stays below the stall limit */
+static uint8_t traceObstruction(uint16_t ms) {
+	return clip(normal(ms) + (ms < 4000 ? 0 : 27));
+}
+
+/* Blocked from the start: the inrush never decays */
+static uint8_t traceBlockedAtStart(uint16_t ms) {
+	return clip(110 + noise(4));
+}
+
+/* Run the trace, returns ms from the start to EV_OBSTRUCTION, 0 => none */
+static uint16_t run(uint8_t (*trace)(uint16_t ms)) {
+	hostReset();
+	hostSeed(15);
+	events = 0;
+	eventMs = 0;
+	currentStart();
+	CHECK(ADCSRA & (1 << ADEN));
+	CHECK(ADCSRA & (1 << ADATE));					// Auto-triggered, no code per sample
+	for (nowMs = 1; nowMs <= RUN_MS; nowMs++) {
+		schedulerTick();
+		ADCH = trace(nowMs);
+		ADC_vect();
+		currentMonitor();
+	}
+	currentStop();
+	CHECK_EQ(ADCSRA, 0);
+	CHECK(PRR & (1 << PRADC));						// ADC powered down with the motor
+	CHECK(events <= 1);								// Once per start
+	CHECK_EQ(currentOverflows, 0);
+	return eventMs;
+}
+
+static void testNoFalseAlarm(void) {
+	CHECK_EQ(run(traceNormal), 0);
+	CHECK_EQ(run(traceSpikes), 0);
+	CHECK_EQ(run(traceSlowRise), 0);
+}
+
+static void testDetection(void) {
+	uint16_t stall, obstruction, blocked;
+
+	stall = run(traceStall);
+	obstruction = run(traceObstruction);
+	blocked = run(traceBlockedAtStart);
+	printf("  detection latency: stall %u ms, obstruction %u ms, blocked at start %u ms after the %u ms blanking\n",
+		stall - 4000, obstruction - 4000, blocked - CURRENT_BLANK_TIME, CURRENT_BLANK_TIME);
+	CHECK(stall > 4000 && stall - 4000 <= 20);
+	CHECK(obstruction > 4000 && obstruction - 4000 <= CURRENT_PEAK_SAMPLES + 5);
+	CHECK(blocked >= CURRENT_BLANK_TIME && blocked - CURRENT_BLANK_TIME <= 5);
+}
+
+/* The task may run late, the ISR keeps the samples in the buffer meanwhile */
+static void testLateTask(void) {
+	uint8_t i;
+
+	hostReset();
+	currentStart();
+	for (i = 0; i < CURRENT_BUFFER_SIZE - 1; i++) {
+		ADCH = NORMAL;
+		ADC_vect();
+	}
+	CHECK_EQ(currentOverflows, 0);
+	ADC_vect();
+	CHECK_EQ(currentOverflows, 1);
+	currentMonitor();
+	currentStop();
+}
+
+int main(void) {
+	testNoFalseAlarm();
+	testDetection();
+	testLateTask();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,197 @@
+/*
+ * Host test for the vertical counter debouncer (user-011) and its button events (user-012)
+ *
+ * Author      : rludvik
+ * Description : Built for the receivers' copy of debounce.c (with the event queue) and the
+ *               transmitter's copy (edges only), see Makefile.
+ *               All 8 pins are compared with a plain counter per pin, which is what the old
+ *               ISR did, but without its wrap at cntLimit.
+ */
+
+#include <avr/io.h>
+#include "host.h"
+#include "debounce.h"
+
+extern uint8_t debounceCnt0, debounceCnt1;
+#ifdef DEBOUNCE_QUEUE_SIZE
+extern volatile uint8_t debounceHead, debounceTail, debounceOverflows;
+extern uint8_t debounceLongDone, debounceDoubleArmed;
+#endif
+
+static void reset(void) {
+	hostReset();
+	debounceState = debouncePress = debounceRelease = 0;
+	debounceCnt0 = debounceCnt1 = 0xFF;
+#ifdef DEBOUNCE_QUEUE_SIZE
+	debounceHead = debounceTail = debounceOverflows = 0;
+	debounceLongDone = debounceDoubleArmed = 0;
+#endif
+}
+
+/* Reference: a counter per pin, the state changes after DEBOUNCE_SAMPLES different samples in a row */
+static uint8_t refState, refCount[8];
+
+static void refSample(uint8_t sample) {
+	uint8_t pin, bit;
+
+	for (pin = 0, bit = 1; bit != 0; pin++, bit <<= 1) {
+		if ((sample ^ refState) & bit) {
+			if (++refCount[pin] == DEBOUNCE_SAMPLES) {
+				refState ^= bit;
+				refCount[pin] = 0;
+			}
+		} else {
+			refCount[pin] = 0;
+		}
+	}
+}
+
+/* Random bouncing on all pins at once, every sample the same as the reference */
+static void testAgainstReference(void) {
+	uint32_t i, presses = 0, releases = 0;
+	uint8_t sample = 0, bouncing = 0;
+
+	reset();
+	refState = 0;
+	for (i = 0; i < 8; i++) {
+		refCount[i] = 0;
+	}
+	hostSeed(11);
+	for (i = 0; i < 200000; i++) {
+		if ((hostRandom() & 63) == 0) {
+			bouncing = hostRandom();				// Some pins start to change
+		}
+		sample ^= bouncing & hostRandom();			// Those flip at random...
+		if ((hostRandom() & 7) == 0) {
+			bouncing = 0;							// ...until they settle
+		}
+		debounceSample(sample);
+		refSample(sample);
+		CHECK_EQ(debounceState, refState);
+		presses += __builtin_popcount(debounceTakePressed(0xFF));
+		releases += __builtin_popcount(debounceTakeReleased(0xFF));
+		CHECK_EQ(presses - releases, __builtin_popcount(debounceState));
+	}
+	printf("  200000 samples of 8 bouncing pins: %lu presses, %lu releases, same as a counter per pin\n",
+		(unsigned long)presses, (unsigned long)releases);
+}
+
+/* A real button: bounces on press and release, one press and one release come out */
+static void testBouncePattern(void) {
+	static const uint8_t press[] = {1, 0, 1, 1, 0, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1};
+	static const uint8_t release[] = {0, 1, 0, 0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0};
+	uint8_t i, bit = 1 << 3, changedAt = 0;
+
+	reset();
+	for (i = 0; i < sizeof(press); i++) {
+		debounceSample(press[i] ? bit : 0);
+		if (debounceState && !changedAt) {
+			changedAt = i + 1;
+		}
+	}
+	CHECK_EQ(debounceState, bit);
+	CHECK_EQ(changedAt, 8 + DEBOUNCE_SAMPLES);		// DEBOUNCE_SAMPLES after the last bounce
+	CHECK_EQ(debounceTakePressed(0xFF), bit);
+	CHECK_EQ(debounceTakePressed(0xFF), 0);			// Taken once
+	for (i = 0; i < sizeof(release); i++) {
+		debounceSample(release[i] ? bit : 0);
+	}
+	CHECK_EQ(debounceState, 0);
+	CHECK_EQ(debounceTakeReleased(0xFF), bit);
+	CHECK_EQ(debounceTakePressed(0xFF), 0);
+}
+
+/* Spikes shorter than DEBOUNCE_SAMPLES are ignored, however often they come */
+static void testGlitch(void) {
+	uint16_t i;
+	uint8_t j;
+
+	reset();
+	for (i = 0; i < 1000; i++) {
+		for (j = 0; j < DEBOUNCE_SAMPLES - 1; j++) {
+			debounceSample(0xFF);
+		}
+		debounceSample(0);
+	}
+	CHECK_EQ(debounceState, 0);
+	CHECK_EQ(debouncePress, 0);
+	CHECK(debounceIdle());
+}
+
+/* Held for a long time: no second press (the old counters wrapped to 0 at cntLimit and counted again) */
+static void testNoWrap(void) {
+	uint32_t i;
+
+	reset();
+	for (i = 0; i < 100000; i++) {
+		debounceSample(0x01);
+		if (i == DEBOUNCE_SAMPLES) {
+			CHECK_EQ(debounceTakePressed(0xFF), 0x01);
+		}
+	}
+	CHECK_EQ(debounceTakePressed(0xFF), 0);
+	CHECK_EQ(debounceState, 0x01);
+	CHECK(debounceIdle());
+}
+
+#ifdef DEBOUNCE_QUEUE_SIZE
+/* Press, release, long and double press events with the tick they happened at */
+static void run(uint8_t sample, uint16_t ms, uint16_t *now) {
+	while (ms--) {
+		debounceSample(sample);
+		debounceEvents(0xFF, (*now)++);
+	}
+}
+
+static void testEvents(void) {
+	DEBOUNCE_EVENT_t event;
+	uint16_t now = 65000;							// Wraps during the test
+
+	reset();
+	run(0x04, 10, &now);
+	CHECK(debounceGetEvent(&event));
+	CHECK_EQ(event.type, DEBOUNCE_PRESS);
+	CHECK_EQ(event.pin, 2);
+	CHECK_EQ(event.time, 65000 + DEBOUNCE_SAMPLES - 1);
+	CHECK(!debounceGetEvent(&event));
+
+	run(0x04, DEBOUNCE_LONG_PRESS, &now);			// Held => one long press
+	CHECK(debounceGetEvent(&event));
+	CHECK_EQ(event.type, DEBOUNCE_LONG);
+	run(0x04, 3000, &now);
+	CHECK(!debounceGetEvent(&event));
+
+	run(0x00, 100, &now);							// Release, press again soon => double press
+	run(0x04, 100, &now);
+	CHECK(debounceGetEvent(&event));
+	CHECK_EQ(event.type, DEBOUNCE_RELEASE);
+	CHECK(debounceGetEvent(&event));
+	CHECK_EQ(event.type, DEBOUNCE_PRESS);
+	CHECK(!debounceGetEvent(&event));				// First press was too long ago
+
+	run(0x00, 100, &now);
+	run(0x04, 100, &now);
+	CHECK(debounceGetEvent(&event));
+	CHECK(debounceGetEvent(&event));
+	CHECK(debounceGetEvent(&event));
+	CHECK_EQ(event.type, DEBOUNCE_DOUBLE);
+	run(0x00, 100, &now);
+	CHECK(debounceGetEvent(&event));
+	CHECK(!debounceGetEvent(&event));
+
+	run(0xFF, 10, &now);							// 8 presses and 8 releases, the queue holds 7
+	run(0x00, 10, &now);
+	CHECK_EQ(debounceOverflows, 16 - (DEBOUNCE_QUEUE_SIZE - 1));
+}
+#endif
+
+int main(void) {
+	testAgainstReference();
+	testBouncePattern();
+	testGlitch();
+	testNoWrap();
+#ifdef DEBOUNCE_QUEUE_SIZE
+	testEvents();
+#endif
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,154 @@
+/*
+ * Host test for the Timer1 input capture backend of the DHT22 decoder (user-025)
+ *
+ * Author      : rludvik
+ * Description : DHT22icp.c for the ATtiny4313 board. The host start is run by calling the
+ *               Timer0 ISR like the compare match would, then the 42 falling edges of a frame
+ *               are put in ICR1L as Timer1 (8 us tick, CTC with TOP SSD_TICKS_PER_DIGIT - 1)
+ *               would latch them, each followed by TIMER1_CAPT_vect. Frames of random bytes
+ *               at a random Timer1 phase with jittered widths (sensor tolerance) must be
+ *               decoded exactly; a frame with a missing edge ends with the timeout.
+ */
+
+#include <avr/io.h>
+#include "host.h"
+#include "DHT22int_4313.h"
+#include "ssd.h"
+
+#if DHT22_BACKEND != DHT22_ICP
+#error "Built for the input capture backend"
+#endif
+
+#define FRAMES			100000UL
+#define TICK_US			8				// ICP_TICK_US
+
+void TIMER0_COMPA_vect(void);
+void TIMER1_CAPT_vect(void);
+
+static uint8_t frame[5];
+static double edgeUs[ICP_EDGES];
+
+/* Random time between the limits in us */
+static double between(double from, double to) {
+	return from + (to - from) * (hostRandom() % 1001) / 1000.0;
+}
+
+/* Falling edges of a frame with random bytes, from a random Timer1 phase */
+static void makeFrame(void) {
+	double t = between(0, SSD_TICKS_PER_DIGIT * TICK_US);
+	uint8_t i, bit;
+
+	for (i = 0; i < 4; i++) {
+		frame[i] = hostRandom();
+	}
+	frame[4] = frame[0] + frame[1] + frame[2] + frame[3];
+	edgeUs[0] = t;									// Response, P3 starts
+	edgeUs[1] = t += between(75, 85) + between(75, 85);	// P3 + P4
+	for (i = 0; i < DHT22_DATA_BIT_COUNT; i++) {
+		bit = (frame[i / 8] >> (7 - i % 8)) & 1;
+		edgeUs[i + 2] = t += between(48, 55) + (bit ? between(68, 75) : between(22, 30));
+	}
+}
+
+/* Host start: P1 (2 compare matches), P2, then the capture is armed */
+static void start(void) {
+	CHECK_EQ(DHT22_StartReading(), DHT_STARTED);
+	TIMER0_COMPA_vect();
+	TIMER0_COMPA_vect();
+	TIMER0_COMPA_vect();
+	CHECK(TIMSK & (1 << ICIE1));
+}
+
+/* The edges as the capture unit latches them, skip = edge that is lost (ICP_EDGES => none) */
+static void capture(uint8_t skip) {
+	uint8_t i;
+
+	for (i = 0; i < ICP_EDGES; i++) {
+		if (i != skip) {
+			ICR1L = (uint32_t)(edgeUs[i] / TICK_US) % SSD_TICKS_PER_DIGIT;
+			TIMER1_CAPT_vect();
+		}
+	}
+}
+
+/* Random frames with jitter: every one decoded */
+static void testFrames(void) {
+	DHT22_DATA_t data;
+	uint16_t humidity, temperature;
+	uint32_t n, wrong = 0;
+
+	hostReset();
+	hostSeed(25);
+	DHT22_Init();
+	for (n = 0; n < FRAMES; n++) {
+		makeFrame();
+		start();
+		capture(ICP_EDGES);
+		if (DHT22_CheckStatus(&data) != DHT_DATA_READY) {
+			wrong++;
+			continue;
+		}
+		humidity = ((uint16_t)frame[0] << 8) | frame[1];
+		temperature = ((uint16_t)(frame[2] & 0x7F) << 8) | frame[3];
+		if ((data.humidity_integral != (uint8_t)(humidity / 10)) || (data.humidity_decimal != humidity % 10)
+			|| (data.temperature_decimal != temperature % 10)
+			|| (data.temperature_integral != (int8_t)((int8_t)(temperature / 10) * ((frame[2] & 0x80) ? -1 : 1)))) {
+			wrong++;
+		}
+	}
+	printf("  %lu random frames, random Timer1 phase, jittered widths: %lu not decoded right\n",
+		(unsigned long)FRAMES, (unsigned long)wrong);
+	CHECK_EQ(wrong, 0);
+}
+
+/* A lost edge: the frame is never complete, the timeout ends it. The next reading works */
+static void testMissingEdge(void) {
+	DHT22_DATA_t data;
+	uint8_t skip, wrong = 0;
+
+	hostReset();
+	hostSeed(26);
+	DHT22_Init();
+	for (skip = 0; skip < ICP_EDGES; skip++) {
+		makeFrame();
+		start();
+		capture(skip);
+		if (DHT22_CheckStatus(&data) != DHT_TRANSFERING) {
+			wrong++;
+		}
+		TIMER0_COMPA_vect();						// ICP_TIMEOUT_TICKS later
+		if ((DHT22_CheckStatus(&data) != DHT_ERROR_NOT_RESPOND) || (TIMSK & (1 << ICIE1))) {
+			wrong++;
+		}
+	}
+	CHECK_EQ(wrong, 0);
+
+	makeFrame();
+	start();
+	capture(ICP_EDGES);
+	CHECK_EQ(DHT22_CheckStatus(&data), DHT_DATA_READY);
+}
+
+/* A bit that is too short or too long is a checksum error, not a wrong value */
+static void testBadWidth(void) {
+	DHT22_DATA_t data;
+	uint8_t i;
+
+	hostReset();
+	hostSeed(27);
+	DHT22_Init();
+	makeFrame();
+	for (i = 12; i < ICP_EDGES; i++) {
+		edgeUs[i] += 200;							// Bit 10 is 200 us longer
+	}
+	start();
+	capture(ICP_EDGES);
+	CHECK_EQ(DHT22_CheckStatus(&data), DHT_ERROR_CHECKSUM);
+}
+
+int main(void) {
+	testFrames();
+	testMissingEdge();
+	testBadWidth();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,113 @@
+/*
+ * Host test for the fixed point display of OnLCDLib (user-020)
+ *
+ * Author      : rludvik
+ * Description : LCDWriteFixed() for every int16_t value and 0 to 5 decimals, read back
+ *               from the LCD model (hd44780.c) and compared with printf.
+ *               Every DHT22 reading is also drawn the old way, the tenths converted to
+ *               float and shown with LCDWriteFloat(value, 0, 2) as the demo did, which
+ *               must give the same number. Built with LCD_DISPLAY_FLOATS TRUE for that,
+ *               and in the write-only mode to keep the run short (see Makefile).
+ *               Flash size on the AVR: "make size" (needs avr-gcc, see lcd_size.c).
+ */
+
+#define F_CPU			8000000UL
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+#include <util/delay.h>
+#include "host.h"
+#include "hd44780.h"
+#include "OnLCDLib.h"
+
+#if LCD_INTERFACE != LCD_PARALLEL || LCD_DATA_BUS_SIZE != LCD_DATA_4_BITS || LCD_DATA_START_PIN != 4 \
+	|| LCD_RS_PIN != PD0 || LCD_RW_PIN != PD1 || LCD_E_PIN != PD2
+#error "hd44780.c is wired like the DHT boards"
+#endif
+
+static void setup(void) {
+	hostReset();
+	lcdModelReset(LCD_CONTROLLER, LCD_MODEL_BUS4, F_CPU);
+	LCDSetup(LCD_CURSOR_NONE);
+	CHECK(lcdInitialized());
+}
+
+/* What the LCD should show: value / 10^decimals, all the decimals, at least one digit before the point */
+static void reference(int16_t value, uint8_t decimals, char *text) {
+	static const uint16_t power[] = {1, 10, 100, 1000, 10000};
+	uint16_t number = (value < 0) ? -(int32_t)value : value;
+
+	if (decimals > LCD_MAXIMUM_DECIMALS) {
+		decimals = LCD_MAXIMUM_DECIMALS;
+	}
+	if (decimals == 0) {
+		sprintf(text, "%s%u", (value < 0) ? "-" : "", number);
+	} else {
+		sprintf(text, "%s%u.%0*u", (value < 0) ? "-" : "", number / power[decimals], decimals,
+			number % power[decimals]);
+	}
+}
+
+static void testAllValues(void) {
+	int32_t value;
+	uint8_t decimals;
+	uint32_t wrong = 0;
+	char text[12];
+
+	setup();
+	for (decimals = 0; decimals <= LCD_MAXIMUM_DECIMALS + 1; decimals++) {
+		for (value = -32768; value <= 32767; value++) {
+			LCDClear();
+			LCDWriteFixed(value, decimals);
+			reference(value, decimals, text);
+			if (!lcdRowIs(0, text)) {
+				if (wrong++ < 5) {
+					printf("  LCDWriteFixed(%ld, %u) should show \"%s\"\n", (long)value, decimals, text);
+				}
+			}
+		}
+	}
+	CHECK_EQ(wrong, 0);
+
+	LCDClear();
+	LCDWriteFixed(-5, 1);
+	CHECK(lcdRowIs(0, "-0.5"));
+	LCDClear();
+	LCDWriteFixed(5, 2);
+	CHECK(lcdRowIs(0, "0.05"));
+	LCDClear();
+	LCDWriteFixed(-32768, 4);
+	CHECK(lcdRowIs(0, "-3.2768"));
+}
+
+/* The old display of the DHT22 demo: float tenths, 2 decimals */
+static void testSameAsFloat(void) {
+	int16_t value;
+	char text[12], old[12];
+	uint32_t readings = 0, wrong = 0;
+
+	setup();
+	for (value = -400; value <= 1000; value++) {		// -40.0 to 80.0 C, 0 to 100.0 %
+		LCDClear();
+		LCDWriteFloat((float)value / 10.0, 0, 2);
+		memcpy(old, lcdRow(0), 8);
+		old[8] = 0;
+		reference(value, 1, text);
+		strcat(text, "0");
+		if (!lcdRowIs(0, text)) {
+			if (wrong++ < 5) {
+				printf("  %d tenths: float shows \"%s\", fixed \"%s\"\n", value, old, text);
+			}
+		}
+		readings++;
+	}
+	printf("  %lu DHT22 readings: float path shows another number for %lu of them\n",
+		(unsigned long)readings, (unsigned long)wrong);
+	CHECK_EQ(wrong, 0);
+}
+
+int main(void) {
+	testAllValues();
+	testSameAsFloat();
+	return hostResult(TEST_NAME);
+}
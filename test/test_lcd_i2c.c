@@ -0,0 +1,129 @@
+/*
+ * Host test for the PCF8574 I2C backpack transport of OnLCDLib (user-023)
+ *
+ * Author      : rludvik
+ * Description : Built with LCD_INTERFACE LCD_I2C and without the shadow buffer (see Makefile).
+ *               The TWI master of hd44780.c runs the library's TWI interrupt and passes every
+ *               byte the PCF8574 receives to the LCD model on its outputs, which checks the
+ *               4-bit protocol and the timing. Counted: bytes per character, TWI transactions
+ *               per write, time per character at LCD_I2C_SCL_HZ.
+ */
+
+#define F_CPU			8000000UL
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include "host.h"
+#include "hd44780.h"
+#include "OnLCDLib.h"
+
+#if LCD_INTERFACE != LCD_I2C || LCD_I2C_RS != 0x01 || LCD_I2C_E != 0x04 || LCD_I2C_BACKLIGHT != 0x08
+#error "hd44780.c is wired like the usual PCF8574 backpack"
+#endif
+
+static void setup(void) {
+	hostReset();
+	lcdModelReset(LCD_CONTROLLER, LCD_MODEL_I2C, F_CPU);
+	lcdI2CAddress = LCD_I2C_ADDRESS;
+	lcdTwiIsr = TWI_vect;
+	lcdQueueIdle = LCDQueueIdle;
+	sei();
+	LCDSetup(LCD_CURSOR_NONE);
+	CHECK(lcdDrain());
+	CHECK(lcdInitialized());
+	CHECK(lcdRowIs(0, "") && lcdRowIs(1, ""));
+}
+
+/* A string is one transaction, 4 bytes per character, nothing waits in the main code */
+static void testString(void) {
+	uint32_t bytes, transactions;
+	double startUs, waitUs;
+
+	setup();
+	bytes = lcdI2CBytes;
+	transactions = lcdI2CTransactions;
+	lcdWaitUs = 0;
+	startUs = lcdTimeUs;
+	LCDWriteString("Temp: 23.5");
+	waitUs = lcdWaitUs;
+	CHECK(lcdDrain());
+	bytes = lcdI2CBytes - bytes;
+	transactions = lcdI2CTransactions - transactions;
+	CHECK(lcdRowIs(0, "Temp: 23.5"));
+	CHECK_EQ(transactions, 1);
+	CHECK_EQ(bytes, 10 * 4);
+	CHECK(waitUs == 0);
+	printf("  10 characters at %lu Hz: %lu transaction, %lu PCF8574 bytes, %.0f us per character, "
+		"the calls wait %.0f us\n", (unsigned long)LCD_I2C_SCL_HZ, (unsigned long)transactions,
+		(unsigned long)bytes, (lcdReadyUs - startUs) / 10, waitUs);
+	printf("  a transaction per character would add start, address and stop: %.0f us per character\n",
+		(lcdReadyUs - startUs) / 10 + 11 * 1e6 / LCD_I2C_SCL_HZ);
+}
+
+/* Clear and return home are padded with repeated bytes until they are done */
+static void testScreen(void) {
+	uint32_t bytes;
+
+	setup();
+	LCDWriteString("old text");
+	LCDClear();
+	LCDWriteString("Temp:     23.5");
+	LCDData(LCD_SPECIAL_SYMBOL_DEGREE);
+	LCDData('C');
+	LCDGotoXY(1, 2);
+	LCDWriteString("Humidity: 45.6 %");
+	LCDHome();
+	LCDData('t');
+	bytes = lcdI2CBytes;
+	CHECK(lcdDrain());
+	CHECK(lcdRowIs(0, "temp:     23.5\xDF" "C"));
+	CHECK(lcdRowIs(1, "Humidity: 45.6 %"));
+	CHECK(lcdI2CBytes > bytes);
+	CHECK_EQ(lcdErrors, 0);
+	CHECK_EQ(lcdI2CDark, 0);
+}
+
+/* More than the queue holds: the main code waits for free places, one transaction still */
+static void testQueueFull(void) {
+	uint32_t transactions;
+	uint8_t i;
+
+	setup();
+	transactions = lcdI2CTransactions;
+	lcdWaitUs = 0;
+	for (i = 0; i < 3; i++) {
+		LCDGotoXY(1, 1);
+		LCDWriteString("0123456789ABCDEF");
+		LCDGotoXY(1, 2);
+		LCDWriteString("FEDCBA9876543210");
+	}
+	CHECK(lcdWaitUs > 0);
+	CHECK(lcdDrain());
+	CHECK(lcdRowIs(0, "0123456789ABCDEF"));
+	CHECK(lcdRowIs(1, "FEDCBA9876543210"));
+	CHECK_EQ(lcdI2CTransactions - transactions, 1);
+	CHECK_EQ(lcdErrors, 0);
+}
+
+/* No ACK from the backpack: the queue is dropped, nothing hangs, the LCD works again when it answers */
+static void testNoAnswer(void) {
+	setup();
+	lcdI2CAddress = LCD_I2C_ADDRESS ^ 0x01;
+	LCDWriteString("lost");
+	CHECK(lcdDrain());
+	CHECK(lcdRowIs(0, ""));
+
+	lcdI2CAddress = LCD_I2C_ADDRESS;
+	LCDWriteString("back");				// Right away, the stop condition is still on the bus
+	CHECK(lcdDrain());
+	CHECK(lcdRowIs(0, "back"));
+	CHECK_EQ(lcdErrors, 0);
+}
+
+int main(void) {
+	testString();
+	testScreen();
+	testQueueFull();
+	testNoAnswer();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,114 @@
+/*
+ * Host test for the asynchronous write queue of OnLCDLib (user-018)
+ *
+ * Author      : rludvik
+ * Description : Built with LCD_ASYNC TRUE and FALSE (see Makefile), both without the shadow
+ *               buffer so every call goes to the LCD. The LCD is the HD44780 model in
+ *               hd44780.c on the 4-bit bus of the DHT boards.
+ *               For a full-screen update the CPU time the calls block (delays and the
+ *               busy flag loop) is measured, and the Timer2 interrupt time it costs instead.
+ *               The blocking build is today's blocking path, with the datasheet timing of
+ *               user-022 (short enable pulse, busy flag). The library before the queue held
+ *               E high for 50 us per nibble, that one is not built here.
+ */
+
+#define F_CPU			8000000UL
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include "host.h"
+#include "hd44780.h"
+#include "OnLCDLib.h"
+
+#if LCD_INTERFACE != LCD_PARALLEL || LCD_DATA_BUS_SIZE != LCD_DATA_4_BITS || LCD_DATA_START_PIN != 4 \
+	|| LCD_RS_PIN != PD0 || LCD_RW_PIN != PD1 || LCD_E_PIN != PD2
+#error "hd44780.c is wired like the DHT boards"
+#endif
+
+#define ISR_CYCLES		50				// Entry, exit and the queue handling of one interrupt, about
+
+#if LCD_ASYNC == TRUE
+	#define MODE		"queue"
+#else
+	#define MODE		"blocking, busy flag"
+#endif
+
+static void setup(void) {
+	hostReset();
+	lcdModelReset(LCD_CONTROLLER, LCD_MODEL_BUS4, F_CPU);
+#if LCD_ASYNC == TRUE
+	lcdTimer2Isr = TIMER2_COMPA_vect;
+	lcdQueueIdle = LCDQueueIdle;
+#endif
+	sei();
+	LCDSetup(LCD_CURSOR_NONE);
+	CHECK(lcdDrain());
+	CHECK(lcdInitialized());
+	CHECK(lcdRowIs(0, "") && lcdRowIs(1, ""));
+}
+
+/* Full screen as the DHT text display would do it: 32 characters */
+static void fullScreen(uint8_t clear) {
+	if (clear) {
+		LCDClear();
+	}
+	LCDHome();
+	LCDWriteString("Temp:     23.5 C");
+	LCDGotoXY(1, 2);
+	LCDWriteString("Humidity: ");
+	LCDWriteFixed(456, 1);
+	LCDWriteString(" %");
+}
+
+static void measure(const char *name, uint8_t clear) {
+	double waitUs, startUs;
+	uint32_t isrCalls;
+
+	setup();
+	lcdWaitUs = lcdIsrUs = 0;
+	lcdIsrCalls = 0;
+	startUs = lcdTimeUs;
+	fullScreen(clear);
+	waitUs = lcdWaitUs;
+	CHECK(lcdDrain());
+	isrCalls = lcdIsrCalls;
+	CHECK(lcdRowIs(0, "Temp:     23.5 C"));
+	CHECK(lcdRowIs(1, "Humidity: 45.6 %"));
+	printf("  %-19s %-28s calls block the CPU %7.1f us | ISR %2lu calls, %5.1f us | on the LCD after %6.1f us\n",
+		MODE, name, waitUs, (unsigned long)isrCalls, lcdIsrUs + isrCalls * ISR_CYCLES * 1e6 / F_CPU,
+		lcdReadyUs - startUs);
+#if LCD_ASYNC == TRUE
+	CHECK(waitUs == 0);								// Nothing waits, not even for the clear
+	CHECK(isrCalls <= lcdCommands + lcdCharacters + (clear ? LCD_ASYNC_LONG_TICKS : 0) + 2);
+#else
+	CHECK(waitUs > 32 * LCD_PROFILE_DATA_US);		// The busy flag loop waits for every character
+#endif
+}
+
+#if LCD_ASYNC == TRUE
+/* More than the queue holds: LCDByte() waits for a free place, nothing is lost */
+static void testQueueFull(void) {
+	uint8_t i;
+
+	setup();
+	lcdWaitUs = 0;
+	for (i = 0; i < 4; i++) {
+		fullScreen(1);
+	}
+	CHECK(lcdWaitUs > 0);
+	CHECK(lcdDrain());
+	CHECK(lcdRowIs(0, "Temp:     23.5 C"));
+	CHECK(lcdRowIs(1, "Humidity: 45.6 %"));
+	lcdRun(LCD_ASYNC_TICK_US + 1);
+	CHECK(!(TIMSK2 & (1 << OCIE2A)));				// Off at the next tick with an empty queue
+}
+#endif
+
+int main(void) {
+	measure("32 characters + 2 commands", 0);
+	measure("clear + the same", 1);
+#if LCD_ASYNC == TRUE
+	testQueueFull();
+#endif
+	return hostResult(TEST_NAME);
+}
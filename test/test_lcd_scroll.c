@@ -0,0 +1,211 @@
+/*
+ * Host test for the scrolling texts of OnLCDLib (user-024)
+ *
+ * Author      : rludvik
+ * Description : Built as the DHT22 demo uses the library (asynchronous queue, shadow buffer)
+ *               and without the shadow buffer (see Makefile). LCDAnimate() is called with the
+ *               speed of the text, so every call is one step, and the lines the LCD model
+ *               (hd44780.c) shows are compared with the window of the text for that step.
+ *               Checked: a region on line 2 while line 1 keeps scrolling its own, the same
+ *               region set again keeps its position, LCDScrollText() with the display shift
+ *               (1 byte per step) and with a text too long for it (a region on line 1).
+ */
+
+#define F_CPU			8000000UL
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <string.h>
+#include "host.h"
+#include "hd44780.h"
+#include "OnLCDLib.h"
+
+#if LCD_INTERFACE != LCD_PARALLEL || LCD_DATA_BUS_SIZE != LCD_DATA_4_BITS || LCD_DATA_START_PIN != 4 \
+	|| LCD_RS_PIN != PD0 || LCD_RW_PIN != PD1 || LCD_E_PIN != PD2
+#error "hd44780.c is wired like the DHT boards"
+#endif
+
+#if LCD_ANIMATIONS != TRUE || LCD_ASYNC != TRUE
+#error "Built with the animations and the queue, as the DHT22 demo"
+#endif
+
+#define SPEED			100				// ms per step
+#define DDRAM_LINE		40				// LCD_DDRAM_LINE
+
+static const char lineOne[] = "Checksum error";
+static const char lineTwo[] = "Check the sensor wiring";
+static const char shortText[] = "Hello, world";									// Fits beside the visible part
+static const char longText[] = "This text is longer than the hidden part of line 1";
+
+static void setup(void) {
+	hostReset();
+	lcdModelReset(LCD_CONTROLLER, LCD_MODEL_BUS4, F_CPU);
+	lcdTimer2Isr = TIMER2_COMPA_vect;
+	lcdQueueIdle = LCDQueueIdle;
+	sei();
+	LCDSetup(LCD_CURSOR_NONE);
+	LCDScrollStop(1);
+	LCDScrollStop(2);
+	CHECK(lcdDrain());
+	CHECK(lcdInitialized());
+}
+
+static void flush(void) {
+#if LCD_SHADOW == TRUE
+	LCDFlush();
+#endif
+	CHECK(lcdDrain());
+}
+
+/* ms of LCDAnimate(), one step of the regions with that speed, returns the bytes the LCD got */
+static uint32_t step(uint16_t ms) {
+	uint32_t bytes = lcdCommands + lcdCharacters;
+
+	LCDAnimate(ms);
+	flush();
+	return lcdCommands + lcdCharacters - bytes;
+}
+
+/* The region shows the text as it is after the step (LCDScrollDraw()) */
+static uint8_t shows(uint8_t row, uint8_t x, uint8_t width, const char *text, uint16_t step) {
+	const uint8_t *line = lcdRow(row);
+	uint16_t length = strlen(text);
+	int16_t i;
+	uint8_t column;
+
+	step %= length + width;
+	for (column = 0; column < width; column++) {
+		i = (int16_t)(step + column) - width;
+		if (line[x + column] != ((i >= 0 && i < length) ? (uint8_t)text[i] : ' ')) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Line 1 scrolls in 8 columns, then line 2 gets a region: line 1 keeps going, the rest stays */
+static void testTwoRegions(void) {
+	uint16_t steps, wrong = 0;
+
+	setup();
+	LCDWriteStringXY(10, 1, "T:23");
+	LCDScrollRegion(1, 1, 8, lineOne, SPEED);
+	flush();
+	CHECK(shows(0, 0, 8, lineOne, 0));
+	for (steps = 1; steps <= 5; steps++) {
+		step(SPEED);
+	}
+	CHECK(shows(0, 0, 8, lineOne, 5));
+
+	LCDScrollRegion(3, 2, 12, lineTwo, SPEED);
+	flush();
+	CHECK(shows(0, 0, 8, lineOne, 5));
+	CHECK(shows(1, 2, 12, lineTwo, 0));
+	for (steps = 1; steps <= 100; steps++) {
+		step(SPEED);
+		if (!shows(0, 0, 8, lineOne, 5 + steps) || !shows(1, 2, 12, lineTwo, steps)
+			|| memcmp(lcdRow(0) + 8, " T:23   ", 8) || memcmp(lcdRow(1), "  ", 2) || memcmp(lcdRow(1) + 14, "  ", 2)) {
+			wrong++;
+		}
+	}
+	CHECK_EQ(wrong, 0);
+	CHECK_EQ(lcdErrors, 0);
+
+	LCDScrollStop(2);							// Line 1 goes on, line 2 stays where it is
+	step(SPEED);
+	CHECK(shows(0, 0, 8, lineOne, 106));
+	CHECK(shows(1, 2, 12, lineTwo, 100));
+}
+
+/* The demo sets the region again on every bad reading: the text goes on from where it is */
+static void testSameRegion(void) {
+	uint16_t steps;
+
+	setup();
+	LCDScrollRegion(1, 2, LCD_NR_OF_CHARACTERS, lineTwo, SPEED);
+	flush();
+	for (steps = 1; steps <= 20; steps++) {
+		step(SPEED);
+		LCDScrollRegion(1, 2, LCD_NR_OF_CHARACTERS, lineTwo, SPEED);
+		flush();
+		CHECK(shows(1, 0, LCD_NR_OF_CHARACTERS, lineTwo, steps));
+	}
+	LCDScrollRegion(1, 2, LCD_NR_OF_CHARACTERS, lineTwo, 2 * SPEED);	// Slower, still from there
+	LCDAnimate(SPEED);
+	flush();
+	CHECK(shows(1, 0, LCD_NR_OF_CHARACTERS, lineTwo, 20));
+	LCDAnimate(SPEED);
+	flush();
+	CHECK(shows(1, 0, LCD_NR_OF_CHARACTERS, lineTwo, 21));
+
+	LCDScrollRegion(1, 2, LCD_NR_OF_CHARACTERS, lineOne, SPEED);		// Another text starts over
+	flush();
+	CHECK(shows(1, 0, LCD_NR_OF_CHARACTERS, lineOne, 0));
+}
+
+/* A short text is written once beside the visible part, the display shift moves it */
+static void testHardware(void) {
+	uint32_t bytes, most = 0;
+	uint16_t steps, wrong = 0;
+	uint8_t column;
+	int16_t i;
+
+	setup();
+	LCDScrollText(shortText);
+	flush();
+	CHECK(LCDScrollHardware);
+	for (steps = 1; steps <= 2 * DDRAM_LINE; steps++) {
+		bytes = step(LCD_SCROLL_SPEED);
+		if (bytes > most) {
+			most = bytes;
+		}
+		for (column = 0; column < LCD_NR_OF_CHARACTERS; column++) {
+			i = (column + steps) % DDRAM_LINE - LCD_NR_OF_CHARACTERS;		// Text index in this column
+			if (lcdRow(0)[column] != ((i >= 0 && i < (int16_t)strlen(shortText)) ? (uint8_t)shortText[i] : ' ')) {
+				wrong++;
+				break;
+			}
+		}
+	}
+	printf("  display shift: %u steps, %lu byte per step at most, %u wrong screens\n", steps - 1,
+		(unsigned long)most, wrong);
+	CHECK_EQ(most, 1);
+	CHECK_EQ(wrong, 0);
+	CHECK_EQ(lcdErrors, 0);
+
+	LCDScrollStop(1);							// Shift undone
+	flush();
+	CHECK(lcdRowIs(0, ""));
+	CHECK(!LCDScrollHardware);
+}
+
+/* Too long for the hidden part of the line: a region over the whole of line 1 */
+static void testOverLength(void) {
+	uint32_t bytes = 0;
+	uint16_t steps, wrong = 0;
+
+	CHECK(strlen(longText) > LCD_SCROLL_HARDWARE_MAX);
+	setup();
+	LCDScrollText(longText);
+	flush();
+	CHECK(!LCDScrollHardware);
+	CHECK(shows(0, 0, LCD_NR_OF_CHARACTERS, longText, 0));
+	for (steps = 1; steps <= 2 * (sizeof(longText) - 1 + LCD_NR_OF_CHARACTERS); steps++) {
+		bytes += step(LCD_SCROLL_SPEED);
+		if (!shows(0, 0, LCD_NR_OF_CHARACTERS, longText, steps)) {
+			wrong++;
+		}
+	}
+	printf("  %u characters, too long for the shift: redrawn, %.1f bytes per step, %u wrong screens\n",
+		(unsigned)(sizeof(longText) - 1), (double)bytes / (steps - 1), wrong);
+	CHECK_EQ(wrong, 0);
+	CHECK_EQ(lcdErrors, 0);
+}
+
+int main(void) {
+	testTwoRegions();
+	testSameRegion();
+	testHardware();
+	testOverLength();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,159 @@
+/*
+ * Host test for the shadow screen buffer of OnLCDLib (user-019)
+ *
+ * Author      : rludvik
+ * Description : Built with LCD_SHADOW TRUE and FALSE (see Makefile), with the asynchronous
+ *               queue as on the DHT boards. The screens of the DHT11 and DHT22 demos, and one
+ *               with labels, are drawn for 1000 readings of a slowly changing room the way
+ *               the main loops do it: clear, write everything, flush. The bytes the LCD
+ *               receives per update are counted by the LCD model (hd44780.c).
+ */
+
+#define F_CPU			8000000UL
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include "host.h"
+#include "hd44780.h"
+#include "OnLCDLib.h"
+
+#if LCD_INTERFACE != LCD_PARALLEL || LCD_DATA_BUS_SIZE != LCD_DATA_4_BITS || LCD_DATA_START_PIN != 4 \
+	|| LCD_RS_PIN != PD0 || LCD_RW_PIN != PD1 || LCD_E_PIN != PD2
+#error "hd44780.c is wired like the DHT boards"
+#endif
+
+#define READINGS		1000
+
+static void setup(void) {
+	hostReset();
+	lcdModelReset(LCD_CONTROLLER, LCD_MODEL_BUS4, F_CPU);
+	lcdTimer2Isr = TIMER2_COMPA_vect;
+	lcdQueueIdle = LCDQueueIdle;
+	sei();
+	LCDSetup(LCD_CURSOR_NONE);
+	CHECK(lcdDrain());
+	CHECK(lcdInitialized());
+}
+
+static void flush(void) {
+#if LCD_SHADOW == TRUE
+	LCDFlush();
+#endif
+	CHECK(lcdDrain());
+}
+
+/* DHT11_onLCD: whole degrees and percents, DHT11DisplayTemperature() and DHT11DisplayHumidity() */
+static void screenDht11(int16_t temperature, int16_t humidity, char *top, char *bottom) {
+	LCDClear();
+	LCDWriteInt(temperature / 10, 2);
+	LCDData(LCD_SPECIAL_SYMBOL_DEGREE);
+	LCDData('C');
+	LCDGotoXY(1, 2);
+	LCDWriteInt(humidity / 10, 2);
+	LCDData(' ');
+	LCDData('%');
+	sprintf(top, "%02d\xDF" "C", temperature / 10);
+	sprintf(bottom, "%02d %%", humidity / 10);
+}
+
+/* DHT22_OnLCD text display: tenths */
+static void screenDht22(int16_t temperature, int16_t humidity, char *top, char *bottom) {
+	LCDClear();
+	LCDWriteFixed(temperature, 1);
+	LCDGotoXY(1, 2);
+	LCDWriteFixed(humidity, 1);
+	sprintf(top, "%d.%d", temperature / 10, temperature % 10);
+	sprintf(bottom, "%d.%d", humidity / 10, humidity % 10);
+}
+
+/* Labels and units, most of the screen stays the same */
+static void screenLabels(int16_t temperature, int16_t humidity, char *top, char *bottom) {
+	LCDClear();
+	LCDWriteString("Temp:");
+	LCDGotoXY(11, 1);
+	LCDWriteFixed(temperature, 1);
+	LCDData(LCD_SPECIAL_SYMBOL_DEGREE);
+	LCDData('C');
+	LCDGotoXY(1, 2);
+	LCDWriteString("Humidity:");
+	LCDGotoXY(11, 2);
+	LCDWriteFixed(humidity, 1);
+	LCDWriteString(" %");
+	sprintf(top, "Temp:     %d.%d\xDF" "C", temperature / 10, temperature % 10);
+	sprintf(bottom, "Humidity: %d.%d %%", humidity / 10, humidity % 10);
+}
+
+static void measure(const char *name, void (*screen)(int16_t, int16_t, char *, char *)) {
+	int16_t temperature = 215, humidity = 455;
+	uint32_t bytes, total = 0, least = 0xFFFFFFFFUL, most = 0;
+	uint16_t i;
+	char top[20], bottom[20];
+
+	setup();
+	hostSeed(19);
+	for (i = 0; i < READINGS; i++) {
+		temperature += (int16_t)(hostRandom() % 3) - 1;		// DHT22 resolution 0.1
+		humidity += (int16_t)(hostRandom() % 7) - 3;
+		bytes = lcdCommands + lcdCharacters;
+		screen(temperature, humidity, top, bottom);
+		flush();
+		bytes = lcdCommands + lcdCharacters - bytes;
+		CHECK(lcdRowIs(0, top));
+		CHECK(lcdRowIs(1, bottom));
+		if (i == 0) {
+			continue;									// First screen after the setup
+		}
+		total += bytes;
+		if (bytes < least) {
+			least = bytes;
+		}
+		if (bytes > most) {
+			most = bytes;
+		}
+	}
+	printf("  %-7s screen: %5.2f bytes per update (%2lu to %2lu)\n", name, (double)total / (READINGS - 1),
+		(unsigned long)least, (unsigned long)most);
+}
+
+#if LCD_SHADOW == TRUE
+/* Random text at random places, the LCD always shows what the shadow has */
+static void testRandomWrites(void) {
+	char expected[2][LCD_MODEL_COLUMNS + 1], text[LCD_MODEL_COLUMNS + 1];
+	uint16_t i;
+	uint8_t j, writes, x, y, length;
+
+	setup();
+	memset(expected, ' ', sizeof(expected));
+	expected[0][LCD_MODEL_COLUMNS] = expected[1][LCD_MODEL_COLUMNS] = 0;
+	hostSeed(91);
+	for (i = 0; i < 2000; i++) {
+		writes = hostRandom() % 4;
+		for (j = 0; j < writes; j++) {
+			x = 1 + hostRandom() % LCD_MODEL_COLUMNS;
+			y = 1 + hostRandom() % 2;
+			length = 1 + hostRandom() % (LCD_MODEL_COLUMNS - x + 1);
+			text[length] = 0;
+			while (length--) {
+				text[length] = 'a' + hostRandom() % 4;			// Few letters, often the same as before
+			}
+			LCDWriteStringXY(x, y, text);
+			memcpy(&expected[y - 1][x - 1], text, strlen(text));
+		}
+		flush();
+		CHECK(lcdRowIs(0, expected[0]));
+		CHECK(lcdRowIs(1, expected[1]));
+	}
+}
+#endif
+
+int main(void) {
+	measure("DHT11", screenDht11);
+	measure("DHT22", screenDht22);
+	measure("labeled", screenLabels);
+#if LCD_SHADOW == TRUE
+	testRandomWrites();
+#endif
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,103 @@
+/*
+ * Host test for the timing profiles, the write-only mode and the 8-bit bus of OnLCDLib (user-022)
+ *
+ * Author      : rludvik
+ * Description : Built for the busy flag and the write-only mode on the 4-bit bus of the DHT boards,
+ *               and write-only on an 8-bit bus for each LCD_CONTROLLER (see Makefile). Blocking,
+ *               without the shadow buffer, so every call goes to the LCD right away.
+ *               The LCD model (hd44780.c) with the same controller checks the enable pulse, the
+ *               enable cycle and that nothing is written while the LCD is busy. The time the
+ *               calls wait per character is compared with the datasheet execution time.
+ */
+
+#define F_CPU			8000000UL
+#include <avr/io.h>
+#include <util/delay.h>
+#include "host.h"
+#include "hd44780.h"
+#include "OnLCDLib.h"
+
+#if LCD_INTERFACE != LCD_PARALLEL || LCD_ASYNC != FALSE || LCD_SHADOW != FALSE || LCD_RS_PIN != PD0 \
+	|| LCD_RW_PIN != PD1 || LCD_E_PIN != PD2 || (LCD_DATA_BUS_SIZE == LCD_DATA_4_BITS && LCD_DATA_START_PIN != 4)
+#error "hd44780.c is wired like the DHT boards"
+#endif
+
+#if LCD_DATA_BUS_SIZE == LCD_DATA_8_BITS
+	#define BUS			LCD_MODEL_BUS8
+#else
+	#define BUS			LCD_MODEL_BUS4
+#endif
+
+#define CHARACTERS		32
+
+static const char *controllers[] = {"HD44780", "ST7066", "KS0066"};
+
+static void setup(void) {
+	hostReset();
+	lcdModelReset(LCD_CONTROLLER, BUS, F_CPU);
+	LCDSetup(LCD_CURSOR_NONE);
+	CHECK(lcdInitialized());
+	CHECK_EQ(lcdErrors, 0);
+}
+
+/* Full screen one character at a time, the wait per character */
+static void testCharacters(void) {
+	char text[CHARACTERS + 1];
+	uint8_t i;
+	double perCharacter;
+
+	setup();
+	for (i = 0; i < CHARACTERS; i++) {
+		text[i] = 'A' + i % 26;
+	}
+	text[CHARACTERS] = 0;
+	lcdWaitUs = 0;
+	for (i = 0; i < CHARACTERS; i++) {
+		if (i == LCD_MODEL_COLUMNS) {
+			LCDGotoXY(1, 2);
+		}
+		LCDData(text[i]);
+	}
+	perCharacter = lcdWaitUs / CHARACTERS;
+	CHECK(lcdRowIs(0, "ABCDEFGHIJKLMNOP"));
+	CHECK(lcdRowIs(1, "QRSTUVWXYZABCDEF"));
+	CHECK_EQ(lcdErrors, 0);
+	printf("  %-7s %d-bit %-10s %5.1f us per character (datasheet %d us), %4.1f characters/ms\n",
+		controllers[LCD_CONTROLLER], LCD_DATA_BUS_SIZE, (LCD_WRITE_ONLY == TRUE) ? "write-only" : "busy flag",
+		perCharacter, LCD_PROFILE_DATA_US, 1000.0 / perCharacter);
+#if LCD_WRITE_ONLY == TRUE
+	CHECK(perCharacter < LCD_DATA_WRITE_US + 4);			// The enable pulses on top of the wait
+#else
+	CHECK(perCharacter < LCD_PROFILE_DATA_US + 10);			// The busy flag loop, a few us per poll
+#endif
+}
+
+/* Commands and a clear in between, none of them too early */
+static void testCommands(void) {
+	double waitUs;
+
+	setup();
+	LCDWriteString("Temp:");
+	lcdWaitUs = 0;
+	LCDClear();
+	LCDData('H');			// The busy flag is read before a byte, the wait for the clear is here
+	waitUs = lcdWaitUs;
+	LCDWriteString("umidity:");
+	LCDGotoXY(11, 2);
+	LCDWriteFixed(456, 1);
+	LCDHome();
+	LCDData('h');
+	CHECK(lcdRowIs(0, "humidity:"));
+	CHECK(lcdRowIs(1, "          45.6"));
+	CHECK_EQ(lcdErrors, 0);
+	printf("  %-7s %d-bit %-10s clear and a character %6.1f us (datasheet %d us)\n", controllers[LCD_CONTROLLER],
+		LCD_DATA_BUS_SIZE, (LCD_WRITE_ONLY == TRUE) ? "write-only" : "busy flag", waitUs, LCD_PROFILE_CLEAR_US);
+	CHECK(waitUs >= LCD_PROFILE_CLEAR_US);
+	CHECK(waitUs < LCD_CLEAR_US + LCD_DATA_WRITE_US + 10);
+}
+
+int main(void) {
+	testCharacters();
+	testCommands();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,266 @@
+/*
+ * Host test for the big digits and the CGRAM glyph cache of OnLCDLib (user-021)
+ *
+ * Author      : rludvik
+ * Description : WallDisplay() of the DHT22 demo, compiled from its main.c (see Makefile) with
+ *               the library as the demo sets it up: asynchronous queue, shadow buffer, glyph
+ *               cache. The main loop is done like main.c: clear, WallDisplay(), flush.
+ *               Every temperature from -40.0 to 80.0 C with every humidity is drawn and what
+ *               the LCD model (hd44780.c) shows is compared cell by cell, glyphs by their
+ *               pattern in CGRAM, with a drawing of the number made here from the font tables.
+ *               Bytes sent to the LCD per refresh are counted.
+ *               The sensor reading of main.c runs against a DHT22 on PC5 made here: a good
+ *               frame, no sensor, a line stuck low and a frame that stops after 20 bits.
+ *               Every wait has a timeout, so the wiring hint can be shown.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+#include "hd44780.h"
+
+#define main			dht22Main
+#include "main.c"
+#undef main
+
+#if LCD_INTERFACE != LCD_PARALLEL || LCD_DATA_BUS_SIZE != LCD_DATA_4_BITS || LCD_DATA_START_PIN != 4 \
+	|| LCD_RS_PIN != PD0 || LCD_RW_PIN != PD1 || LCD_E_PIN != PD2
+#error "hd44780.c is wired like the DHT boards"
+#endif
+
+#define GLYPH			0x100			// Expected cell: GLYPH + index in LCDBigGlyphs[], or a character
+#define UPLOAD_BYTES	9				// CGRAM address + 8 rows
+#define SENSOR_BITS		40
+#define SENSOR_LEVELS	(3 + 2 * SENSOR_BITS + 1)	// Answer, bits, end of the frame
+
+/* The DHT22: level and end time (since Response() started) of every part of its frame */
+static double sensorEndUs[SENSOR_LEVELS], sensorStartUs;
+static uint8_t sensorLevel[SENSOR_LEVELS], sensorLevels, sensorIdle;
+static void (*lcdDelay)(double us);
+
+static void setup(void) {
+	hostReset();
+	lcdModelReset(LCD_CONTROLLER, LCD_MODEL_BUS4, F_CPU);
+	lcdTimer2Isr = TIMER2_COMPA_vect;
+	lcdQueueIdle = LCDQueueIdle;
+	memset(LCDGlyphCache, 0, sizeof(LCDGlyphCache));	// CGRAM of the new LCD is empty, so is the cache
+	LCDGlyphTick = LCDGlyphLocked = 0;
+	LCDGlyphUploads = 0;
+	sei();
+	LCDSetup(LCD_CURSOR_NONE);
+	CHECK(lcdDrain());
+	CHECK(lcdInitialized());
+}
+
+/* One pass of the main loop with a good reading, returns the bytes the LCD got */
+static uint32_t refresh(int16_t temperature, int16_t humidity) {
+	uint32_t bytes = lcdCommands + lcdCharacters;
+
+	LCDScrollStop(2);
+	LCDClear();
+	WallDisplay(temperature, humidity);
+	LCDFlush();
+	CHECK(lcdDrain());
+	return lcdCommands + lcdCharacters - bytes;
+}
+
+/* Big number at column x as LCDWriteBigFixed() draws it, returns the column after it */
+static uint8_t drawBig(int16_t expected[2][LCD_MODEL_COLUMNS], uint8_t x, const char *text) {
+	uint8_t n, glyph;
+	char previous = 0;
+
+	for (; *text; previous = *text++) {
+		if (*text == '.') {
+			expected[1][x++] = '.';
+		} else if (*text == '-') {
+			expected[0][x++] = '_';
+		} else {
+			if (previous >= '0') {
+				x++;								// Empty column between two digits
+			}
+			for (n = 0; n < 4; n++) {
+				glyph = LCDBigDigits[*text - '0'][n];
+				expected[n / 2][x + n % 2] = (glyph == LCD_BIG_NONE) ? ' ' : ((glyph == LCD_BIG_BAR) ? '_' : GLYPH + glyph);
+			}
+			x += 2;
+		}
+	}
+	return x;
+}
+
+/* The LCD shows the reading, each custom character with the right pattern */
+static uint8_t shows(int16_t temperature, int16_t humidity) {
+	int16_t expected[2][LCD_MODEL_COLUMNS];
+	uint8_t row, column, x, cell;
+	const uint8_t *line;
+	char text[8];
+
+	for (row = 0; row < 2; row++) {
+		for (column = 0; column < LCD_MODEL_COLUMNS; column++) {
+			expected[row][column] = ' ';
+		}
+	}
+	sprintf(text, "%s%d.%d", (temperature < 0) ? "-" : "", abs(temperature) / 10, abs(temperature) % 10);
+	x = drawBig(expected, 0, text);
+	expected[0][x] = LCD_SPECIAL_SYMBOL_DEGREE;
+	expected[1][x] = 'C';
+	humidity = (humidity + 5) / 10;
+	sprintf(text, "%d", (humidity > 99) ? 99 : humidity);
+	x = drawBig(expected, 10, text);
+	expected[0][x] = '%';
+
+	for (row = 0; row < 2; row++) {
+		line = lcdRow(row);
+		for (column = 0; column < LCD_MODEL_COLUMNS; column++) {
+			cell = line[column];
+			if (expected[row][column] >= GLYPH) {
+				if (cell >= 8 || memcmp(lcdCGRAM(cell), LCDBigGlyphs[expected[row][column] - GLYPH], 8)) {
+					return 0;
+				}
+			} else if (cell != expected[row][column]) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/* Every reading fits in the 8 CGRAM places, no LCD_GLYPH_FALLBACK, glyphs loaded once */
+static void testAllReadings(void) {
+	int16_t temperature, humidity;
+	uint32_t screens = 0, wrong = 0;
+
+	setup();
+	for (temperature = -400; temperature <= 800; temperature++) {
+		for (humidity = 0; humidity <= 1000; humidity += 10) {
+			refresh(temperature, humidity);
+			if (!shows(temperature, humidity)) {
+				if (wrong++ < 5) {
+					printf("  %d tenths C, %d tenths %%: wrong screen\n", temperature, humidity);
+				}
+			}
+			screens++;
+		}
+	}
+	printf("  %lu screens (-40.0 to 80.0 C, 0 to 100 %%): %lu wrong, %u glyph uploads in all\n",
+		(unsigned long)screens, (unsigned long)wrong, LCDGlyphUploads);
+	CHECK_EQ(wrong, 0);
+	CHECK(LCDGlyphUploads <= 8);
+}
+
+/* Bytes per refresh of a room that changes slowly, every 2 s */
+static void testRefreshBytes(void) {
+	int16_t temperature = 215, humidity = 455;
+	uint32_t first, again, bytes = 0;
+	uint16_t i, uploads;
+
+	setup();
+	first = refresh(temperature, humidity);
+	again = refresh(temperature, humidity);
+	uploads = LCDGlyphUploads;
+	hostSeed(21);
+	for (i = 0; i < 1000; i++) {
+		temperature += (int16_t)(hostRandom() % 3) - 1;
+		humidity += (int16_t)(hostRandom() % 7) - 3;
+		bytes += refresh(temperature, humidity);
+		CHECK(shows(temperature, humidity));
+	}
+	printf("  first screen %lu bytes (%u glyphs), the same reading again %lu, 1000 readings %.1f bytes per refresh"
+		" with %u more glyph uploads\n", (unsigned long)first, uploads, (unsigned long)again, bytes / 1000.0,
+		LCDGlyphUploads - uploads);
+	printf("  uploading the 8 glyphs on every refresh would add %u bytes to each\n", 8 * UPLOAD_BYTES);
+	CHECK_EQ(again, 0);
+	CHECK(LCDGlyphUploads <= 8);
+}
+
+/* _delay_us() of main.c: the LCD model runs, the sensor sets the pin */
+static void sensorDelay(double us) {
+	double t;
+	uint8_t i;
+
+	lcdDelay(us);
+	t = lcdTimeUs - sensorStartUs;
+	for (i = 0; i < sensorLevels && t >= sensorEndUs[i]; i++)
+		;
+	PINC = ((i < sensorLevels) ? sensorLevel[i] : sensorIdle) ? (1 << DHT22_PIN) : 0;
+}
+
+/* Frame of the bytes, the first levels of it, then the line stays at idle */
+static void sensorFrame(const uint8_t *bytes, uint8_t levels, uint8_t idle) {
+	static const uint8_t answer[] = {1, 0, 1};
+	static const double answerUs[] = {30, 80, 80};
+	double t = 0;
+	uint8_t i, n = 0, bit;
+
+	for (i = 0; i < 3; i++, n++) {
+		sensorLevel[n] = answer[i];
+		sensorEndUs[n] = t += answerUs[i];
+	}
+	for (i = 0; i < SENSOR_BITS; i++) {
+		bit = (bytes[i / 8] >> (7 - i % 8)) & 1;
+		sensorLevel[n] = 0;
+		sensorEndUs[n++] = t += 50;
+		sensorLevel[n] = 1;
+		sensorEndUs[n++] = t += bit ? 70 : 27;
+	}
+	sensorLevel[n] = 0;
+	sensorEndUs[n] = t + 50;
+	sensorLevels = levels;
+	sensorIdle = idle;
+}
+
+/* One reading as main() does it, returns the time it took in us */
+static double readSensor(void) {
+	double startUs = lcdTimeUs;
+
+	lcdDelay = hostDelayHook;
+	hostDelayHook = sensorDelay;
+	PINC = 1 << DHT22_PIN;
+	Request();
+	sensorStartUs = lcdTimeUs;
+	Response();
+	I_RH = Receive_data();
+	D_RH = Receive_data();
+	I_Temp = Receive_data();
+	D_Temp = Receive_data();
+	CheckSum = Receive_data();
+	hostDelayHook = lcdDelay;
+	return lcdTimeUs - startUs;
+}
+
+/* A good frame is read, a missing sensor or a broken frame ends with dhtTimeout */
+static void testSensor(void) {
+	static const uint8_t frame[5] = {0x01, 0xC8, 0x00, 0xEB, 0xB4};	// 45.6 %, 23.5 C
+	double us, most = 0;
+
+	setup();
+	sensorFrame(frame, SENSOR_LEVELS, 1);
+	readSensor();
+	CHECK(!dhtTimeout);
+	CHECK_EQ(DHT22Humidity(), 456);
+	CHECK_EQ(DHT22Temperature(), 235);
+	CHECK_EQ(CheckSum, 0xB4);
+
+	sensorFrame(frame, 0, 1);				// Nobody pulls the line down
+	us = readSensor();
+	CHECK(dhtTimeout);
+	most = us;
+	sensorFrame(frame, 0, 0);				// Line stuck low
+	us = readSensor();
+	CHECK(dhtTimeout);
+	most = (us > most) ? us : most;
+	sensorFrame(frame, 3 + 2 * 20, 1);		// The sensor stops after 20 bits
+	us = readSensor();
+	CHECK(dhtTimeout);
+	most = (us > most) ? us : most;
+	printf("  no sensor, line low, frame cut after 20 bits: the reading ends after %.1f ms at most\n", most / 1000);
+	CHECK(most < 25000);
+}
+
+int main(void) {
+	testSensor();
+	testRefreshBytes();
+	testAllReadings();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,121 @@
+/*
+ * Host test for the motor PWM ramps of the garage door (user-014)
+ *
+ * Author      : rludvik
+ * Description : motorRampTick() is called once per simulated ms like in the tick ISR of
+ *               main.c. The IN1/IN2 outputs of the VNH2SP30 and the PWM duty are checked
+ *               every ms: ramps up and down, an immediate brake, and a reversal while the
+ *               motor still turns, which must brake to GND until the speed is 0 and never
+ *               switch the other direction on a turning motor.
+ */
+
+#include <avr/io.h>
+#include "host.h"
+#include "settings.h"
+
+#define MOTOR_STOPPED	0				// As in motor.c
+#define MOTOR_OPENING	1
+#define MOTOR_CLOSING	2
+#define IN1				(1 << MOTOR_IN1_PIN)
+#define IN2				(1 << MOTOR_IN2_PIN)
+#define RAMP_UP_MS		((MOTOR_MAX_SPEED + MOTOR_ACCEL_STEP - 1) / MOTOR_ACCEL_STEP * MOTOR_RAMP_PERIOD)
+#define RAMP_DOWN_MS	((MOTOR_MAX_SPEED + MOTOR_DECEL_STEP - 1) / MOTOR_DECEL_STEP * MOTOR_RAMP_PERIOD)
+
+void motorInit();
+void motorOpen();
+void motorClose();
+void motorStop();
+void motorBrake();
+void motorRampTick();
+extern volatile uint8_t motorDirection, motorSpeed;
+
+static void setup(void) {
+	hostReset();
+	motorInit();
+	motorBrake();
+}
+
+/* ms until the speed is the value, at most limit ms */
+static uint16_t runUntil(uint8_t speed, uint16_t limit) {
+	uint16_t ms;
+
+	for (ms = 0; ms < limit && motorSpeed != speed; ms++) {
+		motorRampTick();
+	}
+	return ms;
+}
+
+static void testRamps(void) {
+	uint16_t up, down;
+
+	setup();
+	motorOpen();
+	CHECK((OUTPUT_PORT & (IN1 | IN2)) == IN2);
+	up = runUntil(MOTOR_MAX_SPEED, 1000);
+	CHECK_EQ(OCR2B, MOTOR_MAX_SPEED);
+	motorStop();
+	down = runUntil(0, 1000);
+	motorRampTick();
+	CHECK_EQ(motorDirection, MOTOR_STOPPED);
+	CHECK_EQ(OUTPUT_PORT & (IN1 | IN2), 0);
+	CHECK_EQ(TCCR2B, 0);
+	printf("  ramp up %u ms, down %u ms\n", up, down);
+	CHECK(up <= RAMP_UP_MS + MOTOR_RAMP_PERIOD);
+	CHECK(down <= RAMP_DOWN_MS + MOTOR_RAMP_PERIOD);
+}
+
+/* Emergency, timeout, end switch: no ramp */
+static void testBrake(void) {
+	setup();
+	motorClose();
+	runUntil(MOTOR_MAX_SPEED, 1000);
+	motorBrake();
+	CHECK_EQ(motorSpeed, 0);
+	CHECK_EQ(OCR2B, 0);
+	CHECK_EQ(OUTPUT_PORT & (IN1 | IN2), 0);
+	CHECK_EQ(TCCR2B, 0);
+}
+
+/* Close while it still opens at full speed: brake to GND, then the other way */
+static void testReversal(void) {
+	uint16_t ms, braking = 0, plugged = 0;
+
+	setup();
+	motorOpen();
+	runUntil(MOTOR_MAX_SPEED, 1000);
+	motorClose();
+	for (ms = 0; ms < 1000 && motorDirection != MOTOR_CLOSING; ms++) {
+		if (OUTPUT_PORT & (IN1 | IN2)) {
+			plugged++;
+		}
+		braking++;
+		motorRampTick();
+	}
+	CHECK_EQ(plugged, 0);
+	CHECK_EQ(motorSpeed, 0);
+	CHECK(braking > 0 && braking <= RAMP_DOWN_MS + MOTOR_RAMP_PERIOD);
+	CHECK((OUTPUT_PORT & (IN1 | IN2)) == IN1);
+	runUntil(MOTOR_MAX_SPEED, 1000);
+	CHECK_EQ(motorSpeed, MOTOR_MAX_SPEED);
+	printf("  reversal at full speed: brake to GND %u ms, then closing\n", braking);
+
+	motorOpen();								// The same the other way, stopped on the way
+	runUntil(MOTOR_MAX_SPEED / 2, 1000);
+	CHECK_EQ(OUTPUT_PORT & (IN1 | IN2), 0);
+	motorStop();								// Stop during the brake: no start afterwards
+	runUntil(0, 1000);
+	motorRampTick();
+	CHECK_EQ(motorDirection, MOTOR_STOPPED);
+	CHECK_EQ(OUTPUT_PORT & (IN1 | IN2), 0);
+
+	motorOpen();								// From standstill it starts right away
+	CHECK_EQ(motorDirection, MOTOR_OPENING);
+	CHECK((OUTPUT_PORT & (IN1 | IN2)) == IN2);
+}
+
+int main(void) {
+	testRamps();
+	testBrake();
+	testReversal();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,181 @@
+/*
+ * Host test for the door position estimate and its EEPROM record (user-016)
+ *
+ * Author      : rludvik
+ * Description : position.c is included, so the test sees the record and the two slots.
+ *               motorWork is set by the test like motorRampTick() would add it up.
+ *               A save is cut off after every number of EEPROM bytes (power loss), also
+ *               in the middle of a byte, and the record loaded afterwards must be the
+ *               old or the new one, never a mix. The estimate is checked on runs longer
+ *               than 17 s, where work * POSITION_FULL doesn't fit in 32 bits.
+ */
+
+#include <string.h>
+#include "host.h"
+
+volatile uint32_t motorWork = 0;
+volatile uint8_t motorDirection = 0;
+uint8_t motorSlows = 0;
+
+void motorSlow() {
+	motorSlows = 1;
+}
+
+uint8_t fsmRaise(uint8_t event) {
+	(void)event;
+	return 1;
+}
+
+#include "position.c"
+
+#define RECORD			sizeof(POSITION_EEPROM_t)
+#define FULL_DUTY		255				// MOTOR_MAX_SPEED, work per ms
+
+static void setup(void) {
+	hostReset();
+	memset(positionSaved, 0xFF, sizeof(positionSaved));		// Erased EEPROM
+	memset(&position, 0, sizeof(position));
+	positionSavePending = positionDirection = positionStopping = 0;
+	positionTarget = POSITION_FULL;
+	positionInit();
+}
+
+/* Power on: the RAM copy is read again */
+static void powerOn(void) {
+	memset(&position, 0, sizeof(position));
+	positionSavePending = 0;
+	positionInit();
+}
+
+/* All of the background save */
+static void saveAll(void) {
+	uint8_t i;
+
+	for (i = 0; i < 2 * RECORD && !positionIdle(); i++) {
+		positionTask();
+	}
+	CHECK(positionIdle());
+}
+
+/* A complete run from one end switch to the other with the work of the run */
+static void run(uint8_t direction, uint32_t work) {
+	positionStart(direction);
+	motorWork = work;
+	positionStop();
+	if (direction == POSITION_OPENING) {
+		positionAtOpen();
+	} else {
+		positionAtClosed();
+	}
+	saveAll();
+}
+
+static uint8_t same(const POSITION_EEPROM_t *a, const POSITION_EEPROM_t *b) {
+	return (a->openWork == b->openWork) && (a->closeWork == b->closeWork) && (a->position == b->position);
+}
+
+/* Empty EEPROM: unknown, not learned. Learned values and the position survive a power loss */
+static void testRoundTrip(void) {
+	setup();
+	CHECK_EQ(position.openWork, 0);
+	CHECK_EQ(position.position, POSITION_FULL / 2);
+	run(POSITION_CLOSING, 5000);
+	run(POSITION_OPENING, 6000);
+	run(POSITION_CLOSING, 5000);
+	CHECK_EQ(position.openWork, 6000);
+	CHECK_EQ(position.closeWork, 5000);
+	powerOn();
+	CHECK_EQ(position.openWork, 6000);
+	CHECK_EQ(position.closeWork, 5000);
+	CHECK_EQ(position.position, 0);
+	CHECK_EQ(positionGet(), 0);
+
+	memset(positionSaved, 0x00, sizeof(positionSaved));		// Zeroed EEPROM is not a record either
+	powerOn();
+	CHECK_EQ(position.openWork, 0);
+	CHECK_EQ(position.position, POSITION_FULL / 2);
+}
+
+/* The newer slot wins, also when the sequence number wraps */
+static void testSequence(void) {
+	uint16_t i;
+
+	setup();
+	for (i = 0; i < 300; i++) {
+		run((i & 1) ? POSITION_CLOSING : POSITION_OPENING, 4000 + i);
+		powerOn();
+		CHECK_EQ(position.position, (i & 1) ? 0 : POSITION_FULL);
+	}
+}
+
+/* Power lost after any byte of a save, or during a byte: the old record or the new one */
+static void testTornWrite(void) {
+	POSITION_EEPROM_t before, after;
+	uint8_t steps, garbage, old = 0, new = 0, mixed = 0;
+	uint32_t writes;
+
+	for (steps = 0; steps <= RECORD; steps++) {
+		for (garbage = 0; garbage < 2; garbage++) {
+			setup();
+			run(POSITION_CLOSING, 5000);
+			run(POSITION_OPENING, 6000);
+			before = position;
+			positionStart(POSITION_CLOSING);	// Closes, the learned value changes too
+			motorWork = 4000;
+			positionStop();
+			positionAtClosed();
+			after = position;
+			writes = hostEepromWrites;
+			while (!positionIdle() && (hostEepromWrites - writes < steps)) {
+				positionTask();
+			}
+			if (garbage && !positionIdle()) {	// The next byte, being written when the power went
+				((uint8_t *)&positionSaved[positionSlot])[(positionSaveNext + 1) % RECORD] ^= 0x5A;
+			}
+			powerOn();
+			if (same(&position, &before)) {
+				old++;
+			} else if (same(&position, &after)) {
+				new++;
+			} else {
+				mixed++;
+			}
+		}
+	}
+	printf("  save cut off after 0..%u bytes, cleanly or in a byte: %u times the old record, %u the new, %u mixed\n",
+		(unsigned)RECORD, old, new, mixed);
+	CHECK_EQ(mixed, 0);
+	CHECK(old > 0 && new > 0);
+}
+
+/* Runs longer than 17 s at full duty: work * POSITION_FULL would wrap in 32 bits */
+static void testLongRun(void) {
+	uint32_t full = 40000UL * FULL_DUTY;		// 40 s for the whole way
+	uint16_t seconds, now, last = 0, wrong = 0;
+
+	setup();
+	position.openWork = full;
+	position.closeWork = full;
+	position.position = 0;
+	positionStart(POSITION_OPENING);
+	for (seconds = 0; seconds <= 65; seconds++) {
+		motorWork = seconds * 1000UL * FULL_DUTY;
+		now = positionGet();
+		if ((now < last) || (seconds <= 40 && (now + 1 < seconds * 25U || now > seconds * 25U))) {
+			wrong++;
+		}
+		last = now;
+	}
+	CHECK_EQ(wrong, 0);
+	CHECK_EQ(last, POSITION_FULL);
+	motorWork = 20000UL * FULL_DUTY;
+	CHECK_EQ(positionGet(), POSITION_FULL / 2);
+}
+
+int main(void) {
+	testRoundTrip();
+	testSequence();
+	testTornWrite();
+	testLongRun();
+	return hostResult(TEST_NAME);
+}
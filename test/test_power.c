@@ -0,0 +1,199 @@
+/*
+ * Host test for the power manager of the garage door (user-013)
+ *
+ * Author      : rludvik
+ * Description : One simulated hour with three button presses. The tick ISR and the
+ *               debouncer task do what they do in main.c, another task stands in for the
+ *               state machine: a press keeps it busy for DOOR_RUN ms (the door moves).
+ *               Idle sleep waits for the next tick, power-down for the next press, which
+ *               then fires PCINT0 after the clock start-up time.
+ *               Average current is estimated from the time in each mode with the typical
+ *               ATmega328P datasheet values at 5 V, 8 MHz (uC only, not the RF module).
+ */
+
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "host.h"
+#include "settings.h"
+#include "scheduler.h"
+#include "debounce.h"
+#include "power.h"
+
+#define SIM_SECONDS		3600UL
+#define DOOR_RUN		15000UL			// ms the door moves after a press
+#define PRESS_MS		300				// How long the button is held
+#define STARTUP_US		65000UL			// Clock start-up after power-down, default SUT fuses of the internal RC
+#define TASK_US			80				// CPU time of the 1 ms tasks together (see test_scheduler)
+
+#define ACTIVE_MA		5.2
+#define IDLE_MA			1.2
+#define POWER_DOWN_MA	0.02			// With BOD on
+
+void debounceTimerStart();
+void PCINT0_vect(void);
+
+static const uint32_t pressAtMs[] = {600000UL, 1800000UL, 3000000UL};
+#define PRESSES			(sizeof(pressAtMs) / sizeof(pressAtMs[0]))
+
+static uint64_t clockUs, activeUs, idleUs, downUs;
+static uint8_t nextPress, actions, wokenBy[PRESSES];
+static uint32_t busyUntilMs, wakeUs, latencyUs[PRESSES];
+static uint16_t ticksBeforeSleep;
+
+/* Pins: released buttons read 1 (pull-ups), a press pulls OPEN_BTN_PIN low */
+static void updatePins(void) {
+	uint32_t ms = clockUs / 1000;
+	uint8_t i;
+
+	PINB = 0xFF;
+	for (i = 0; i < PRESSES; i++) {
+		if (ms >= pressAtMs[i] && ms < pressAtMs[i] + PRESS_MS) {
+			PINB &= ~(1 << OPEN_BTN_PIN);
+		}
+	}
+}
+
+/* Timer0 compare ISR as in main.c, runs only while the timer runs */
+static void tickIsr(void) {
+	schedulerTick();
+}
+
+static void advance(uint32_t us, uint64_t *mode) {
+	uint64_t before = clockUs / 1000;
+
+	clockUs += us;
+	*mode += us;
+	updatePins();
+	while (before < clockUs / 1000) {
+		if (TIMSK0 & (1 << OCIE0A)) {
+			tickIsr();
+		}
+		before++;
+	}
+}
+
+static void sleepHook(void) {
+	uint32_t nextMs;
+
+	if (hostSleepMode == SLEEP_MODE_IDLE) {
+		advance(1000 - clockUs % 1000, &idleUs);
+		return;
+	}
+	CHECK_EQ(hostSleepMode, SLEEP_MODE_PWR_DOWN);
+	CHECK(!(TIMSK0 & (1 << OCIE0A)));				// Tick stopped
+	CHECK_EQ(TCCR0B, 0);
+	CHECK_EQ(PCMSK0, POWER_WAKE_MASK);
+	CHECK(PCICR & (1 << PCIE0));
+	CHECK(SREG & 0x80);
+	ticksBeforeSleep = schedulerTicks;
+
+	nextMs = (nextPress < PRESSES) ? pressAtMs[nextPress] : SIM_SECONDS * 1000;
+	if (nextMs * 1000ULL > clockUs) {
+		advance(nextMs * 1000ULL - clockUs, &downUs);
+	}
+	if (nextPress < PRESSES) {
+		wokenBy[nextPress] = 1;
+		wakeUs = clockUs;
+		PCINT0_vect();
+		advance(STARTUP_US, &downUs);				// Oscillator starts, the CPU doesn't run yet
+	}
+	CHECK_EQ(schedulerTicks, ticksBeforeSleep);		// Time stood still
+}
+
+/* Stand-in for the state machine and powerCanSleep() in main.c */
+uint8_t powerCanSleep(void) {
+	return (clockUs / 1000 >= busyUntilMs) && debounceIdle();
+}
+
+/* debounceButtons() in main.c */
+static void debounceTask(void) {
+	debounceSample(~PINB);
+	debounceEvents(BUTTONS_MASK, schedulerTicks);
+}
+
+static void buttonTask(void) {
+	DEBOUNCE_EVENT_t event;
+
+	while (debounceGetEvent(&event)) {
+		powerActivity();
+		if (event.type == DEBOUNCE_PRESS && actions < PRESSES) {
+			latencyUs[actions] = clockUs - (wokenBy[actions] ? wakeUs : pressAtMs[actions] * 1000ULL);
+			actions++;
+			nextPress++;
+			busyUntilMs = clockUs / 1000 + DOOR_RUN;
+		}
+	}
+}
+
+static void otherTasks(void) {
+	advance(TASK_US, &activeUs);
+}
+
+static void testDay(void) {
+	double ma, oldMa, idleOnlyMa;
+	uint8_t i;
+
+	hostReset();
+	PINB = 0xFF;
+	debounceTimerStart();
+	schedulerAddTask(debounceTask, 0, BOUNCETIME / DEBOUNCE_SAMPLES);
+	schedulerAddTask(buttonTask, 0, 1);
+	schedulerAddTask(otherTasks, 0, 1);
+	schedulerAddTask(powerTask, 0, POWER_CHECK_PERIOD);
+	hostSleepHook = sleepHook;
+	SREG |= 0x80;
+
+	while (clockUs < SIM_SECONDS * 1000000ULL) {
+		schedulerRun();
+	}
+
+	CHECK_EQ(actions, PRESSES);
+	CHECK_EQ(PCICR, 0);								// Awake again: no pin change interrupts, tick runs
+	CHECK(TIMSK0 & (1 << OCIE0A));
+	for (i = 0; i < PRESSES; i++) {
+		CHECK(wokenBy[i]);
+		CHECK(latencyUs[i] <= STARTUP_US + (BOUNCETIME + 2 * BOUNCETIME / DEBOUNCE_SAMPLES) * 1000UL);
+	}
+
+	ma = (activeUs * ACTIVE_MA + idleUs * IDLE_MA + downUs * POWER_DOWN_MA) / (double)clockUs;
+	oldMa = ACTIVE_MA;								// Old while(1) loop never slept
+	idleOnlyMa = (TASK_US * ACTIVE_MA + (1000 - TASK_US) * IDLE_MA) / 1000;	// Scheduler idle sleep, no power-down
+	printf("  1 h, %u presses: active %.2f s, idle %.1f s, power-down %.1f s\n", (unsigned)PRESSES,
+		activeUs / 1e6, idleUs / 1e6, downUs / 1e6);
+	printf("  average uC current %.3f mA (idle sleep only %.2f mA, busy loop %.1f mA)\n", ma, idleOnlyMa, oldMa);
+	printf("  wake-up to press event %lu ms (%lu ms start-up + debounce)\n",
+		(unsigned long)(latencyUs[0] / 1000), STARTUP_US / 1000);
+	CHECK(ma < oldMa / 10);
+}
+
+/* No sleep while something runs, or before POWER_IDLE_TIME has passed */
+static void testStaysAwake(void) {
+	uint16_t i;
+
+	hostReset();
+	clockUs = 0;
+	busyUntilMs = 0xFFFFFFFFUL;
+	hostSleepHook = 0;
+	for (i = 0; i < 2 * POWER_IDLE_TIME / POWER_CHECK_PERIOD; i++) {
+		schedulerTicks += POWER_CHECK_PERIOD;
+		powerTask();
+	}
+	CHECK_EQ(hostSleeps, 0);
+
+	busyUntilMs = 0;								// Idle from now on
+	for (i = 0; i < POWER_IDLE_TIME / POWER_CHECK_PERIOD - 1; i++) {
+		schedulerTicks += POWER_CHECK_PERIOD;
+		powerTask();
+	}
+	CHECK_EQ(hostSleeps, 0);
+	schedulerTicks += POWER_CHECK_PERIOD;
+	powerTask();
+	CHECK_EQ(hostSleeps, 1);
+	CHECK_EQ(hostSleepMode, POWER_SLEEP_MODE);
+}
+
+int main(void) {
+	testStaysAwake();
+	testDay();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,195 @@
+/*
+ * Host test for the interrupt-driven RF receive path of the garage door (user-006)
+ *
+ * Author      : rludvik
+ * Description : Bytes "arrive" one per millisecond as at 9600 baud: UDR0 is set and
+ *               USART_RX_vect() is called, then the scheduler tick and receiverParse() run.
+ *               fsmRaise() and powerActivity() are stand-ins that record the commands.
+ */
+
+#include <avr/io.h>
+#include <util/delay.h>
+#include "host.h"
+#include "settings.h"
+#include "scheduler.h"
+#include "rfFrame.h"
+
+void USART_RX_vect(void);
+extern void receiverParse(void);
+extern volatile uint8_t rxHead, rxTail, rxOverflows;
+extern uint8_t haveLastCommand;
+extern uint8_t rfDecoderState;
+
+/* Stand-ins for fsm.c and power.c */
+static uint8_t events[64];
+static uint8_t eventCount;
+
+uint8_t fsmRaise(uint8_t event) {
+	if (eventCount < sizeof(events)) {
+		events[eventCount++] = event;
+	}
+	return 1;
+}
+
+void powerActivity(void) {
+}
+
+static void reset(void) {
+	hostReset();
+	rxHead = rxTail = rxOverflows = 0;
+	haveLastCommand = 0;
+	rfDecoderReset();
+	eventCount = 0;
+	schedulerTicks += 2 * RF_DUPLICATE_WINDOW;		// Older commands are no duplicates anymore
+}
+
+/* One byte on the line: it's stored by the ISR, then the parser task runs */
+static void lineByte(uint8_t data) {
+	UDR0 = data;
+	USART_RX_vect();
+	schedulerTick();
+	receiverParse();
+}
+
+static void lineIdle(uint16_t ms) {
+	while (ms--) {
+		schedulerTick();
+		receiverParse();
+	}
+}
+
+static uint8_t frameOf(uint8_t *buffer, uint8_t address, uint8_t sequence, uint8_t command) {
+	return rfFrameEncode(buffer, address, sequence, &command, 1);
+}
+
+static void sendFrame(uint8_t address, uint8_t sequence, uint8_t command) {
+	uint8_t buffer[RF_FRAME_MAX_SIZE], n, i;
+
+	n = frameOf(buffer, address, sequence, command);
+	for (i = 0; i < n; i++) {
+		lineByte(buffer[i]);
+	}
+}
+
+/* A clean frame is a command, a wrong address isn't, the ISR never waits */
+static void testCleanFrame(void) {
+	reset();
+	sendFrame(RADDR, 1, MOTOR_OPEN_CMD);
+	sendFrame(RADDR + 1, 2, MOTOR_CLOSE_CMD);
+	sendFrame(RADDR, 3, EMERGENCY_STOP_CMD);
+	CHECK_EQ(eventCount, 2);
+	CHECK_EQ(events[0], EV_REMOTE_OPEN);
+	CHECK_EQ(events[1], EV_REMOTE_LOCK);
+	CHECK(hostDelayUs == 0);
+}
+
+/* Random noise between the frames (the ASK receiver outputs it without a carrier) */
+static void testNoise(void) {
+	uint8_t i, n, sequence;
+
+	reset();
+	hostSeed(6);
+	for (sequence = 0; sequence < 100; sequence++) {
+		n = hostRandom() % 20;
+		for (i = 0; i < n; i++) {
+			lineByte(hostRandom());
+		}
+		sendFrame(RADDR, sequence, (sequence & 1) ? MOTOR_CLOSE_CMD : MOTOR_OPEN_CMD);
+	}
+	CHECK_EQ(eventCount, 64);						// The first 64 of the 100 are recorded
+	for (i = 0; i < 64; i++) {
+		CHECK_EQ(events[i], (i & 1) ? EV_REMOTE_CLOSE : EV_REMOTE_OPEN);
+	}
+	CHECK_EQ(rxOverflows, 0);
+}
+
+/* A lost byte costs only its own frame, the next one is received */
+static void testDroppedByte(void) {
+	uint8_t buffer[RF_FRAME_MAX_SIZE], n, i, skip;
+
+	for (skip = RF_PREAMBLE_LEN; skip < RF_PREAMBLE_LEN + 7; skip++) {
+		reset();
+		n = frameOf(buffer, RADDR, 1, MOTOR_OPEN_CMD);
+		for (i = 0; i < n; i++) {
+			if (i != skip) {
+				lineByte(buffer[i]);
+			}
+		}
+		sendFrame(RADDR, 2, MOTOR_CLOSE_CMD);
+		CHECK_EQ(eventCount, 1);
+		CHECK_EQ(events[0], EV_REMOTE_CLOSE);
+	}
+}
+
+/* Frames without a gap, also when the parser runs late and finds several in the buffer */
+static void testBackToBack(void) {
+	uint8_t buffer[RF_FRAME_MAX_SIZE], n, i;
+
+	reset();
+	for (i = 0; i < 10; i++) {
+		sendFrame(RADDR, i, MOTOR_OPEN_CMD);
+	}
+	CHECK_EQ(eventCount, 10);
+
+	reset();
+	n = frameOf(buffer, RADDR, 20, MOTOR_OPEN_CMD);
+	for (i = 0; i < n; i++) {						// Main loop busy for 11 ms
+		UDR0 = buffer[i];
+		USART_RX_vect();
+	}
+	CHECK_EQ(eventCount, 0);
+	lineIdle(1);
+	CHECK_EQ(eventCount, 1);
+	CHECK_EQ(rxOverflows, 0);
+
+	reset();
+	for (i = 0; i < RX_BUFFER_SIZE + 4; i++) {		// Too long: the rest is dropped and counted
+		UDR0 = 0;
+		USART_RX_vect();
+	}
+	CHECK_EQ(rxOverflows, 5);
+	lineIdle(1);
+	CHECK_EQ(rxHead, rxTail);
+}
+
+/* A frame cut in the middle is thrown away after RX_FRAME_TIMEOUT ms */
+static void testPartialFrame(void) {
+	uint8_t buffer[RF_FRAME_MAX_SIZE], n, i;
+
+	reset();
+	n = frameOf(buffer, RADDR, 1, MOTOR_OPEN_CMD);
+	for (i = 0; i < n - 3; i++) {
+		lineByte(buffer[i]);
+	}
+	lineIdle(RX_FRAME_TIMEOUT);
+	CHECK(rfDecoderState != 0);						// Still waiting for the rest
+	lineIdle(1);
+	CHECK_EQ(rfDecoderState, 0);					// Looking for SYNC again
+	sendFrame(RADDR, 2, MOTOR_CLOSE_CMD);
+	CHECK_EQ(eventCount, 1);
+	CHECK_EQ(events[0], EV_REMOTE_CLOSE);
+}
+
+/* The TX repeats every command with the same sequence number, it's executed once */
+static void testRetransmission(void) {
+	uint8_t i;
+
+	reset();
+	for (i = 0; i < 3; i++) {
+		sendFrame(RADDR, 7, MOTOR_OPEN_CMD);
+	}
+	CHECK_EQ(eventCount, 1);
+	lineIdle(RF_DUPLICATE_WINDOW);
+	sendFrame(RADDR, 7, MOTOR_OPEN_CMD);			// Same number much later => new command
+	CHECK_EQ(eventCount, 2);
+}
+
+int main(void) {
+	testCleanFrame();
+	testNoise();
+	testDroppedByte();
+	testBackToBack();
+	testPartialFrame();
+	testRetransmission();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,196 @@
+/*
+ * Host test for the RF frame encoder/decoder (user-007)
+ *
+ * Author      : rludvik
+ * Description : Built for the RX and the TX copy of rfFrame.c (see Makefile).
+ *               Round trip, bit errors the CRC has to catch, the rescan after a corrupted
+ *               length, and a channel simulator: frames are sent back to back at 9600 baud
+ *               with random bit errors and the valid commands per second are counted.
+ */
+
+#include <string.h>
+#include <avr/io.h>
+#include <util/crc16.h>
+#include "host.h"
+#include "settings.h"
+#include "rfFrame.h"
+
+#define BAUD_BITS		10					// 8N1, bits per byte on the line
+
+/* Bytes through the decoder, returns the number of frames, the last one in frame */
+static uint8_t decode(const uint8_t *bytes, uint8_t n, RF_FRAME_t *frame) {
+	uint8_t i, frames = 0;
+
+	for (i = 0; i < n; i++) {
+		frames += rfDecoderPut(bytes[i], frame);
+	}
+	return frames;
+}
+
+static uint8_t sameFrame(const RF_FRAME_t *a, const RF_FRAME_t *b) {
+	return (a->address == b->address) && (a->sequence == b->sequence) && (a->length == b->length)
+		&& (memcmp(a->payload, b->payload, a->length) == 0);
+}
+
+/* CRC-8 of avr-libc, check value of the polynomial 0x07 */
+static void testCrc(void) {
+	const char *check = "123456789";
+	uint8_t crc = 0;
+
+	while (*check) {
+		crc = _crc8_ccitt_update(crc, *check++);
+	}
+	CHECK_EQ(crc, 0xF4);
+}
+
+/* Every payload length there and back, too long or empty isn't encoded */
+static void testRoundTrip(void) {
+	uint8_t buffer[RF_FRAME_MAX_SIZE], payload[RF_MAX_PAYLOAD + 1] = {0xA0, 0x25, 0x69, 0xBB, 0x55};
+	uint8_t length, n;
+	RF_FRAME_t sent, received;
+
+	rfDecoderReset();
+	for (length = 1; length <= RF_MAX_PAYLOAD; length++) {
+		n = rfFrameEncode(buffer, RADDR, length, payload, length);
+		CHECK_EQ(n, RF_PREAMBLE_LEN + 6 + length);
+		CHECK_EQ(buffer[0], RF_PREAMBLE);
+		CHECK_EQ(buffer[RF_PREAMBLE_LEN], SYNC);
+		CHECK_EQ(buffer[RF_PREAMBLE_LEN + 1], RF_FRAME_VERSION);
+		CHECK_EQ(buffer[RF_PREAMBLE_LEN + 2], length);
+
+		sent.address = RADDR;
+		sent.sequence = length;
+		sent.length = length;
+		memcpy(sent.payload, payload, length);
+		CHECK_EQ(decode(buffer, n, &received), 1);
+		CHECK(sameFrame(&sent, &received));
+	}
+	CHECK_EQ(rfFrameEncode(buffer, RADDR, 0, payload, 0), 0);
+	CHECK_EQ(rfFrameEncode(buffer, RADDR, 0, payload, RF_MAX_PAYLOAD + 1), 0);
+}
+
+/*
+ * All 1- and 2-bit errors in a command frame: a frame may get lost, but no other frame may come out.
+ * The old SYNC | ADDR | CMD | ADDR+CMD packet is checked the same way for comparison.
+ */
+static void testBitErrors(void) {
+	uint8_t buffer[RF_FRAME_MAX_SIZE], bad[RF_FRAME_MAX_SIZE], command = MOTOR_OPEN_CMD, n;
+	uint8_t old[4] = {SYNC, RADDR, MOTOR_OPEN_CMD, (uint8_t)(RADDR + MOTOR_OPEN_CMD)}, oldBad[4];
+	uint16_t a, b;
+	uint32_t patterns = 0, wrong = 0, oldPatterns = 0, oldWrong = 0;
+	RF_FRAME_t sent, received;
+
+	n = rfFrameEncode(buffer, RADDR, 1, &command, 1);
+	rfDecoderReset();
+	decode(buffer, n, &sent);
+
+	for (a = 0; a < n * 8; a++) {
+		for (b = a; b < n * 8; b++) {
+			memcpy(bad, buffer, n);
+			bad[a / 8] ^= 1 << (a % 8);
+			if (b != a) {
+				bad[b / 8] ^= 1 << (b % 8);
+			}
+			rfDecoderReset();
+			if (decode(bad, n, &received) && !sameFrame(&sent, &received)) {
+				wrong++;
+			}
+			patterns++;
+		}
+	}
+	CHECK_EQ(wrong, 0);
+
+	for (a = 8; a < 32; a++) {						// SYNC is not part of the check
+		for (b = a; b < 32; b++) {
+			memcpy(oldBad, old, 4);
+			oldBad[a / 8] ^= 1 << (a % 8);
+			if (b != a) {
+				oldBad[b / 8] ^= 1 << (b % 8);
+			}
+			if ((uint8_t)(oldBad[1] + oldBad[2]) == oldBad[3]) {
+				oldWrong++;
+			}
+			oldPatterns++;
+		}
+	}
+	printf("  1-2 bit errors taken as a wrong command: CRC-8 frame %lu of %lu, old checksum %lu of %lu\n",
+		(unsigned long)wrong, (unsigned long)patterns, (unsigned long)oldWrong, (unsigned long)oldPatterns);
+}
+
+/* A corrupted length runs into the next frame, the rescan still finds that frame */
+static void testRescan(void) {
+	uint8_t buffer[2 * RF_FRAME_MAX_SIZE], next[RF_FRAME_MAX_SIZE], command, n, m, length;
+	RF_FRAME_t received;
+
+	for (length = 2; length <= RF_MAX_PAYLOAD; length++) {
+		command = MOTOR_OPEN_CMD;
+		n = rfFrameEncode(buffer, RADDR, 1, &command, 1);
+		buffer[RF_PREAMBLE_LEN + 2] = length;		// LENGTH
+		command = MOTOR_CLOSE_CMD;
+		m = rfFrameEncode(next, RADDR, 2, &command, 1) - RF_PREAMBLE_LEN;
+		memcpy(&buffer[n], &next[RF_PREAMBLE_LEN], m);	// No preamble in between, worst case
+		rfDecoderReset();
+		CHECK_EQ(decode(buffer, n + m, &received), 1);
+		CHECK_EQ(received.sequence, 2);
+		CHECK_EQ(received.payload[0], MOTOR_CLOSE_CMD);
+	}
+}
+
+/*
+ * Channel simulator: 10000 frames back to back, every data bit flipped with the probability ber.
+ * Start/stop bit errors are not simulated, the UART would take the byte with a frame error anyway.
+ * At 1e-2 most frames have errors and CRC-8 lets about 1 in 256 of them through, so "wrong" is
+ * only checked up to 1e-3.
+ */
+static void channel(double ber) {
+	uint8_t buffer[RF_FRAME_MAX_SIZE], command, n, i, bit;
+	uint16_t frame;
+	uint32_t valid = 0, wrong = 0, limit = (uint32_t)(ber * 4294967296.0), bytes = 0;
+	RF_FRAME_t received;
+	double seconds;
+
+	hostSeed(7);
+	rfDecoderReset();
+	for (frame = 0; frame < 10000; frame++) {
+		command = (uint8_t)hostRandom();
+		n = rfFrameEncode(buffer, RADDR, (uint8_t)frame, &command, 1);
+		for (i = 0; i < n; i++) {
+			for (bit = 0; bit < 8; bit++) {
+				if (hostRandom() < limit) {
+					buffer[i] ^= 1 << bit;
+				}
+			}
+			if (rfDecoderPut(buffer[i], &received)) {
+				if ((received.address == RADDR) && (received.sequence == (uint8_t)frame) && (received.payload[0] == command)) {
+					valid++;
+				} else {
+					wrong++;
+				}
+			}
+		}
+		bytes += n;
+	}
+	seconds = (double)bytes * BAUD_BITS / BAUDRATE;
+	printf("  BER %.0e: %5lu of 10000 frames valid, %lu wrong, %.1f valid commands/s\n",
+		ber, (unsigned long)valid, (unsigned long)wrong, valid / seconds);
+	if (ber <= 1e-3) {
+		CHECK_EQ(wrong, 0);
+		CHECK(valid >= 9000);
+	}
+}
+
+static void testChannel(void) {
+	channel(0);
+	channel(1e-4);
+	channel(1e-3);
+	channel(1e-2);
+}
+
+int main(void) {
+	testCrc();
+	testRoundTrip();
+	testBitErrors();
+	testRescan();
+	testChannel();
+	return hostResult(TEST_NAME);
+}
@@ -0,0 +1,235 @@
+/*
+ * Host test for the cooperative scheduler (user-005)
+ *
+ * Author      : rludvik
+ * Description : The 1 ms tick is simulated with a microsecond clock. Every task "runs" for
+ *               the CPU time given in its table entry, the tick ISR fires whenever the clock
+ *               passes a millisecond, and sleep waits for the next tick. Task jitter is how far
+ *               the time between two starts of a task is from its period.
+ *               The task times are a model of the garage door main loop, not measured on the AVR.
+ */
+
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "host.h"
+#include "scheduler.h"
+
+static uint32_t clockUs;			// Simulated time
+static uint32_t busyUs;				// Time spent in tasks
+
+/* Move the clock, the tick ISR runs for every millisecond boundary that is passed */
+static void advance(uint32_t us) {
+	uint32_t before = clockUs / 1000;
+
+	clockUs += us;
+	while (before < clockUs / 1000) {
+		schedulerTick();
+		before++;
+	}
+}
+
+/* Idle sleep lasts until the next interrupt, the tick */
+static void sleepUntilTick(void) {
+	CHECK_EQ(hostSleepMode, SLEEP_MODE_IDLE);
+	advance(1000 - clockUs % 1000);
+}
+
+/* Tasks of the model */
+typedef struct {
+	const char *name;
+	uint16_t period;				// ms
+	uint16_t costUs;				// CPU time of one run
+	uint32_t runs;
+	uint32_t lastStartUs;
+	uint32_t jitterUs;				// Worst difference between the time from the last start and the period
+} MODEL_TASK_t;
+
+static MODEL_TASK_t model[] = {
+	{"buttons", 1, 12},
+	{"current", 1, 18},
+	{"leds", 1, 10},
+	{"fsm", 1, 25},
+	{"receiver", 1, 15},
+	{"position", 50, 40},
+	{"power", 100, 20},
+	{"sensor", 500, 1800},			// Longest task, makes the others late once every 500 ms
+};
+#define MODEL_TASKS		(sizeof(model) / sizeof(model[0]))
+
+static void modelRun(MODEL_TASK_t *t) {
+	int32_t jitter = (int32_t)(clockUs - t->lastStartUs) - t->period * 1000L;
+
+	if (jitter < 0) {
+		jitter = -jitter;
+	}
+	if (t->runs > 0 && (uint32_t)jitter > t->jitterUs) {
+		t->jitterUs = jitter;
+	}
+	t->lastStartUs = clockUs;
+	t->runs++;
+	busyUs += t->costUs;
+	advance(t->costUs);
+}
+
+#define MODEL_TASK(i)	static void modelTask##i(void) { modelRun(&model[i]); }
+MODEL_TASK(0) MODEL_TASK(1) MODEL_TASK(2) MODEL_TASK(3) MODEL_TASK(4) MODEL_TASK(5) MODEL_TASK(6) MODEL_TASK(7)
+static SCHEDULER_TASK_t modelTasks[] = {modelTask0, modelTask1, modelTask2, modelTask3, modelTask4,
+										modelTask5, modelTask6, modelTask7};
+
+static void clearTable(void) {
+	int8_t i;
+
+	for (i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+		schedulerRemoveTask(i);
+	}
+}
+
+/* Tick counter wraps after 65535 ms, due times on both sides of it must still work */
+static uint8_t oneShotRuns;
+static uint16_t oneShotTick;
+
+static void oneShot(void) {
+	oneShotRuns++;
+	oneShotTick = schedulerTicks;
+}
+
+static uint16_t periodicTicks[64];
+static uint8_t periodicRuns;
+
+static void periodic(void) {
+	if (periodicRuns < 64) {
+		periodicTicks[periodicRuns] = schedulerTicks;
+	}
+	periodicRuns++;
+}
+
+static void testWrap(void) {
+	uint16_t i;
+
+	hostReset();
+	clearTable();
+	schedulerTicks = 65530;
+	oneShotRuns = 0;
+	periodicRuns = 0;
+	schedulerAddTask(oneShot, 10, 0);				// Due at tick 4, after the wrap
+	schedulerAddTask(periodic, 0, 7);
+
+	for (i = 0; i < 200; i++) {
+		schedulerRun();
+		if (schedulerTicks == 3) {
+			CHECK_EQ(oneShotRuns, 0);				// Not early, 65530 + 10 isn't smaller than 65530
+		}
+		schedulerTick();
+	}
+	CHECK_EQ(oneShotRuns, 1);
+	CHECK_EQ(oneShotTick, 4);
+	CHECK(periodicRuns >= 28);
+	for (i = 1; i < 28; i++) {
+		CHECK_EQ((uint16_t)(periodicTicks[i] - periodicTicks[i - 1]), 7);
+	}
+
+	/* The longest delay, 32767 ms, is due exactly then, also across the wrap */
+	clearTable();
+	schedulerTicks = 60000;
+	oneShotRuns = 0;
+	schedulerAddTask(oneShot, 32767, 0);
+	schedulerTicks += 32766;
+	schedulerRun();
+	CHECK_EQ(oneShotRuns, 0);
+	schedulerTick();
+	schedulerRun();
+	CHECK_EQ(oneShotRuns, 1);
+}
+
+/* Slots: one-shot frees its slot, a full table says so, removed tasks don't run */
+static void testTable(void) {
+	int8_t i, id;
+
+	hostReset();
+	clearTable();
+	oneShotRuns = 0;
+	for (i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+		CHECK(schedulerAddTask(oneShot, 5, 0) != SCHEDULER_NO_TASK);
+	}
+	CHECK_EQ(schedulerAddTask(oneShot, 5, 0), SCHEDULER_NO_TASK);
+	schedulerTicks += 5;
+	schedulerRun();
+	CHECK_EQ(oneShotRuns, SCHEDULER_MAX_TASKS);
+
+	id = schedulerAddTask(oneShot, 1, 1);
+	CHECK(id != SCHEDULER_NO_TASK);
+	schedulerRemoveTask(id);
+	schedulerTicks += 5;
+	schedulerRun();
+	CHECK_EQ(oneShotRuns, SCHEDULER_MAX_TASKS);
+}
+
+/* A periodic task that was late for more than a period runs once and continues from now */
+static void testNoCatchUp(void) {
+	hostReset();
+	clearTable();
+	periodicRuns = 0;
+	schedulerTicks = 100;
+	schedulerAddTask(periodic, 10, 10);
+	schedulerTicks = 145;							// Something blocked for 35 ms
+	schedulerRun();
+	schedulerRun();
+	CHECK_EQ(periodicRuns, 1);
+	schedulerTicks = 154;
+	schedulerRun();
+	CHECK_EQ(periodicRuns, 1);
+	schedulerTicks = 155;
+	schedulerRun();
+	CHECK_EQ(periodicRuns, 2);
+}
+
+/* Nothing due => idle sleep until the next interrupt */
+static void testIdleSleep(void) {
+	hostReset();
+	clearTable();
+	schedulerAddTask(periodic, 10, 10);
+	schedulerRun();
+	CHECK_EQ(hostSleeps, 1);
+	CHECK_EQ(hostSleepMode, SLEEP_MODE_IDLE);
+	CHECK(SREG & 0x80);								// Interrupts are on again after sleep
+}
+
+/* Garage door main loop for 10 s: jitter of every task and CPU use */
+static void testJitter(void) {
+	uint8_t i;
+	uint32_t sleeps;
+
+	hostReset();
+	clearTable();
+	clockUs = 0;
+	busyUs = 0;
+	for (i = 0; i < MODEL_TASKS; i++) {
+		model[i].runs = 0;
+		model[i].jitterUs = 0;
+		CHECK(schedulerAddTask(modelTasks[i], 0, model[i].period) != SCHEDULER_NO_TASK);
+	}
+	hostSleepHook = sleepUntilTick;
+
+	while (clockUs < 10000000UL) {
+		schedulerRun();
+	}
+	sleeps = hostSleeps;
+
+	printf("  10 s simulated, %lu sleeps, CPU busy %.1f %%\n", (unsigned long)sleeps, busyUs / 100000.0);
+	for (i = 0; i < MODEL_TASKS; i++) {
+		printf("  %-9s every %4u ms, %4u us: %5lu runs, jitter %4lu us\n", model[i].name,
+			model[i].period, model[i].costUs, (unsigned long)model[i].runs, (unsigned long)model[i].jitterUs);
+		CHECK(model[i].runs >= 10000UL / model[i].period);
+		CHECK(model[i].jitterUs < 3000);			// Never more than the longest task late
+	}
+	CHECK(busyUs < 1000000UL);						// Well below 10 %
+}
+
+int main(void) {
+	testWrap();
+	testTable();
+	testNoCatchUp();
+	testIdleSleep();
+	testJitter();
+	return hostResult(TEST_NAME);
+}
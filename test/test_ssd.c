@@ -0,0 +1,246 @@
+/*
+ * Host test for the timer-driven 7-segment refresh (user-001), the glyph cache (user-002),
+ * the glyph table in flash (user-003) and brightness with blanking (user-004)
+ *
+ * Author      : rludvik
+ * Description : Built once for every driver (see Makefile): SSD_HEADER is the driver's header,
+ *               TEST_F_CPU and TEST_PRESCALER the clock the profile is meant for.
+ *               The timer is simulated one count at a time, the compare ISRs are called
+ *               where the hardware would call them and the ports are checked after each one.
+ */
+
+#include <avr/io.h>
+#include <util/delay.h>
+#include "host.h"
+#include SSD_HEADER
+#include "ssdGlyphs.h"
+
+void SSD_TIMER_CTC_VECTOR(void);
+void SSD_TIMER_BLANK_VECTOR(void);
+
+#ifndef TEST_DP_LAST
+#define TEST_DP_LAST	0		// SevSeg.c shows the DP on the last digit
+#endif
+
+/* One digit tick as the timer does it: COMPB at OCRB, CTC ISR at OCRA and back to 0 */
+static uint16_t onCounts;		// Timer counts the segments were on in the last tick
+
+static void runDigit(void) {
+	uint16_t count;
+	uint8_t lit = (DATA_PORT != SSD_BLANK);
+
+	onCounts = 0;
+	for (count = 0; count <= SSD_TIMER_OCR_REGISTER; count++) {
+		if (count == SSD_TIMER_BLANK_OCR_REGISTER) {
+			SSD_TIMER_BLANK_VECTOR();
+			lit = 0;
+		}
+		if (lit) {
+			onCounts++;
+		}
+	}
+	CHECK_EQ(DATA_PORT, SSD_BLANK);			// Off before the next digit is selected
+	SSD_TIMER_CTC_VECTOR();
+}
+
+/* Digit select bit of the digit on the screen now, left to right */
+static int selectedDigit(void) {
+	uint8_t select = DIGIT_CONTROL_PORT & SSD_DIGIT_MASK;
+
+	if (select == SegOne) return 0;
+	if (select == SegTwo) return 1;
+	if (select == SegThree) return 2;
+	return -1;
+}
+
+/* Position (0 = left) of the digit select pin, from the driver's own table */
+extern const uint8_t ssdDigitSelect[SSD_NR_OF_DIGITS];
+extern volatile uint8_t ssdDirty;
+
+static int positionOf(int selected) {
+	static const uint8_t pins[3] = {SegOne, SegTwo, SegThree};
+	int i;
+
+	for (i = 0; i < SSD_NR_OF_DIGITS; i++) {
+		if (ssdDigitSelect[i] == pins[selected]) return i;
+	}
+	return -1;
+}
+
+/* Run to the end of a frame, the next tick shows the first digit. The ISR keeps its digit between tests */
+static void endOfFrame(void) {
+	do {
+		runDigit();
+	} while (positionOf(selectedDigit()) != SSD_NR_OF_DIGITS - 1);
+}
+
+static uint8_t expectedSegments(int number, int position) {
+	static const int powers[3] = {100, 10, 1};
+	uint8_t segments = ssdGlyph((number / powers[position]) % 10);
+
+	if (TEST_DP_LAST && position == SSD_NR_OF_DIGITS - 1) {
+		segments = SSD_DP(segments);
+	}
+	return segments;
+}
+
+/* Every CTC ISR shows the next digit with its own segments, one select pin at a time */
+static void testScanOrder(void) {
+	int tick, position, previous = SSD_NR_OF_DIGITS - 1;
+
+	hostReset();
+	ssdInit();
+	ssdSetNumber(123);
+	endOfFrame();
+
+	for (tick = 0; tick < 3 * SSD_NR_OF_DIGITS; tick++) {
+		runDigit();
+		CHECK(selectedDigit() >= 0);
+		position = positionOf(selectedDigit());
+		CHECK(position >= 0);
+		CHECK_EQ(position, (previous + 1) % SSD_NR_OF_DIGITS);
+		CHECK_EQ(DATA_PORT, expectedSegments(123, position));
+		previous = position;
+	}
+}
+
+/* 1 ms per digit at the profile's clock, the segments go off before the digit changes */
+static void testTiming(void) {
+	double tickUs, onUs;
+	uint8_t level;
+	uint16_t lastOn = 0;
+
+	hostReset();
+	ssdInit();
+	ssdSetNumber(888);
+
+	tickUs = (SSD_TIMER_OCR_REGISTER + 1) * (double)TEST_PRESCALER * 1e6 / TEST_F_CPU;
+	CHECK(tickUs > 999.0 && tickUs < 1001.0);
+	CHECK(SSD_NR_OF_DIGITS * tickUs <= 10000.0);		// At least 100 Hz per digit, no flicker
+
+	for (level = 0; level < SSD_BRIGHTNESS_LEVELS; level++) {
+		ssdSetBrightness(level);
+		runDigit();
+		runDigit();
+		CHECK(onCounts > 0);
+		CHECK(onCounts > lastOn);						// Every level is brighter
+		CHECK(SSD_TIMER_OCR_REGISTER + 1 - onCounts >= SSD_BLANK_TICKS);
+		lastOn = onCounts;
+	}
+	onUs = lastOn * (double)TEST_PRESCALER * 1e6 / TEST_F_CPU;
+	printf("  tick %.0f us, frame %.0f us, on-time %.0f us at full brightness, %u levels\n",
+		tickUs, SSD_NR_OF_DIGITS * tickUs, onUs, SSD_BRIGHTNESS_LEVELS);
+}
+
+/* The calls from the main loop only fill buffers, nothing waits */
+static void testNonBlocking(void) {
+	static const uint8_t raw[SSD_NR_OF_DIGITS] = {0x00, 0x7f, 0xfe};
+	int tick;
+
+	hostReset();
+	ssdInit();
+	ssdSetNumber(42);
+	ssdSetRaw(raw);
+	ssdSetBrightness(3);
+	CHECK(hostDelayUs == 0);
+
+	endOfFrame();
+	for (tick = 0; tick < SSD_NR_OF_DIGITS; tick++) {
+		runDigit();
+		CHECK_EQ(DATA_PORT, raw[positionOf(selectedDigit())]);
+	}
+	CHECK(hostDelayUs == 0);
+}
+
+/* A new number in the middle of a frame shows up only at the start of the next frame */
+static void testNoTearing(void) {
+	int tick, position;
+
+	hostReset();
+	ssdInit();
+	ssdSetNumber(111);
+	endOfFrame();
+	runDigit();											// First digit of the frame with 111
+	ssdSetNumber(222);
+	for (tick = 1; tick < SSD_NR_OF_DIGITS; tick++) {
+		runDigit();
+		CHECK_EQ(DATA_PORT, expectedSegments(111, positionOf(selectedDigit())));
+	}
+	for (tick = 0; tick < SSD_NR_OF_DIGITS; tick++) {
+		runDigit();
+		position = positionOf(selectedDigit());
+		CHECK_EQ(DATA_PORT, expectedSegments(222, position));
+	}
+}
+
+/* The table in flash gives the bytes of the old seg_code[]/seg_code_dp[] arrays for the board's wiring */
+static void testGlyphTable(void) {
+	static const uint8_t tiny4313[10] = {0xc0, 0xf9, 0xa4, 0xb0, 0x99, 0x92, 0x82, 0xf8, 0x80, 0x90};
+	static const uint8_t tiny4313Dp[10] = {0x40, 0x79, 0x24, 0x30, 0x19, 0x12, 0x02, 0x78, 0x00, 0x10};
+	static const uint8_t mega328p[10] = {0x81, 0xcf, 0x92, 0x86, 0xcc, 0xa4, 0xa0, 0x8f, 0x80, 0x84};
+	static const uint8_t mega328pDp[10] = {0x01, 0x4f, 0x12, 0x06, 0x4c, 0x24, 0x20, 0x0f, 0x00, 0x04};
+	const uint8_t *old = (SSD_BOARD == SSD_BOARD_328P) ? mega328p : tiny4313;
+	const uint8_t *oldDp = (SSD_BOARD == SSD_BOARD_328P) ? mega328pDp : tiny4313Dp;
+	uint8_t digit, wrong = 0;
+
+	for (digit = 0; digit < 10; digit++) {
+		if ((ssdGlyph(digit) != old[digit]) || (SSD_DP(ssdGlyph(digit)) != oldDp[digit])) {
+			wrong++;
+		}
+	}
+	CHECK_EQ(wrong, 0);
+}
+
+/* The number is converted to glyphs only when it changes, the ISR only copies bytes */
+static void testConvertOnlyOnChange(void) {
+	static const uint8_t raw[SSD_NR_OF_DIGITS] = {0x00, 0x00, 0x00};
+	uint32_t perValue;
+	int i, tick;
+
+	hostReset();
+	ssdInit();
+	ssdSetNumber(123);
+	perValue = hostFlashReads;
+	CHECK(perValue > 0);
+
+	for (i = 0; i < 1000; i++) {						// Main loop calls it on every pass
+		ssdSetNumber(123);
+	}
+	CHECK_EQ(hostFlashReads, perValue);
+
+	endOfFrame();
+	hostFlashReads = 0;
+	for (tick = 0; tick < 100; tick++) {				// Refresh doesn't look anything up
+		runDigit();
+	}
+	CHECK_EQ(hostFlashReads, 0);
+	CHECK_EQ(ssdDirty, 0);
+
+	ssdSetNumber(124);									// Changed => converted again
+	CHECK_EQ(hostFlashReads, perValue);
+	CHECK_EQ(ssdDirty, 1);
+
+	ssdSetRaw(raw);										// Raw bytes replace the number, 124 is converted again
+	hostFlashReads = 0;
+	ssdSetNumber(124);
+	CHECK_EQ(hostFlashReads, perValue);
+
+	ssdSetNumber(1234);									// Only the last 3 digits
+	endOfFrame();
+	for (tick = 0; tick < SSD_NR_OF_DIGITS; tick++) {
+		runDigit();
+		CHECK_EQ(DATA_PORT, expectedSegments(234, positionOf(selectedDigit())));
+	}
+
+	printf("  glyph lookups: %u per new value, 0 per unchanged call, 0 per refresh tick\n", (unsigned)perValue);
+}
+
+int main(void) {
+	testGlyphTable();
+	testScanOrder();
+	testTiming();
+	testNonBlocking();
+	testNoTearing();
+	testConvertOnlyOnChange();
+	return hostResult(TEST_NAME);
+}
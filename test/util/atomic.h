@@ -0,0 +1,12 @@
+/* Host stand-in for <util/atomic.h>, the tests run single-threaded, the block runs once */
+
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+#define ATOMIC_RESTORESTATE		0
+#define ATOMIC_FORCEON			1
+#define NONATOMIC_RESTORESTATE	0
+#define ATOMIC_BLOCK(type)		for (int hostAtomicOnce = 1; hostAtomicOnce; hostAtomicOnce = 0)
+#define NONATOMIC_BLOCK(type)	for (int hostAtomicOnce = 1; hostAtomicOnce; hostAtomicOnce = 0)
+
+#endif      //HOST_UTIL_ATOMIC_H
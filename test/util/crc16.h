@@ -0,0 +1,28 @@
+/* Host stand-in for <util/crc16.h>, same algorithms as the avr-libc C versions */
+
+#ifndef HOST_UTIL_CRC16_H
+#define HOST_UTIL_CRC16_H
+
+#include <stdint.h>
+
+static inline uint8_t _crc8_ccitt_update(uint8_t crc, uint8_t data) {
+	uint8_t i;
+
+	crc ^= data;
+	for (i = 0; i < 8; i++) {
+		crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+	}
+	return crc;
+}
+
+static inline uint8_t _crc_ibutton_update(uint8_t crc, uint8_t data) {
+	uint8_t i;
+
+	crc ^= data;
+	for (i = 0; i < 8; i++) {
+		crc = (crc & 0x01) ? (uint8_t)((crc >> 1) ^ 0x8C) : (uint8_t)(crc >> 1);
+	}
+	return crc;
+}
+
+#endif      //HOST_UTIL_CRC16_H
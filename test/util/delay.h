@@ -0,0 +1,18 @@
+/*
+ * Host stand-in for <util/delay.h>
+ *
+ * Delays don't wait, they add to hostDelayUs and call hostDelayHook (if set),
+ * so a benchmark can add up the time the CPU would spend blocked.
+ */
+
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+extern double hostDelayUs;
+extern void (*hostDelayHook)(double us);
+extern void hostDelay(double us);
+
+#define _delay_us(us)	hostDelay(us)
+#define _delay_ms(ms)	hostDelay((ms) * 1000.0)
+
+#endif      //HOST_UTIL_DELAY_H